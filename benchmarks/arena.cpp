@@ -0,0 +1,183 @@
+#include "benchBase.h"
+#include "domTree/arena.h"
+#include "domTree/dfo_rpo.h"
+#include "irGen/compiler.h"
+#include <fstream>
+#include <vector>
+
+namespace {
+using namespace ir;
+
+constexpr size_t BLOCKS_COUNT = 20000;
+constexpr size_t TRAVERSALS_COUNT = 20;
+constexpr size_t FUNCTIONS_COUNT = 100000;
+constexpr size_t WARMUP_COUNT = 1000;
+constexpr auto OPS_TYPE = InstType::i32;
+
+struct PolicyConfig {
+    const char *name;
+    memory::ArenaGrowthPolicy policy;
+};
+
+// Builds a chain of blocks each containing a small arithmetic sequence
+Graph *BuildGraph(Compiler *compiler, memory::ArenaAllocator *allocator) {
+    auto *instrBuilder = allocator->New<InstructionBuilder>(allocator);
+    auto *graph = allocator->New<Graph>(compiler, allocator, instrBuilder);
+    auto *arg = instrBuilder->BuildArg(OPS_TYPE);
+    BB *prev = nullptr;
+    for (size_t i = 0; i < BLOCKS_COUNT; ++i) {
+        auto *bblock = graph->CreateEmptyBB();
+        if (prev) {
+            graph->ConnectBBs(prev, bblock);
+        } else {
+            graph->SetFirstBB(bblock);
+            instrBuilder->PushBackInst(bblock, arg);
+        }
+        auto *constant = instrBuilder->BuildConst(OPS_TYPE, i);
+        auto *add = instrBuilder->BuildAdd(OPS_TYPE, arg, constant);
+        auto *mul = instrBuilder->BuildMul(OPS_TYPE, add, constant);
+        auto *xorInstr = instrBuilder->BuildXor(OPS_TYPE, mul, add);
+        instrBuilder->PushBackInst(bblock, constant);
+        instrBuilder->PushBackInst(bblock, add);
+        instrBuilder->PushBackInst(bblock, mul);
+        instrBuilder->PushBackInst(bblock, xorInstr);
+        prev = bblock;
+    }
+    return graph;
+}
+
+size_t TraverseGraph(Graph *graph) {
+    size_t checksum = 0;
+    for (size_t i = 0; i < TRAVERSALS_COUNT; ++i) {
+        memory::ArenaScope scope(graph->GetAllocator());
+        for (auto *bblock : RPO(graph)) {
+            for (auto *instr : *bblock) {
+                checksum += instr->UsersCount();
+            }
+        }
+    }
+    return checksum;
+}
+
+void RunConfig(Compiler *compiler, const PolicyConfig &config) {
+    memory::ArenaAllocator allocator(config.policy);
+
+    bench::Timer buildTimer;
+    auto *graph = BuildGraph(compiler, &allocator);
+    auto buildMs = buildTimer.ElapsedMs();
+    auto arenasCount = allocator.GetArenasCount();
+    auto mmapCalls = allocator.GetStats().mmapCalls;
+
+    bench::TLBMissCounter tlbMisses;
+    bench::Timer traverseTimer;
+    tlbMisses.Start();
+    auto checksum = TraverseGraph(graph);
+    auto misses = tlbMisses.Stop();
+    auto traverseMs = traverseTimer.ElapsedMs();
+
+    bench::PrintCell(config.name, 20);
+    bench::PrintCell(arenasCount);
+    bench::PrintCell(mmapCalls);
+    bench::PrintCell(buildMs);
+    bench::PrintCell(traverseMs);
+    if (tlbMisses.IsAvailable()) {
+        bench::PrintCell(misses);
+    } else {
+        bench::PrintCell("n/a");
+    }
+    std::cout << "  (checksum " << checksum << ")" << std::endl;
+}
+
+size_t GetResidentSetSize() {
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    statm >> totalPages >> residentPages;
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// A diamond with an arithmetic sequence
+void BuildFunction(Graph *graph) {
+    auto *instrBuilder = graph->GetInstructionBuilder();
+    std::vector<BB *> bblocks(4);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[0], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+
+    auto *arg = instrBuilder->BuildArg(OPS_TYPE);
+    auto *add = instrBuilder->BuildAddi(OPS_TYPE, arg, 5);
+    auto *mul = instrBuilder->BuildMul(OPS_TYPE, add, arg);
+    auto *ret = instrBuilder->BuildRet(OPS_TYPE, mul);
+    instrBuilder->PushBackInst(bblocks[0], arg);
+    instrBuilder->PushBackInst(bblocks[1], add);
+    instrBuilder->PushBackInst(bblocks[3], mul);
+    instrBuilder->PushBackInst(bblocks[3], ret);
+}
+
+// The arenas of deleted functions are pooled, so only the ids bookkeeping
+// grows with the number of compiled functions
+void RunCompileDelete() {
+    bench::PrintHeader("Compile/delete cycles, " +
+                       std::to_string(FUNCTIONS_COUNT) + " functions");
+    bench::PrintCell("time, ms");
+    bench::PrintCell("RSS growth, KB");
+    bench::PrintCell("pooled arenas");
+    std::cout << std::endl;
+
+    Compiler compiler;
+    size_t initialRSS = 0;
+    bench::Timer timer;
+    for (size_t i = 0; i < FUNCTIONS_COUNT; ++i) {
+        if (i == WARMUP_COUNT) {
+            initialRSS = GetResidentSetSize();
+        }
+        auto *graph = compiler.CreateNewGraph();
+        BuildFunction(graph);
+        compiler.DeleteFunctionGraph(graph->GetId());
+    }
+    auto elapsedMs = timer.ElapsedMs();
+    auto finalRSS = GetResidentSetSize();
+
+    bench::PrintCell(elapsedMs);
+    bench::PrintCell(finalRSS > initialRSS ? (finalRSS - initialRSS) / 1024
+                                           : 0);
+    bench::PrintCell(compiler.GetPooledArenasCount());
+    std::cout << std::endl;
+}
+} // namespace
+
+int main() {
+    constexpr size_t PAGE = memory::ArenaAllocator::PAGE_SIZE;
+    constexpr size_t HUGE_PAGE = memory::ArenaAllocator::HUGE_PAGE_SIZE;
+    const PolicyConfig configs[] = {
+        {"fixed 4K", {PAGE, PAGE, 1, false}},
+        {"geometric 256K cap",
+         {PAGE, memory::ArenaAllocator::DEFAULT_MAX_ARENA_SIZE, 2, false}},
+        {"geometric 32M cap", {PAGE, 16 * HUGE_PAGE, 2, false}},
+        {"geometric 32M + THP", {PAGE, 16 * HUGE_PAGE, 2, true}},
+    };
+
+    bench::PrintHeader("Arena growth policies, " +
+                       std::to_string(BLOCKS_COUNT) + " blocks");
+    bench::PrintCell("policy", 20);
+    bench::PrintCell("arenas");
+    bench::PrintCell("mmap calls");
+    bench::PrintCell("build, ms");
+    bench::PrintCell("traverse, ms");
+    bench::PrintCell("dTLB misses");
+    std::cout << std::endl;
+
+    Compiler compiler;
+    for (const auto &config : configs) {
+        RunConfig(&compiler, config);
+    }
+    std::cout << std::endl;
+
+    RunCompileDelete();
+    return 0;
+}
@@ -0,0 +1,94 @@
+#ifndef JIT_AOT_COURSE_BENCHMARKS_BENCH_BASE_H_
+#define JIT_AOT_COURSE_BENCHMARKS_BENCH_BASE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace bench {
+
+class Timer {
+  public:
+    Timer() : start_(std::chrono::steady_clock::now()) {}
+
+    double ElapsedMs() const {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Counts data TLB misses of the current thread via perf events. Not available
+// in every environment (e.g. containers without perf access), callers must
+// check IsAvailable().
+class TLBMissCounter {
+  public:
+    TLBMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(
+            syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    TLBMissCounter(const TLBMissCounter &) = delete;
+    TLBMissCounter &operator=(const TLBMissCounter &) = delete;
+    TLBMissCounter(TLBMissCounter &&) = delete;
+    TLBMissCounter &operator=(TLBMissCounter &&) = delete;
+    ~TLBMissCounter() {
+        if (IsAvailable()) {
+            close(fd_);
+        }
+    }
+
+    bool IsAvailable() const { return fd_ >= 0; }
+
+    void Start() {
+        if (IsAvailable()) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    uint64_t Stop() {
+        uint64_t count = 0;
+        if (IsAvailable()) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+
+  private:
+    int fd_ = -1;
+};
+
+inline void PrintHeader(const std::string &title) {
+    std::cout << "=== " << title << " ===" << std::endl;
+}
+
+template <typename T>
+inline void PrintCell(const T &value, int width = 16) {
+    std::cout << std::setw(width) << value;
+}
+
+} // namespace bench
+
+#endif // JIT_AOT_COURSE_BENCHMARKS_BENCH_BASE_H_
@@ -0,0 +1,161 @@
+#include "benchBase.h"
+#include "domTree/domFrontier.h"
+#include "irGen/compiler.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+using namespace ir;
+
+constexpr size_t LARGE_BLOCKS_COUNT = 1000000;
+// Random CFGs have huge frontiers, their sum grows faster than linearly
+constexpr size_t RANDOM_BLOCKS_COUNT = 10000;
+constexpr size_t NESTED_LOOPS_BLOCKS_COUNT = 4000;
+constexpr size_t CONSTRUCTIONS_COUNT = 5;
+constexpr size_t QUERIES_COUNT = 100;
+constexpr size_t DEFS_COUNT = 16;
+
+using GraphBuilder = std::function<void(Graph *)>;
+
+std::vector<BB *> CreateBlocks(Graph *graph, size_t count) {
+    std::vector<BB *> bblocks(count);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    return bblocks;
+}
+
+// Chain of blocks, each also branching to the exit: the dominator tree is as
+// deep as the chain
+void BuildLadder(Graph *graph, size_t count) {
+    auto bblocks = CreateBlocks(graph, count);
+    for (size_t i = 0; i + 2 < count; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+        graph->ConnectBBs(bblocks[i], bblocks.back());
+    }
+    graph->ConnectBBs(bblocks[count - 2], bblocks.back());
+}
+
+// Complete binary tree of branches with all the leaves joining at the exit:
+// the dominator tree is shallow and the exit has half of the blocks as
+// predecessors
+void BuildBranchTree(Graph *graph, size_t count) {
+    auto bblocks = CreateBlocks(graph, count);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        for (auto child : {2 * i + 1, 2 * i + 2}) {
+            if (child + 1 < count) {
+                graph->ConnectBBs(bblocks[i], bblocks[child]);
+            }
+        }
+        if (bblocks[i]->GetSuccessors().empty()) {
+            graph->ConnectBBs(bblocks[i], bblocks.back());
+        }
+    }
+}
+
+// Chain of loops nested into each other: the frontier of a block has the
+// headers of all the loops it is in, so the frontiers are quadratic
+void BuildNestedLoops(Graph *graph, size_t count) {
+    auto bblocks = CreateBlocks(graph, count);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+    }
+    for (size_t i = 0; i < count / 2; ++i) {
+        graph->ConnectBBs(bblocks[count - 1 - i], bblocks[i]);
+    }
+}
+
+// Chain of blocks, each also branching to a random earlier or later block
+void BuildRandomGraph(Graph *graph, size_t count) {
+    std::mt19937_64 gen(42);
+    auto bblocks = CreateBlocks(graph, count);
+    std::uniform_int_distribution<size_t> dist(0, count - 1);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+        graph->ConnectBBs(bblocks[i], bblocks[dist(gen)]);
+    }
+}
+
+void RunGraph(Compiler *compiler, const std::string &name,
+              const GraphBuilder &buildGraph) {
+    auto *graph = compiler->CreateNewGraph();
+    buildGraph(graph);
+    graph->GetAnalyses().RequireDomTree();
+    memory::ArenaAllocator storage;
+
+    size_t frontiersSize = 0;
+    bench::Timer constructionTimer;
+    for (size_t i = 0; i < CONSTRUCTIONS_COUNT; ++i) {
+        memory::ArenaScope scope(&storage);
+        DominanceFrontiers frontiers(graph, &storage);
+        frontiersSize = frontiers.GetTotalSize();
+    }
+    auto constructionMs = constructionTimer.ElapsedMs();
+
+    // the same random definitions for both queries
+    auto bblocks = graph->GetBBs();
+    std::mt19937_64 gen(7);
+    std::uniform_int_distribution<size_t> dist(0, bblocks.size() - 1);
+    std::vector<std::vector<BB *>> queries(QUERIES_COUNT);
+    for (auto &defs : queries) {
+        defs.resize(DEFS_COUNT);
+        for (auto &def : defs) {
+            def = bblocks[dist(gen)];
+        }
+    }
+    memory::ArenaVector<BB *> result(storage.ToSTL());
+
+    DominanceFrontiers frontiers(graph, &storage);
+    bench::Timer frontiersTimer;
+    for (const auto &defs : queries) {
+        result.clear();
+        frontiers.ComputeIteratedFrontier(defs, &result);
+    }
+    auto frontiersMs = frontiersTimer.ElapsedMs();
+
+    bench::Timer treeTimer;
+    for (const auto &defs : queries) {
+        result.clear();
+        ComputeIteratedDomFrontier(graph, defs, &result);
+    }
+    auto treeMs = treeTimer.ElapsedMs();
+
+    bench::PrintCell(name, 20);
+    bench::PrintCell(graph->GetBBCount());
+    bench::PrintCell(frontiersSize);
+    bench::PrintCell(constructionMs / CONSTRUCTIONS_COUNT);
+    bench::PrintCell(frontiersMs * 1e3 / QUERIES_COUNT);
+    bench::PrintCell(treeMs * 1e3 / QUERIES_COUNT);
+    std::cout << std::endl;
+    compiler->DeleteFunctionGraph(graph->GetId());
+}
+} // namespace
+
+int main() {
+    bench::PrintHeader("Dominance frontiers");
+    std::cout << "IDF queries of " << DEFS_COUNT << " random blocks"
+              << std::endl;
+    bench::PrintCell("graph", 20);
+    bench::PrintCell("blocks");
+    bench::PrintCell("DF size");
+    bench::PrintCell("DF, ms");
+    bench::PrintCell("IDF by DF, us");
+    bench::PrintCell("IDF by tree, us");
+    std::cout << std::endl;
+
+    Compiler compiler;
+    RunGraph(&compiler, "ladder (deep)",
+             [](Graph *graph) { BuildLadder(graph, LARGE_BLOCKS_COUNT); });
+    RunGraph(&compiler, "branch tree (wide)", [](Graph *graph) {
+        BuildBranchTree(graph, LARGE_BLOCKS_COUNT);
+    });
+    RunGraph(&compiler, "random", [](Graph *graph) {
+        BuildRandomGraph(graph, RANDOM_BLOCKS_COUNT);
+    });
+    RunGraph(&compiler, "nested loops", [](Graph *graph) {
+        BuildNestedLoops(graph, NESTED_LOOPS_BLOCKS_COUNT);
+    });
+    return 0;
+}
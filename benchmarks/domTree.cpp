@@ -0,0 +1,158 @@
+#include "benchBase.h"
+#include "domTree/domTree.h"
+#include "irGen/compiler.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+using namespace ir;
+
+constexpr size_t SMALL_CONSTRUCTIONS_COUNT = 200000;
+constexpr size_t MEDIUM_CONSTRUCTIONS_COUNT = 2000;
+constexpr size_t LARGE_CONSTRUCTIONS_COUNT = 5;
+constexpr size_t MEDIUM_BLOCKS_COUNT = 200;
+constexpr size_t LARGE_BLOCKS_COUNT = 1000000;
+
+using GraphBuilder = std::function<void(Graph *)>;
+
+std::vector<BB *> CreateBlocks(Graph *graph, size_t count) {
+    std::vector<BB *> bblocks(count);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    return bblocks;
+}
+
+// The graphs of tests/domTree.cpp
+void BuildTestGraph1(Graph *graph) {
+    auto bblocks = CreateBlocks(graph, 7);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[5]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+    graph->ConnectBBs(bblocks[4], bblocks[3]);
+    graph->ConnectBBs(bblocks[5], bblocks[4]);
+    graph->ConnectBBs(bblocks[5], bblocks[6]);
+    graph->ConnectBBs(bblocks[6], bblocks[3]);
+}
+
+void BuildTestGraph2(Graph *graph) {
+    auto bblocks = CreateBlocks(graph, 11);
+    for (size_t i = 0; i < 7; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+    }
+    graph->ConnectBBs(bblocks[3], bblocks[2]);
+    graph->ConnectBBs(bblocks[5], bblocks[4]);
+    graph->ConnectBBs(bblocks[7], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[9]);
+    graph->ConnectBBs(bblocks[9], bblocks[2]);
+    graph->ConnectBBs(bblocks[6], bblocks[8]);
+    graph->ConnectBBs(bblocks[8], bblocks[10]);
+}
+
+void BuildTestGraph3(Graph *graph) {
+    auto bblocks = CreateBlocks(graph, 9);
+    for (size_t i = 0; i < 3; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+    }
+    graph->ConnectBBs(bblocks[1], bblocks[4]);
+    graph->ConnectBBs(bblocks[4], bblocks[3]);
+    graph->ConnectBBs(bblocks[4], bblocks[5]);
+    graph->ConnectBBs(bblocks[5], bblocks[7]);
+    graph->ConnectBBs(bblocks[5], bblocks[1]);
+    graph->ConnectBBs(bblocks[7], bblocks[6]);
+    graph->ConnectBBs(bblocks[7], bblocks[8]);
+    graph->ConnectBBs(bblocks[3], bblocks[6]);
+    graph->ConnectBBs(bblocks[6], bblocks[2]);
+    graph->ConnectBBs(bblocks[6], bblocks[8]);
+}
+
+// Chain of blocks, each also branching to a random earlier or later block,
+// so that there are loops, joins and irreducible regions
+void BuildRandomGraph(Graph *graph, size_t count, uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    auto bblocks = CreateBlocks(graph, count);
+    std::uniform_int_distribution<size_t> dist(0, count - 1);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+        graph->ConnectBBs(bblocks[i], bblocks[dist(gen)]);
+    }
+}
+
+// Chain of blocks, each also branching to the exit: the dominator tree is as
+// deep as the chain
+void BuildLadder(Graph *graph, size_t count) {
+    auto bblocks = CreateBlocks(graph, count);
+    for (size_t i = 0; i + 2 < count; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+        graph->ConnectBBs(bblocks[i], bblocks.back());
+    }
+    graph->ConnectBBs(bblocks[count - 2], bblocks.back());
+}
+
+double Measure(Graph *graph, DomTreeAlgorithm algorithm, size_t count,
+               memory::ArenaAllocator *storage) {
+    DomTreeBuilder builder(storage, algorithm);
+    bench::Timer timer;
+    for (size_t i = 0; i < count; ++i) {
+        builder.Construct(graph);
+    }
+    return timer.ElapsedMs();
+}
+
+void RunGraph(Compiler *compiler, const std::string &name,
+              const GraphBuilder &buildGraph, size_t count) {
+    auto *graph = compiler->CreateNewGraph();
+    buildGraph(graph);
+    memory::ArenaAllocator storage;
+    auto ltMs =
+        Measure(graph, DomTreeAlgorithm::LENGAUER_TARJAN, count, &storage);
+    auto sncaMs = Measure(graph, DomTreeAlgorithm::SEMI_NCA, count, &storage);
+    auto perConstruction = [count](double ms) {
+        return ms * 1e3 / static_cast<double>(count);
+    };
+
+    bench::PrintCell(name, 20);
+    bench::PrintCell(graph->GetBBCount());
+    bench::PrintCell(count);
+    bench::PrintCell(perConstruction(ltMs));
+    bench::PrintCell(perConstruction(sncaMs));
+    bench::PrintCell(ltMs / sncaMs);
+    std::cout << std::endl;
+    compiler->DeleteFunctionGraph(graph->GetId());
+}
+} // namespace
+
+int main() {
+    bench::PrintHeader("Dominator tree construction");
+    bench::PrintCell("graph", 20);
+    bench::PrintCell("blocks");
+    bench::PrintCell("constructions");
+    bench::PrintCell("LT, us");
+    bench::PrintCell("Semi-NCA, us");
+    bench::PrintCell("LT / Semi-NCA");
+    std::cout << std::endl;
+
+    Compiler compiler;
+    RunGraph(&compiler, "test graph 1", BuildTestGraph1,
+             SMALL_CONSTRUCTIONS_COUNT);
+    RunGraph(&compiler, "test graph 2", BuildTestGraph2,
+             SMALL_CONSTRUCTIONS_COUNT);
+    RunGraph(&compiler, "test graph 3", BuildTestGraph3,
+             SMALL_CONSTRUCTIONS_COUNT);
+    RunGraph(
+        &compiler, "random medium",
+        [](Graph *graph) { BuildRandomGraph(graph, MEDIUM_BLOCKS_COUNT, 42); },
+        MEDIUM_CONSTRUCTIONS_COUNT);
+    RunGraph(
+        &compiler, "random large",
+        [](Graph *graph) { BuildRandomGraph(graph, LARGE_BLOCKS_COUNT, 42); },
+        LARGE_CONSTRUCTIONS_COUNT);
+    RunGraph(
+        &compiler, "ladder large",
+        [](Graph *graph) { BuildLadder(graph, LARGE_BLOCKS_COUNT); },
+        LARGE_CONSTRUCTIONS_COUNT);
+    return 0;
+}
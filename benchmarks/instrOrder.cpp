@@ -0,0 +1,120 @@
+#include "benchBase.h"
+#include "irGen/compiler.h"
+#include <random>
+#include <vector>
+
+namespace {
+using namespace ir;
+
+constexpr size_t INSTRS_COUNT = 100000;
+constexpr size_t QUERIES_COUNT = 1000000;
+// the linear walk is too slow to run all the queries
+constexpr size_t WALK_QUERIES_COUNT = 1000;
+constexpr size_t INSERTIONS_COUNT = 10000;
+constexpr auto OPS_TYPE = InstType::i32;
+
+// Ordering by walking the block from its start, as done before the
+// instructions were numbered
+bool IsEarlierByWalk(SingleInstruction *lhs, SingleInstruction *rhs) {
+    for (auto *instr : *lhs->GetInstBB()) {
+        if (instr == lhs) {
+            return true;
+        }
+        if (instr == rhs) {
+            return false;
+        }
+    }
+    return false;
+}
+
+std::vector<std::pair<size_t, size_t>> GenerateQueries(size_t count,
+                                                       size_t instrsCount) {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<size_t> dist(0, instrsCount - 1);
+    std::vector<std::pair<size_t, size_t>> queries(count);
+    for (auto &[lhs, rhs] : queries) {
+        lhs = dist(gen);
+        rhs = dist(gen);
+    }
+    return queries;
+}
+
+template <typename QueryT>
+void RunQueries(const char *name,
+                const std::vector<SingleInstruction *> &instrs, size_t count,
+                QueryT query) {
+    auto queries = GenerateQueries(count, instrs.size());
+    size_t checksum = 0;
+    bench::Timer timer;
+    for (auto [lhs, rhs] : queries) {
+        checksum += query(instrs[lhs], instrs[rhs]);
+    }
+    auto elapsedMs = timer.ElapsedMs();
+    bench::PrintCell(name, 28);
+    bench::PrintCell(count);
+    bench::PrintCell(elapsedMs);
+    bench::PrintCell(elapsedMs * 1e6 / static_cast<double>(count));
+    std::cout << "  (checksum " << checksum << ")" << std::endl;
+}
+} // namespace
+
+int main() {
+    Compiler compiler;
+    auto *graph = compiler.CreateNewGraph();
+    auto *instrBuilder = graph->GetInstructionBuilder();
+    auto *bblock = graph->CreateEmptyBB();
+    graph->SetFirstBB(bblock);
+
+    bench::Timer buildTimer;
+    auto *arg = instrBuilder->BuildArg(OPS_TYPE);
+    instrBuilder->PushBackInst(bblock, arg);
+    SingleInstruction *prev = arg;
+    for (size_t i = 1; i < INSTRS_COUNT; ++i) {
+        auto *add = instrBuilder->BuildAdd(OPS_TYPE, prev, arg);
+        instrBuilder->PushBackInst(bblock, add);
+        prev = add;
+    }
+    auto buildMs = buildTimer.ElapsedMs();
+
+    // insertions into a single point exhaust the gaps there
+    bench::Timer insertTimer;
+    auto *middle = bblock->GetFirstInstBB();
+    for (size_t i = 0; i < INSTRS_COUNT / 2; ++i) {
+        middle = middle->GetNextInst();
+    }
+    for (size_t i = 0; i < INSERTIONS_COUNT; ++i) {
+        auto *instr = instrBuilder->BuildAdd(OPS_TYPE, arg, arg);
+        bblock->InsertSingleInstrBefore(middle, instr);
+    }
+    auto insertMs = insertTimer.ElapsedMs();
+    bool wasValid = bblock->IsInstructionsOrderValid();
+    bench::Timer renumberTimer;
+    bblock->UpdateInstructionsOrder();
+    auto renumberMs = renumberTimer.ElapsedMs();
+
+    bench::PrintHeader("Intra-block ordering, " +
+                       std::to_string(bblock->GetSize()) +
+                       " instructions in a block");
+    std::cout << "build: " << buildMs << " ms, " << INSERTIONS_COUNT
+              << " insertions: " << insertMs << " ms, renumbering"
+              << (wasValid ? " (not needed)" : "") << ": " << renumberMs
+              << " ms" << std::endl;
+
+    bench::PrintCell("query", 28);
+    bench::PrintCell("queries");
+    bench::PrintCell("total, ms");
+    bench::PrintCell("per query, ns");
+    std::cout << std::endl;
+
+    std::vector<SingleInstruction *> instrs(bblock->begin(), bblock->end());
+    RunQueries("linear walk", instrs, WALK_QUERIES_COUNT, IsEarlierByWalk);
+    RunQueries("IsEarlierInBasicBlock", instrs, QUERIES_COUNT,
+               [](SingleInstruction *lhs, SingleInstruction *rhs) {
+                   return lhs->IsEarlierInBasicBlock(rhs);
+               });
+    RunQueries("Dominates", instrs, QUERIES_COUNT,
+               [](SingleInstruction *lhs, SingleInstruction *rhs) {
+                   return lhs->Dominates(rhs);
+               });
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "benchBase.h"
+#include "domTree/loopChecker.h"
+#include "irGen/compiler.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+using namespace ir;
+
+// The forest of a state machine is as deep as a third of its states and an
+// edge is an exit of every loop it leaves, so exits grow quadratically
+constexpr size_t STATES_COUNT = 4000;
+constexpr size_t NESTED_LOOPS_BLOCKS_COUNT = 100000;
+constexpr size_t CONSTRUCTIONS_COUNT = 5;
+
+using GraphBuilder = std::function<void(Graph *)>;
+
+std::vector<BB *> CreateBlocks(Graph *graph, size_t count) {
+    std::vector<BB *> bblocks(count);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    return bblocks;
+}
+
+// Generated state machine, e.g. a lexer: every state jumps straight to one
+// of two states, the region has many entries, so it is irreducible
+void BuildStateMachine(Graph *graph, size_t statesCount) {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<size_t> dist(1, statesCount);
+    auto bblocks = CreateBlocks(graph, statesCount + 2);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    for (size_t i = 1; i <= statesCount; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i % statesCount + 1]);
+        // some of the states accept
+        auto target = dist(gen);
+        graph->ConnectBBs(bblocks[i], target % 64 == 0 ? bblocks.back()
+                                                       : bblocks[target]);
+    }
+}
+
+// The same machine written with a dispatch loop: every state returns to a
+// switch on the next state, which is a tree of branches
+void BuildDispatchLoop(Graph *graph, size_t statesCount) {
+    std::mt19937_64 gen(42);
+    auto bblocks = CreateBlocks(graph, 2 * statesCount + 1);
+    // 1 is the dispatcher, 1..statesCount-1 the switch, the rest are states
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    for (size_t i = 1; i < statesCount; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[2 * i]);
+        graph->ConnectBBs(bblocks[i], bblocks[2 * i + 1]);
+    }
+    for (size_t i = statesCount; i < 2 * statesCount; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[1]);
+        if (gen() % 64 == 0) {
+            graph->ConnectBBs(bblocks[i], bblocks.back());
+        }
+    }
+}
+
+// Chain of reducible loops nested into each other
+void BuildNestedLoops(Graph *graph, size_t count) {
+    auto bblocks = CreateBlocks(graph, count);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+    }
+    for (size_t i = 1; i < count / 2; ++i) {
+        graph->ConnectBBs(bblocks[count - 1 - i], bblocks[i]);
+    }
+}
+
+void RunGraph(Compiler *compiler, const std::string &name,
+              const GraphBuilder &buildGraph) {
+    auto *graph = compiler->CreateNewGraph();
+    buildGraph(graph);
+    graph->GetAnalyses().RequireDomTree();
+
+    bench::Timer timer;
+    for (size_t i = 0; i < CONSTRUCTIONS_COUNT; ++i) {
+        LoopChecker().VerifyGraphLoops(graph);
+    }
+    auto constructionMs = timer.ElapsedMs();
+
+    size_t loopsCount = 0;
+    size_t irreducibleCount = 0;
+    size_t maxDepth = 0;
+    std::vector<const Loop *> worklist(1, graph->GetLoopTree());
+    while (!worklist.empty()) {
+        const auto *loop = worklist.back();
+        worklist.pop_back();
+        maxDepth = std::max(maxDepth, loop->GetDepth());
+        for (const auto *inner : loop->GetInnerLoops()) {
+            ++loopsCount;
+            irreducibleCount += inner->IsIrreducible() ? 1 : 0;
+            worklist.push_back(inner);
+        }
+    }
+    auto blocksInLoops =
+        graph->GetBBCount() - graph->GetLoopTree()->GetBasicBlocks().size();
+
+    bench::PrintCell(name, 20);
+    bench::PrintCell(graph->GetBBCount());
+    bench::PrintCell(loopsCount);
+    bench::PrintCell(irreducibleCount);
+    bench::PrintCell(blocksInLoops);
+    bench::PrintCell(maxDepth);
+    bench::PrintCell(constructionMs / CONSTRUCTIONS_COUNT);
+    std::cout << std::endl;
+    compiler->DeleteFunctionGraph(graph->GetId());
+}
+} // namespace
+
+int main() {
+    bench::PrintHeader("Loop nesting forest");
+    bench::PrintCell("graph", 20);
+    bench::PrintCell("blocks");
+    bench::PrintCell("loops");
+    bench::PrintCell("irreducible");
+    bench::PrintCell("in loops");
+    bench::PrintCell("max depth");
+    bench::PrintCell("build, ms");
+    std::cout << std::endl;
+
+    Compiler compiler;
+    RunGraph(&compiler, "state machine", [](Graph *graph) {
+        BuildStateMachine(graph, STATES_COUNT);
+    });
+    RunGraph(&compiler, "dispatch loop", [](Graph *graph) {
+        BuildDispatchLoop(graph, STATES_COUNT);
+    });
+    RunGraph(&compiler, "nested loops", [](Graph *graph) {
+        BuildNestedLoops(graph, NESTED_LOOPS_BLOCKS_COUNT);
+    });
+    return 0;
+}
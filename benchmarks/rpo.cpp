@@ -0,0 +1,89 @@
+#include "benchBase.h"
+#include "domTree/dfo_rpo.h"
+#include "irGen/compiler.h"
+#include <pthread.h>
+
+namespace {
+using namespace ir;
+
+constexpr size_t BLOCKS_COUNT = 1000000;
+constexpr size_t TRAVERSALS_COUNT = 5;
+// a recursive DFS needs a frame per block of the chain, so it could not run on
+// such a stack
+constexpr size_t THREAD_STACK_SIZE = 64 * 1024;
+
+// Builds a chain of blocks, every block also branches back to the entry, so
+// the DFS both goes 1M blocks deep and meets visited blocks on each step
+Graph *BuildGraph(Compiler *compiler) {
+    auto *graph = compiler->CreateNewGraph();
+    auto *entry = graph->CreateEmptyBB();
+    graph->SetFirstBB(entry);
+    auto *prev = entry;
+    for (size_t i = 1; i < BLOCKS_COUNT; ++i) {
+        auto *bblock = graph->CreateEmptyBB();
+        graph->ConnectBBs(prev, bblock);
+        graph->ConnectBBs(bblock, entry);
+        prev = bblock;
+    }
+    return graph;
+}
+
+struct TraversalResult {
+    Graph *graph;
+    double elapsedMs = 0;
+    size_t checksum = 0;
+    size_t scratchBytes = 0;
+};
+
+void *TraverseGraph(void *arg) {
+    auto *result = static_cast<TraversalResult *>(arg);
+    auto *graph = result->graph;
+    bench::Timer timer;
+    for (size_t i = 0; i < TRAVERSALS_COUNT; ++i) {
+        memory::ArenaScope scope(graph->GetScratchAllocator());
+        auto rpo = RPO(graph);
+        result->checksum += rpo.back()->GetId();
+        result->scratchBytes =
+            graph->GetScratchAllocator()->GetUsedSize();
+    }
+    result->elapsedMs = timer.ElapsedMs();
+    return nullptr;
+}
+} // namespace
+
+int main() {
+    Compiler compiler;
+    bench::Timer buildTimer;
+    auto *graph = BuildGraph(&compiler);
+    auto buildMs = buildTimer.ElapsedMs();
+
+    TraversalResult result{graph};
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, THREAD_STACK_SIZE);
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, TraverseGraph, &result) != 0) {
+        std::cerr << "failed to start the traversal thread" << std::endl;
+        return 1;
+    }
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+
+    bench::PrintHeader("RPO of a " + std::to_string(BLOCKS_COUNT) +
+                       "-block chain on a " +
+                       std::to_string(THREAD_STACK_SIZE / 1024) +
+                       "K stack");
+    std::cout << "build: " << buildMs << " ms" << std::endl;
+    bench::PrintCell("traversals");
+    bench::PrintCell("total, ms");
+    bench::PrintCell("per block, ns");
+    bench::PrintCell("scratch, KB");
+    std::cout << std::endl;
+    bench::PrintCell(TRAVERSALS_COUNT);
+    bench::PrintCell(result.elapsedMs);
+    bench::PrintCell(result.elapsedMs * 1e6 /
+                     static_cast<double>(TRAVERSALS_COUNT * BLOCKS_COUNT));
+    bench::PrintCell(result.scratchBytes / 1024);
+    std::cout << "  (checksum " << result.checksum << ")" << std::endl;
+    return 0;
+}
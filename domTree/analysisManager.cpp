@@ -0,0 +1,59 @@
+#include "analysisManager.h"
+#include "dfo_rpo.h"
+#include "domTree.h"
+#include "loopChecker.h"
+
+namespace ir {
+
+const memory::ArenaVector<BB *> &AnalysisManager::GetRPO() {
+    if (!IsValid(AnalysisKind::RPO)) {
+        memory::ArenaScope scope(graph_->GetScratchAllocator());
+        auto order = RPO(graph_);
+        rpo_.assign(order.begin(), order.end());
+        CountComputation(AnalysisKind::RPO);
+        SetValid(AnalysisKind::RPO);
+    }
+    return rpo_;
+}
+
+void AnalysisManager::RequireDomTree() {
+    if (!IsValid(AnalysisKind::DOM_TREE)) {
+        auto *builder = GetThreadLocalDomTreeBuilder();
+        builder->SetAlgorithm(domTreeAlgorithm_);
+        builder->Construct(graph_);
+    } else if (!domTreeNumbered_) {
+        DomTreeBuilder::NumberDomTree(graph_);
+    }
+}
+
+void AnalysisManager::RequirePostDomTree() {
+    if (!IsValid(AnalysisKind::POST_DOM_TREE)) {
+        auto *builder = GetThreadLocalDomTreeBuilder<ReverseCFG>();
+        builder->SetAlgorithm(domTreeAlgorithm_);
+        builder->Construct(graph_);
+    }
+}
+
+Loop *AnalysisManager::GetLoopTree() {
+    if (!IsValid(AnalysisKind::LOOP_TREE)) {
+        LoopChecker().VerifyGraphLoops(graph_);
+    }
+    return graph_->GetLoopTree();
+}
+
+void AnalysisManager::Require(AnalysisSet analyses) {
+    if (analyses.Contains(AnalysisKind::RPO)) {
+        GetRPO();
+    }
+    if (analyses.Contains(AnalysisKind::DOM_TREE)) {
+        RequireDomTree();
+    }
+    if (analyses.Contains(AnalysisKind::POST_DOM_TREE)) {
+        RequirePostDomTree();
+    }
+    if (analyses.Contains(AnalysisKind::LOOP_TREE)) {
+        GetLoopTree();
+    }
+}
+
+} // namespace ir
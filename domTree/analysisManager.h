@@ -0,0 +1,137 @@
+#ifndef JIT_AOT_COURSE_DOMTREE_ANALYSIS_MANAGER_H_
+#define JIT_AOT_COURSE_DOMTREE_ANALYSIS_MANAGER_H_
+
+#include "arena.h"
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+namespace ir {
+class Graph;
+class BB;
+class Loop;
+
+enum class AnalysisKind : uint8_t {
+    RPO = 0,
+    DOM_TREE,
+    POST_DOM_TREE,
+    LOOP_TREE,
+    COUNT
+};
+
+enum class DomTreeAlgorithm : uint8_t {
+    // Immediate dominators are derived from the buckets of vertices with the
+    // same semi-dominator while semi-dominators are computed
+    LENGAUER_TARJAN,
+    // Immediate dominators are the nearest common ancestors of the DFS
+    // parents and semi-dominators in the growing dominator tree. Does less
+    // work per vertex, so it is usually faster on small and medium CFGs
+    SEMI_NCA,
+};
+
+static constexpr auto DEFAULT_DOM_TREE_ALGORITHM =
+    DomTreeAlgorithm::LENGAUER_TARJAN;
+
+// Set of analyses, passes describe with it what they need and preserve
+class AnalysisSet {
+  public:
+    constexpr AnalysisSet() = default;
+    constexpr AnalysisSet(std::initializer_list<AnalysisKind> kinds) {
+        for (auto kind : kinds) {
+            bits_ |= toBit(kind);
+        }
+    }
+
+    static constexpr AnalysisSet All() {
+        return AnalysisSet(toBit(AnalysisKind::COUNT) - 1);
+    }
+
+    constexpr bool Contains(AnalysisKind kind) const {
+        return (bits_ & toBit(kind)) != 0;
+    }
+    constexpr bool IsEmpty() const { return bits_ == 0; }
+
+    constexpr AnalysisSet operator|(AnalysisSet other) const {
+        return AnalysisSet(bits_ | other.bits_);
+    }
+    constexpr AnalysisSet operator&(AnalysisSet other) const {
+        return AnalysisSet(bits_ & other.bits_);
+    }
+    constexpr AnalysisSet operator~() const {
+        return AnalysisSet(~bits_ & All().bits_);
+    }
+    constexpr bool operator==(const AnalysisSet &) const = default;
+
+  private:
+    constexpr explicit AnalysisSet(uint8_t bits) : bits_(bits) {}
+    static constexpr uint8_t toBit(AnalysisKind kind) {
+        return static_cast<uint8_t>(1U << static_cast<uint8_t>(kind));
+    }
+
+    uint8_t bits_ = 0;
+};
+
+// Caches results of the analyses of a graph. CFG mutators drop all of them,
+// dominator tree edits drop only the dominator tree. The results live in the
+// graph itself (dominators, post-dominators and loops of blocks, the loop
+// tree) except for the RPO, which is kept in the graph's arena.
+class AnalysisManager {
+  public:
+    AnalysisManager(Graph *graph, memory::ArenaAllocator *allocator)
+        : graph_(graph), rpo_(allocator->ToSTL(memory::ArenaTag::BB_ORDERS)),
+          domTreeAlgorithm_(DEFAULT_DOM_TREE_ALGORITHM) {}
+    AnalysisManager(const AnalysisManager &) = delete;
+    AnalysisManager &operator=(const AnalysisManager &) = delete;
+    AnalysisManager(AnalysisManager &&) = delete;
+    AnalysisManager &operator=(AnalysisManager &&) = delete;
+    ~AnalysisManager() = default;
+
+    // Getters compute the analysis when it is not valid. The returned order
+    // must be copied by a pass changing the CFG while walking it.
+    const memory::ArenaVector<BB *> &GetRPO();
+    void RequireDomTree();
+    void RequirePostDomTree();
+    Loop *GetLoopTree();
+    void Require(AnalysisSet analyses);
+
+    // Algorithm of the following dominator tree constructions, it does not
+    // invalidate the current tree
+    DomTreeAlgorithm GetDomTreeAlgorithm() const { return domTreeAlgorithm_; }
+    void SetDomTreeAlgorithm(DomTreeAlgorithm algorithm) {
+        domTreeAlgorithm_ = algorithm;
+    }
+
+    // Blocks keep DFS intervals of the dominator tree, incremental updates of
+    // the tree make them stale until RequireDomTree renumbers the tree
+    bool IsDomTreeNumbered() const {
+        return IsValid(AnalysisKind::DOM_TREE) && domTreeNumbered_;
+    }
+    void SetDomTreeNumbered(bool numbered) { domTreeNumbered_ = numbered; }
+
+    bool IsValid(AnalysisKind kind) const { return valid_.Contains(kind); }
+    AnalysisSet GetValid() const { return valid_; }
+    // Called by the analyses themselves once their results are stored
+    void SetValid(AnalysisKind kind) { valid_ = valid_ | AnalysisSet{kind}; }
+    void Invalidate(AnalysisSet analyses) { valid_ = valid_ & ~analyses; }
+    void InvalidateAll() { valid_ = AnalysisSet(); }
+
+    // Number of times an analysis was computed on the graph
+    size_t GetComputationsCount(AnalysisKind kind) const {
+        return computations_[static_cast<size_t>(kind)];
+    }
+    void CountComputation(AnalysisKind kind) {
+        ++computations_[static_cast<size_t>(kind)];
+    }
+
+  private:
+    Graph *graph_;
+    memory::ArenaVector<BB *> rpo_;
+    AnalysisSet valid_;
+    DomTreeAlgorithm domTreeAlgorithm_;
+    bool domTreeNumbered_ = false;
+    std::array<size_t, static_cast<size_t>(AnalysisKind::COUNT)>
+        computations_{};
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_DOMTREE_ANALYSIS_MANAGER_H_
@@ -1,14 +1,15 @@
 #include "arena.h"
 #include "sys/mman.h"
 #include <cassert>
+#include <iomanip>
+#include <iostream>
 
 namespace memory {
 ArenaAllocator::~ArenaAllocator() noexcept {
     assert(arenaList);
     while (arenaList) {
-        assert(munmap(arenaList->start, arenaList->GetSize()) == 0);
         auto *next = arenaList->GetNextArena();
-        delete arenaList;
+        releaseArena(arenaList);
         arenaList = next;
     }
 }
@@ -24,29 +25,266 @@ void *Arena::Alloc(size_t sz, size_t alignSize) {
     return aligned;
 }
 
-void ArenaAllocator::addNewArena() {
-    void *mem = mmap(nullptr, arenaSize, PROT_WRITE,
-                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    assert(mem != MAP_FAILED);
-    auto *newArena = new Arena(mem, arenaSize);
+size_t ArenaAllocator::GetArenasCount() const {
+    size_t count = 0;
+    for (const auto *arena = arenaList; arena; arena = arena->GetNextArena()) {
+        ++count;
+    }
+    return count;
+}
+
+size_t ArenaAllocator::GetUsedSize() const {
+    size_t used = 0;
+    for (const auto *arena = arenaList; arena; arena = arena->GetNextArena()) {
+        used += arena->GetSize() - arena->GetFreeSize();
+    }
+    return used;
+}
+
+void ArenaAllocator::Rollback(const Checkpoint &checkpoint) {
+    assert(checkpoint.arena);
+    // arenas are kept in the list from the newest to the oldest one
+    while (arenaList != checkpoint.arena) {
+        assert(arenaList);
+        auto *next = arenaList->GetNextArena();
+        releaseArena(arenaList);
+        arenaList = next;
+    }
+    arenaList->end = checkpoint.end;
+    arenaList->freeSize = checkpoint.freeSize;
+    arenaSize = checkpoint.arenaSize;
+}
+
+void ArenaAllocator::Reset() {
+    assert(arenaList);
+    while (arenaList->GetNextArena()) {
+        auto *next = arenaList->GetNextArena();
+        releaseArena(arenaList);
+        arenaList = next;
+    }
+    arenaList->end = arenaList->start;
+    arenaList->freeSize = arenaList->GetSize();
+    arenaSize = arenaList->GetSize();
+    growArenaSize();
+    tagStats = {};
+}
+
+void ArenaAllocator::addNewArena(size_t size) {
+    assert(size % PAGE_SIZE == 0);
+    void *mem = mapMemory(size);
+    auto *newArena = new Arena(mem, size);
     assert(newArena);
     newArena->SetNextArena(arenaList);
     arenaList = newArena;
 }
 
-void *ArenaAllocator::allocate(size_t size) {
-    auto addr = arenaList->Alloc(size, alignment);
-    if (addr == nullptr) {
-        if (size > arenaList->GetSize()) {
-            arenaSize = AlignUp(size, PAGE_SIZE);
+bool ArenaAllocator::isHugePageBacked(size_t size) const {
+    return policy.useHugePages && size >= HUGE_PAGE_SIZE &&
+           size % HUGE_PAGE_SIZE == 0;
+}
+
+bool ArenaAllocator::isChunkCached(size_t size) const {
+    // huge-page-backed chunks are aligned specially, so they are not shared
+    return policy.useChunkCache && !isHugePageBacked(size) &&
+           ChunkCache::IsCacheable(size);
+}
+
+void *ArenaAllocator::mapMemory(size_t size) {
+    if (isChunkCached(size)) {
+        if (auto *chunk = ChunkCache::Get().Pop(size)) {
+            ++stats.chunkCacheHits;
+            return chunk;
         }
-        addNewArena();
-        return allocate(size);
+        ++stats.chunkCacheMisses;
     }
+
+    bool useHugePages = isHugePageBacked(size);
+    // transparent huge pages can back only 2MB-aligned ranges, so map
+    // an extra huge page and trim the unaligned head and tail
+    auto mappedSize = useHugePages ? size + HUGE_PAGE_SIZE : size;
+    void *mem = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ++stats.mmapCalls;
+    assert(mem != MAP_FAILED);
+    if (!useHugePages) {
+        return mem;
+    }
+
+    auto start = UintptrT(mem);
+    auto alignedStart = AlignUp(start, HUGE_PAGE_SIZE);
+    auto mappedEnd = start + mappedSize;
+    auto alignedEnd = alignedStart + size;
+    if (alignedStart != start) {
+        munmap(mem, alignedStart - start);
+        ++stats.munmapCalls;
+    }
+    if (alignedEnd != mappedEnd) {
+        munmap(VoidPtrT(alignedEnd), mappedEnd - alignedEnd);
+        ++stats.munmapCalls;
+    }
+    // the hint is best-effort: THP may be disabled system-wide
+    madvise(VoidPtrT(alignedStart), size, MADV_HUGEPAGE);
+    ++stats.madviseCalls;
+    return VoidPtrT(alignedStart);
+}
+
+void ArenaAllocator::unmapMemory(void *mem, size_t size) {
+    if (isChunkCached(size)) {
+        ChunkCache::Get().Push(mem, size);
+        return;
+    }
+    [[maybe_unused]] auto res = munmap(mem, size);
+    assert(res == 0);
+    ++stats.munmapCalls;
+}
+
+void ArenaAllocator::releaseArena(Arena *arena) {
+    assert(arena);
+    unmapMemory(arena->start, arena->GetSize());
+    delete arena;
+}
+
+void ArenaAllocator::growArenaSize() {
+    auto grown = arenaSize * policy.growthFactor;
+    arenaSize = std::max(arenaSize,
+                         AlignUp(std::min(grown, policy.maxSize), PAGE_SIZE));
+}
+
+void *ArenaAllocator::allocate(size_t size, size_t align,
+                               [[maybe_unused]] ArenaTag tag) {
+    assert(IsPowerOfTwo(align));
+#ifdef ARENA_ALLOCATION_TAGS
+    auto &counters = tagStats[static_cast<size_t>(
+        tag == ArenaTag::UNTAGGED ? currentTag : tag)];
+    counters.bytes += size;
+    ++counters.objects;
+#endif
+    auto addr = arenaList->Alloc(size, align);
+    if (addr != nullptr) {
+        return addr;
+    }
+
+    // reserve space for the worst-case alignment padding
+    auto required = AlignUp(size + align, PAGE_SIZE);
+    if (required > arenaSize) {
+        // oversized allocations get a dedicated arena and must not affect
+        // the sizes of the following ones
+        addNewArena(required);
+    } else {
+        addNewArena(arenaSize);
+        growArenaSize();
+    }
+    addr = arenaList->Alloc(size, align);
+    assert(addr);
     return addr;
 }
 
-STLCompliantArenaAllocator<int> ArenaAllocator::ToSTL() {
-    return STLCompliantArenaAllocator<int>(this);
+STLCompliantArenaAllocator<int> ArenaAllocator::ToSTL(ArenaTag tag) {
+    return STLCompliantArenaAllocator<int>(this, tag);
+}
+
+const char *GetArenaTagName(ArenaTag tag) {
+    static constexpr std::array<const char *,
+                                static_cast<size_t>(ArenaTag::COUNT)>
+        names{"untagged",         "instructions",
+              "basic blocks",     "inputs",
+              "cfg edges",        "dominated bbs",
+              "phi sources",      "dominator tables",
+              "dom frontiers",    "loop info",
+              "copy maps",        "bb orders"};
+    assert(tag < ArenaTag::COUNT);
+    return names[static_cast<size_t>(tag)];
+}
+
+void ArenaAllocator::DumpTagStats(std::ostream &out) const {
+#ifndef ARENA_ALLOCATION_TAGS
+    out << "arena allocation tags are disabled" << std::endl;
+#else
+    size_t totalBytes = 0;
+    for (const auto &counters : tagStats) {
+        totalBytes += counters.bytes;
+    }
+    out << std::left << std::setw(20) << "tag" << std::right << std::setw(12)
+        << "objects" << std::setw(12) << "bytes" << std::setw(8) << "%"
+        << std::endl;
+    for (size_t i = 0; i < tagStats.size(); ++i) {
+        const auto &counters = tagStats[i];
+        if (counters.objects == 0) {
+            continue;
+        }
+        auto share = totalBytes == 0 ? 0.0
+                                     : 100.0 * static_cast<double>(
+                                                   counters.bytes) /
+                                           static_cast<double>(totalBytes);
+        out << std::left << std::setw(20)
+            << GetArenaTagName(static_cast<ArenaTag>(i)) << std::right
+            << std::setw(12) << counters.objects << std::setw(12)
+            << counters.bytes << std::setw(8) << std::fixed
+            << std::setprecision(1) << share << std::endl;
+    }
+#endif
+}
+
+ArenaAllocator *GetThreadLocalAllocator() {
+    thread_local ArenaAllocator allocator;
+    return &allocator;
+}
+
+ChunkCache &ChunkCache::Get() {
+    // never destroyed, as arenas may be released during the program exit
+    static auto *cache = new ChunkCache();
+    return *cache;
+}
+
+bool ChunkCache::IsCacheable(size_t size) {
+    return size >= MIN_CHUNK_SIZE && size <= MAX_CHUNK_SIZE &&
+           IsPowerOfTwo(size);
+}
+
+size_t ChunkCache::getSizeClass(size_t size) {
+    assert(IsCacheable(size));
+    size_t sizeClass = 0;
+    for (; (MIN_CHUNK_SIZE << sizeClass) < size; ++sizeClass) {
+    }
+    return sizeClass;
+}
+
+void *ChunkCache::Pop(size_t size) {
+    auto &head = heads_[getSizeClass(size)];
+    auto current = head.load(std::memory_order_acquire);
+    while (true) {
+        auto *chunk = reinterpret_cast<uintptr_t *>(current & ~TAG_MASK);
+        if (chunk == nullptr) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        // the chunk may be concurrently popped and reused, in which case
+        // the read link is garbage, but the tag makes the exchange fail
+        auto next = std::atomic_ref<uintptr_t>(*chunk).load(
+            std::memory_order_relaxed);
+        auto tag = (current + 1) & TAG_MASK;
+        if (head.compare_exchange_weak(current, next | tag,
+                                       std::memory_order_acquire,
+                                       std::memory_order_acquire)) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return chunk;
+        }
+    }
+}
+
+void ChunkCache::Push(void *chunk, size_t size) {
+    assert((chunk) && (UintptrT(chunk) & TAG_MASK) == 0);
+    auto &head = heads_[getSizeClass(size)];
+    auto current = head.load(std::memory_order_relaxed);
+    while (true) {
+        std::atomic_ref<uintptr_t>(*static_cast<uintptr_t *>(chunk))
+            .store(current & ~TAG_MASK, std::memory_order_relaxed);
+        auto tag = (current + 1) & TAG_MASK;
+        if (head.compare_exchange_weak(current, UintptrT(chunk) | tag,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+            return;
+        }
+    }
 }
 } // namespace memory
\ No newline at end of file
@@ -1,7 +1,12 @@
 #ifndef JIT_AOT_COURSE_ARENA_H_
 #define JIT_AOT_COURSE_ARENA_H_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <iosfwd>
 #include <memory>
 #include <set>
 #include <type_traits>
@@ -76,13 +81,116 @@ using ArenaUnorderedMap = std::unordered_map<
     KeyT, ValueT, std::hash<KeyT>, std::equal_to<KeyT>,
     STLCompliantArenaAllocator<std::pair<const KeyT, ValueT>>>;
 
+// Subsystems owning arena memory, used to break the footprint of a graph down.
+// Accounting is compiled in only with ARENA_ALLOCATION_TAGS defined.
+enum class ArenaTag : uint8_t {
+    UNTAGGED,
+    INSTRUCTIONS,
+    BASIC_BLOCKS,
+    INPUTS,
+    CFG_EDGES,
+    DOMINATED_BBS,
+    PHI_SOURCES,
+    DOMINATOR_TABLES,
+    DOMINANCE_FRONTIERS,
+    LOOP_INFO,
+    COPY_MAPS,
+    BB_ORDERS,
+    COUNT
+};
+
+const char *GetArenaTagName(ArenaTag tag);
+
+struct ArenaTagStats {
+    size_t bytes = 0;
+    size_t objects = 0;
+};
+
+// Describes how the sizes of arenas requested from the OS evolve
+struct ArenaGrowthPolicy {
+    size_t initialSize;
+    // Arenas do not grow beyond this size; a single allocation which does not
+    // fit into it gets a dedicated arena of a suitable size
+    size_t maxSize;
+    size_t growthFactor;
+    // Back arenas of at least HUGE_PAGE_SIZE with transparent huge pages
+    bool useHugePages;
+    // Take arenas from the process-wide ChunkCache and return them there
+    // instead of mapping and unmapping each one
+    bool useChunkCache = false;
+};
+
+// Counters of the OS calls done by the allocator
+struct ArenaStats {
+    size_t mmapCalls = 0;
+    size_t munmapCalls = 0;
+    size_t madviseCalls = 0;
+    size_t chunkCacheHits = 0;
+    size_t chunkCacheMisses = 0;
+};
+
+// Process-wide cache of free arena chunks shared by all the threads, so that
+// concurrent compilations do not contend on mmap/munmap. Chunks of every
+// power-of-two size are kept in a lock-free stack, the link to the next chunk
+// is stored in the free chunk itself. Cached chunks are never unmapped, thus a
+// thread racing on a stale stack head can always read the link safely.
+class ChunkCache final {
+  public:
+    static ChunkCache &Get();
+
+    ChunkCache(const ChunkCache &) = delete;
+    ChunkCache &operator=(const ChunkCache &) = delete;
+    ChunkCache(ChunkCache &&) = delete;
+    ChunkCache &operator=(ChunkCache &&) = delete;
+    ~ChunkCache() = default;
+
+    static bool IsCacheable(size_t size);
+    // Returns nullptr if there is no free chunk of the size
+    [[nodiscard]] void *Pop(size_t size);
+    void Push(void *chunk, size_t size);
+
+    size_t GetHits() const { return hits_.load(std::memory_order_relaxed); }
+    size_t GetMisses() const {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    static constexpr size_t MIN_CHUNK_SIZE = 4096;
+    static constexpr size_t SIZE_CLASSES_COUNT = 10;
+    static constexpr size_t MAX_CHUNK_SIZE = MIN_CHUNK_SIZE
+                                             << (SIZE_CLASSES_COUNT - 1);
+
+  private:
+    ChunkCache() = default;
+
+    static size_t getSizeClass(size_t size);
+
+    // chunks are page-aligned, so the lower bits of a stack head keep a
+    // modification counter protecting from ABA
+    static constexpr uintptr_t TAG_MASK = MIN_CHUNK_SIZE - 1;
+
+    std::array<std::atomic<uintptr_t>, SIZE_CLASSES_COUNT> heads_{};
+    std::atomic<size_t> hits_ = 0;
+    std::atomic<size_t> misses_ = 0;
+};
+
 class ArenaAllocator final {
   public:
     explicit ArenaAllocator(size_t arenaSize = DEFAULT_ARENA_SIZE,
                             size_t alignment = DEFAULT_ALIGNMENT)
-        : arenaList(nullptr), arenaSize(AlignUp(arenaSize, PAGE_SIZE)),
+        : ArenaAllocator(
+              ArenaGrowthPolicy{arenaSize,
+                                std::max(arenaSize, DEFAULT_MAX_ARENA_SIZE),
+                                DEFAULT_GROWTH_FACTOR, false, true},
+              alignment) {}
+    explicit ArenaAllocator(const ArenaGrowthPolicy &policy,
+                            size_t alignment = DEFAULT_ALIGNMENT)
+        : arenaList(nullptr), policy(policy),
+          arenaSize(AlignUp(policy.initialSize, PAGE_SIZE)),
           alignment(alignment) {
-        addNewArena();
+        assert(policy.growthFactor >= 1);
+        assert(policy.initialSize <= policy.maxSize);
+        addNewArena(arenaSize);
+        growArenaSize();
     }
 
     // No copy semantics
@@ -95,19 +203,71 @@ class ArenaAllocator final {
 
     ~ArenaAllocator() noexcept;
     size_t GetFreeSize() const { return arenaList->GetFreeSize(); }
-    STLCompliantArenaAllocator<int> ToSTL();
+    size_t GetArenasCount() const;
+    // Bytes taken from all the arenas, including the unused tails of the
+    // older ones
+    size_t GetUsedSize() const;
+    const ArenaGrowthPolicy &GetGrowthPolicy() const { return policy; }
+    const ArenaStats &GetStats() const { return stats; }
+    // Containers allocate with the given tag, the untagged ones use the tag
+    // current at the moment of allocation
+    STLCompliantArenaAllocator<int> ToSTL(ArenaTag tag = ArenaTag::UNTAGGED);
+
+    // Tag of untagged allocations, see ArenaTagScope
+    ArenaTag GetCurrentTag() const { return currentTag; }
+    void SetCurrentTag(ArenaTag tag) { currentTag = tag; }
+    // Counters are cumulative: memory released by Rollback is not subtracted
+    const ArenaTagStats &GetTagStats(ArenaTag tag) const {
+        return tagStats[static_cast<size_t>(tag)];
+    }
+    void DumpTagStats(std::ostream &out) const;
+
+    // Snapshot of the bump pointer, used to release everything allocated
+    // after it at once
+    struct Checkpoint {
+        Arena *arena;
+        void *end;
+        size_t freeSize;
+        size_t arenaSize;
+    };
+
+    Checkpoint GetCheckpoint() const {
+        return {arenaList, arenaList->end, arenaList->freeSize, arenaSize};
+    }
+    void Rollback(const Checkpoint &checkpoint);
+    // Releases all the allocated memory except for the first arena
+    void Reset();
 
     template <typename T> [[nodiscard]] T *AllocateArray(size_t n) {
-        auto p = allocate(sizeof(T) * n);
-        if (p == nullptr) {
-            return nullptr;
-        }
-        return static_cast<T *>(p);
+        return AllocateAlignedArray<T>(n, alignof(T));
+    }
+
+    template <typename T>
+    [[nodiscard]] T *AllocateArray(size_t n, ArenaTag tag) {
+        return static_cast<T *>(allocate(
+            sizeof(T) * n, std::max(alignof(T), alignment), tag));
+    }
+
+    // Allocates an array aligned at least to align, which must be a power of
+    // two, e.g. to place it on separate cache lines
+    template <typename T>
+    [[nodiscard]] T *AllocateAlignedArray(size_t n, size_t align) {
+        assert(align >= alignof(T));
+        return static_cast<T *>(AllocateAligned(sizeof(T) * n, align));
+    }
+
+    [[nodiscard]] void *AllocateAligned(size_t size, size_t align) {
+        return allocate(size, std::max(align, alignment));
     }
 
     template <typename T, typename... ArgsT>
     [[nodiscard]] T *New(ArgsT &&...args) {
-        auto p = allocate(sizeof(T));
+        return NewWithTag<T>(ArenaTag::UNTAGGED, std::forward<ArgsT>(args)...);
+    }
+
+    template <typename T, typename... ArgsT>
+    [[nodiscard]] T *NewWithTag(ArenaTag tag, ArgsT &&...args) {
+        auto p = allocate(sizeof(T), std::max(alignof(T), alignment), tag);
         if (p == nullptr) {
             return nullptr;
         }
@@ -123,18 +283,75 @@ class ArenaAllocator final {
     [[nodiscard]] inline ArenaVector<T> *NewVector(ArgsT &&...args);
 
     static constexpr size_t DEFAULT_ARENA_SIZE = 4096;
+    static constexpr size_t DEFAULT_MAX_ARENA_SIZE = 256 * 1024;
+    static constexpr size_t DEFAULT_GROWTH_FACTOR = 2;
+    static constexpr size_t PAGE_SIZE = 4096;
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
 
   private:
-    void addNewArena();
-    void *allocate(size_t size);
+    void addNewArena(size_t size);
+    void *mapMemory(size_t size);
+    void unmapMemory(void *mem, size_t size);
+    bool isHugePageBacked(size_t size) const;
+    bool isChunkCached(size_t size) const;
+    void releaseArena(Arena *arena);
+    void growArenaSize();
+    void *allocate(size_t size, size_t align,
+                   ArenaTag tag = ArenaTag::UNTAGGED);
 
     Arena *arenaList;
+    ArenaGrowthPolicy policy;
+    // size of the next regular arena
     size_t arenaSize;
     size_t alignment;
+    ArenaStats stats;
+    ArenaTag currentTag = ArenaTag::UNTAGGED;
+    std::array<ArenaTagStats, static_cast<size_t>(ArenaTag::COUNT)> tagStats;
+};
 
-    static constexpr size_t PAGE_SIZE = 4096;
+// Releases all the memory allocated from the allocator during the scope's
+// lifetime. Objects allocated inside the scope must not outlive it.
+class ArenaScope final {
+  public:
+    explicit ArenaScope(ArenaAllocator *const allocator)
+        : allocator_(allocator), checkpoint_(allocator->GetCheckpoint()) {
+        assert(allocator_);
+    }
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+    ArenaScope(ArenaScope &&) = delete;
+    ArenaScope &operator=(ArenaScope &&) = delete;
+    ~ArenaScope() noexcept { allocator_->Rollback(checkpoint_); }
+
+  private:
+    ArenaAllocator *const allocator_;
+    const ArenaAllocator::Checkpoint checkpoint_;
+};
+
+// Tags untagged allocations done during the scope's lifetime
+class ArenaTagScope final {
+  public:
+    ArenaTagScope(ArenaAllocator *const allocator, ArenaTag tag)
+        : allocator_(allocator), previousTag_(allocator->GetCurrentTag()) {
+        assert(allocator_);
+        allocator_->SetCurrentTag(tag);
+    }
+    ArenaTagScope(const ArenaTagScope &) = delete;
+    ArenaTagScope &operator=(const ArenaTagScope &) = delete;
+    ArenaTagScope(ArenaTagScope &&) = delete;
+    ArenaTagScope &operator=(ArenaTagScope &&) = delete;
+    ~ArenaTagScope() noexcept { allocator_->SetCurrentTag(previousTag_); }
+
+  private:
+    ArenaAllocator *const allocator_;
+    const ArenaTag previousTag_;
 };
 
+// Arena of the calling thread for transient data of the compiler threads, its
+// chunks come from the shared ChunkCache
+ArenaAllocator *GetThreadLocalAllocator();
+
 template <typename T> class STLCompliantArenaAllocator {
   public:
     using pointer = T *;
@@ -142,15 +359,16 @@ template <typename T> class STLCompliantArenaAllocator {
     using size_type = size_t;
     using difference_type = size_t;
 
-    explicit STLCompliantArenaAllocator(ArenaAllocator *const alloc)
-        : allocator(alloc) {
+    explicit STLCompliantArenaAllocator(ArenaAllocator *const alloc,
+                                        ArenaTag tag = ArenaTag::UNTAGGED)
+        : allocator(alloc), tag(tag) {
         assert(allocator);
     }
     STLCompliantArenaAllocator() : allocator(nullptr) {}
 
     template <typename V>
     STLCompliantArenaAllocator(const STLCompliantArenaAllocator<V> &other)
-        : allocator(other.GetAllocator()) {}
+        : allocator(other.GetAllocator()), tag(other.GetTag()) {}
 
     STLCompliantArenaAllocator(const STLCompliantArenaAllocator &) noexcept =
         default;
@@ -163,12 +381,13 @@ template <typename T> class STLCompliantArenaAllocator {
     virtual ~STLCompliantArenaAllocator() noexcept = default;
 
     [[nodiscard]] pointer allocate(size_type n) {
-        return allocator->template AllocateArray<T>(n);
+        return allocator->template AllocateArray<T>(n, tag);
     }
 
     void deallocate([[maybe_unused]] pointer p, [[maybe_unused]] size_type n) {}
 
     ArenaAllocator *GetAllocator() const { return allocator; }
+    ArenaTag GetTag() const { return tag; }
 
     template <typename U>
     bool operator==(const STLCompliantArenaAllocator<U> &other) const noexcept {
@@ -182,6 +401,7 @@ template <typename T> class STLCompliantArenaAllocator {
 
   private:
     ArenaAllocator *const allocator;
+    const ArenaTag tag = ArenaTag::UNTAGGED;
 };
 
 template <typename T>
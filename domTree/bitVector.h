@@ -0,0 +1,69 @@
+#ifndef JIT_AOT_COURSE_DOMTREE_BIT_VECTOR_H_
+#define JIT_AOT_COURSE_DOMTREE_BIT_VECTOR_H_
+
+#include "arena.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+namespace ir {
+// Dense fixed-size set of indices, e.g. of blocks by their ids
+class BitVector {
+  public:
+    BitVector(size_t size, memory::ArenaAllocator *allocator,
+              memory::ArenaTag tag = memory::ArenaTag::UNTAGGED)
+        : size_(size), words_(wordsCount(size), 0, allocator->ToSTL(tag)) {}
+
+    size_t Size() const { return size_; }
+
+    bool Test(size_t idx) const {
+        assert(idx < size_);
+        return (words_[idx / WORD_BITS] & bit(idx)) != 0;
+    }
+    void Set(size_t idx) {
+        assert(idx < size_);
+        words_[idx / WORD_BITS] |= bit(idx);
+    }
+    void Reset(size_t idx) {
+        assert(idx < size_);
+        words_[idx / WORD_BITS] &= ~bit(idx);
+    }
+    // Sets the bit and returns its previous value
+    bool TestAndSet(size_t idx) {
+        assert(idx < size_);
+        auto &word = words_[idx / WORD_BITS];
+        bool wasSet = (word & bit(idx)) != 0;
+        word |= bit(idx);
+        return wasSet;
+    }
+    void Clear() { std::fill(words_.begin(), words_.end(), 0); }
+    // Clears the set and changes its size, keeping the storage when possible
+    void Resize(size_t size) {
+        size_ = size;
+        words_.assign(wordsCount(size), 0);
+    }
+
+    size_t Count() const {
+        size_t count = 0;
+        for (auto word : words_) {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+
+  private:
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t wordsCount(size_t size) {
+        return (size + WORD_BITS - 1) / WORD_BITS;
+    }
+    static constexpr uint64_t bit(size_t idx) {
+        return uint64_t{1} << (idx % WORD_BITS);
+    }
+
+    size_t size_;
+    memory::ArenaVector<uint64_t> words_;
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_DOMTREE_BIT_VECTOR_H_
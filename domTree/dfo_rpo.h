@@ -3,46 +3,50 @@
 
 #include "arena.h"
 #include "bb.h"
+#include "bitVector.h"
 #include "graph.h"
-#include <functional>
 #include <iostream>
-#include <set>
+#include <utility>
 #include <vector>
 
 namespace ir {
 
-using DFOCallback = std::function<void(BB *)>;
-using memory::ArenaSet;
 using memory::ArenaVector;
 
+// Depth-first traversal calling back for every block in post order. The DFS
+// keeps an explicit stack, so the depth of a CFG is limited only by memory,
+// and marks visited blocks in a bitset indexed by block ids. Both live in the
+// graph's scratch arena until the caller's ArenaScope on it is closed.
 class DFO {
   public:
     ~DFO() = default;
 
     template <typename GraphT, typename CallbackT>
-    void ValidateGraph(GraphT *graph, CallbackT callback) {
+    void ValidateGraph(GraphT *graph, CallbackT &&callback) {
         assert(graph);
         if (graph->IsEmpty()) {
             return;
         }
 
+        auto *allocator = graph->GetScratchAllocator();
         if (!visited_) {
-            auto *allocator = graph->GetAllocator();
-            visited_ = allocator->template New<memory::ArenaSet<size_t>>(
-                allocator->ToSTL());
+            visited_ = allocator->template New<BitVector>(
+                graph->GetBBIdsBound(), allocator, memory::ArenaTag::BB_ORDERS);
+            stack_ = allocator->template NewVector<Frame>();
         } else {
-            visited_->clear();
+            visited_->Resize(graph->GetBBIdsBound());
         }
-        ExecuteDFS(graph->GetFirstBB(), callback);
+        auto visitedCount = ExecuteDFS(graph->GetFirstBB(), callback);
 
         // Verify the number of visited blocks
-        if (visited_->size() != graph->GetBBCount()) {
+        if (visitedCount != graph->GetBBCount()) {
             HandleError(
                 "Visited blocks count does not match graph's block count.");
         }
     }
 
-    static void Run(Graph *graph, DFOCallback callback) {
+    template <typename CallbackT>
+    static void Run(Graph *graph, CallbackT &&callback) {
         auto dfo = DFO();
         dfo.ValidateGraph(graph, callback);
     }
@@ -57,22 +61,40 @@ class DFO {
     }
 
   private:
-    memory::ArenaSet<size_t> *visited_ = nullptr; // Set of visited basic blocks
+    // A block on the DFS path and the index of its next successor to visit
+    struct Frame {
+        BB *bblock;
+        size_t nextSucc;
+    };
 
-    // Reset the visited set for a new traversal
-    void ResetVisited() { visited_->clear(); }
+    BitVector *visited_ = nullptr;
+    ArenaVector<Frame> *stack_ = nullptr;
 
-    // Recursive function to perform depth-first search on the basic blocks
+    // Visits the blocks in the same order as the recursive DFS would,
+    // returns the number of visited blocks
     template <typename BBlockT, typename CallbackT>
-    void ExecuteDFS(BBlockT *bblock, CallbackT callback) {
-        assert(bblock);
-        visited_->insert(bblock->GetId());
-        for (auto *succ : bblock->GetSuccessors()) {
-            if (!visited_->contains(succ->GetId())) {
-                ExecuteDFS(succ, callback);
+    size_t ExecuteDFS(BBlockT *start, CallbackT &callback) {
+        assert(start);
+        assert(stack_->empty());
+        size_t visitedCount = 1;
+        visited_->Set(start->GetId());
+        stack_->push_back({start, 0});
+        while (!stack_->empty()) {
+            auto &[bblock, nextSucc] = stack_->back();
+            auto &succs = bblock->GetSuccessors();
+            if (nextSucc == succs.size()) {
+                auto *finished = bblock;
+                stack_->pop_back();
+                callback(finished);
+                continue;
+            }
+            auto *succ = succs[nextSucc++];
+            if (!visited_->TestAndSet(succ->GetId())) {
+                ++visitedCount;
+                stack_->push_back({succ, 0});
             }
         }
-        callback(bblock);
+        return visitedCount;
     }
 
     // Validate the basic block pointer
@@ -85,9 +107,7 @@ class DFO {
     }
 
     // Check if a block has been visited
-    bool HasBeenVisited(BB *bblock) {
-        return visited_->find(bblock->GetId()) != visited_->end();
-    }
+    bool HasBeenVisited(BB *bblock) { return visited_->Test(bblock->GetId()); }
 
     // Handle errors by printing the message and aborting
     void HandleError(const std::string &message) {
@@ -105,40 +125,31 @@ template <> struct BasicBlockTypeHelper<Graph> { using type = BB; };
 template <typename GraphT>
 using BasickBlockType = typename BasicBlockTypeHelper<GraphT>::type;
 
+// The order is allocated in the graph's scratch arena, so it lives until the
+// caller's ArenaScope on that arena is closed
 template <typename GraphT>
 memory::ArenaVector<BasickBlockType<GraphT> *> RPO(GraphT *graph) {
     assert(graph);
     memory::ArenaVector<BasickBlockType<GraphT> *> result(
-        graph->GetAllocator()->ToSTL());
+        graph->GetScratchAllocator()->ToSTL(memory::ArenaTag::BB_ORDERS));
     if (graph->IsEmpty()) {
         return result;
     }
 
-    result.reserve(graph->GetBBCount());
-    DFO::Run(graph, [&result](BasickBlockType<GraphT> *bblock) {
-        result.push_back(bblock);
-    });
-    assert(result.size() == graph->GetBBCount());
-    std::reverse(result.begin(), result.end());
-    return result;
-}
-
-// Function to get the Reverse Post Order (RPO) of the graph
-template <typename GraphT> inline ArenaVector<BB *> RPO(Graph *graph) {
-    assert(graph);
-    memory::ArenaVector<BasickBlockType<GraphT> *> result(
-        graph->GetAllocator()->ToSTL());
-    if (graph->IsEmpty()) {
-        return result;
+    // the order is filled from its end, so no reversal is needed
+    auto count = graph->GetBBCount();
+    result.resize(count);
+    {
+        // traversal's stack and visited set are not needed after the order is
+        // computed
+        memory::ArenaScope scope(graph->GetScratchAllocator());
+        DFO::Run(graph, [&result, &count](BasickBlockType<GraphT> *bblock) {
+            assert(count > 0);
+            result[--count] = bblock;
+        });
     }
-
-    result.reserve(graph->GetBBCount());
-    DFO::Run(graph, [&result](BasickBlockType<GraphT> *bblock) {
-        result.push_back(bblock);
-    });
-    assert(result.size() == graph->GetBBCount());
-    std::reverse(result.begin(), result.end());
-    return result; // Return the computed RPO
+    assert(count == 0);
+    return result;
 }
 
 } // namespace ir
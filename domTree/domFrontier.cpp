@@ -0,0 +1,165 @@
+#include "domFrontier.h"
+#include "bitVector.h"
+#include "domTreeUpdater.h"
+#include <queue>
+
+namespace ir {
+
+DominanceFrontiers::DominanceFrontiers(Graph *graph,
+                                       memory::ArenaAllocator *allocator)
+    : graph_(graph),
+      offsets_(allocator->ToSTL(memory::ArenaTag::DOMINANCE_FRONTIERS)),
+      frontiers_(allocator->ToSTL(memory::ArenaTag::DOMINANCE_FRONTIERS)) {
+    assert(graph_ && allocator != graph_->GetScratchAllocator());
+    assert(graph_->GetAnalyses().IsValid(AnalysisKind::DOM_TREE));
+    Compute();
+}
+
+template <typename VisitorT>
+void DominanceFrontiers::ForEachFrontierEntry(VisitorT visit) {
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    // the last join added to the frontier of every block
+    auto *lastJoins = allocator->template AllocateArray<uint32_t>(
+        graph_->GetBBIdsBound(), memory::ArenaTag::DOMINANCE_FRONTIERS);
+    std::fill_n(lastJoins, graph_->GetBBIdsBound(), UINT32_MAX);
+
+    graph_->ForEachBB([this, &visit, lastJoins](BB *join) {
+        if (!DomTreeUpdater::IsInDomTree(join)) {
+            return;
+        }
+        auto *idom = join->GetDominator();
+        for (auto *pred : join->GetPredecessors()) {
+            if (!DomTreeUpdater::IsInDomTree(pred)) {
+                continue;
+            }
+            // the join is in the frontiers of the blocks dominating its
+            // predecessor up to its immediate dominator. A block which has
+            // the join already was reached from another predecessor, so its
+            // dominators have the join too.
+            for (auto *runner = pred; runner != idom;
+                 runner = runner->GetDominator()) {
+                if (lastJoins[runner->GetId()] == join->GetId()) {
+                    break;
+                }
+                lastJoins[runner->GetId()] = join->GetId();
+                visit(runner, join);
+            }
+        }
+    });
+}
+
+void DominanceFrontiers::Compute() {
+    auto idsBound = graph_->GetBBIdsBound();
+    assert(idsBound < UINT32_MAX);
+    offsets_.assign(idsBound + 1, 0);
+    ForEachFrontierEntry(
+        [this](BB *bblock, BB *) { ++offsets_[bblock->GetId() + 1]; });
+    for (size_t i = 1; i <= idsBound; ++i) {
+        offsets_[i] += offsets_[i - 1];
+    }
+
+    frontiers_.resize(offsets_.back());
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    auto *cursors = allocator->template AllocateArray<uint32_t>(
+        idsBound, memory::ArenaTag::DOMINANCE_FRONTIERS);
+    std::copy_n(offsets_.begin(), idsBound, cursors);
+    ForEachFrontierEntry([this, cursors](BB *bblock, BB *join) {
+        frontiers_[cursors[bblock->GetId()]++] = join;
+    });
+}
+
+void DominanceFrontiers::ComputeIteratedFrontier(
+    std::span<BB *const> defs, memory::ArenaVector<BB *> *result) const {
+    assert(result);
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    memory::ArenaTagScope tagScope(allocator,
+                                   memory::ArenaTag::DOMINANCE_FRONTIERS);
+    BitVector inFrontier(graph_->GetBBIdsBound(), allocator);
+    BitVector queued(graph_->GetBBIdsBound(), allocator);
+    auto *worklist = allocator->template NewVector<BB *>();
+    for (auto *def : defs) {
+        if (!queued.TestAndSet(def->GetId())) {
+            worklist->push_back(def);
+        }
+    }
+
+    while (!worklist->empty()) {
+        auto *bblock = worklist->back();
+        worklist->pop_back();
+        for (auto *join : GetFrontier(bblock)) {
+            if (inFrontier.TestAndSet(join->GetId())) {
+                continue;
+            }
+            result->push_back(join);
+            // a phi is a new definition of the variable
+            if (!queued.TestAndSet(join->GetId())) {
+                worklist->push_back(join);
+            }
+        }
+    }
+}
+
+void ComputeIteratedDomFrontier(Graph *graph, std::span<BB *const> defs,
+                                memory::ArenaVector<BB *> *result) {
+    assert(graph && result);
+    assert(graph->GetAnalyses().IsValid(AnalysisKind::DOM_TREE));
+    auto *allocator = graph->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    memory::ArenaTagScope tagScope(allocator,
+                                   memory::ArenaTag::DOMINANCE_FRONTIERS);
+
+    // Definitions and joins found so far are visited from the deepest ones.
+    // A join edge leaving the subtree of such a root to a block not deeper
+    // than the root adds the block to the frontier, subtrees visited from
+    // deeper roots need not be visited again.
+    auto deeper = [](BB *lhs, BB *rhs) {
+        if (lhs->GetDomTreeDepth() != rhs->GetDomTreeDepth()) {
+            return lhs->GetDomTreeDepth() < rhs->GetDomTreeDepth();
+        }
+        return lhs->GetId() > rhs->GetId();
+    };
+    std::priority_queue<BB *, ArenaVector<BB *>, decltype(deeper)> roots(
+        deeper, *allocator->template NewVector<BB *>());
+    BitVector inFrontier(graph->GetBBIdsBound(), allocator);
+    BitVector isDef(graph->GetBBIdsBound(), allocator);
+    BitVector visited(graph->GetBBIdsBound(), allocator);
+    auto *subtree = allocator->template NewVector<BB *>();
+    for (auto *def : defs) {
+        if (DomTreeUpdater::IsInDomTree(def) &&
+            !isDef.TestAndSet(def->GetId())) {
+            roots.push(def);
+        }
+    }
+
+    while (!roots.empty()) {
+        auto *root = roots.top();
+        roots.pop();
+        auto rootDepth = root->GetDomTreeDepth();
+        subtree->push_back(root);
+        visited.Set(root->GetId());
+        while (!subtree->empty()) {
+            auto *bblock = subtree->back();
+            subtree->pop_back();
+            for (auto *succ : bblock->GetSuccessors()) {
+                if (!DomTreeUpdater::IsInDomTree(succ) ||
+                    succ->GetDomTreeDepth() > rootDepth ||
+                    inFrontier.TestAndSet(succ->GetId())) {
+                    continue;
+                }
+                result->push_back(succ);
+                if (!isDef.Test(succ->GetId())) {
+                    roots.push(succ);
+                }
+            }
+            for (auto *dominated : bblock->GetDominatedBBs()) {
+                if (!visited.TestAndSet(dominated->GetId())) {
+                    subtree->push_back(dominated);
+                }
+            }
+        }
+    }
+}
+} // namespace ir
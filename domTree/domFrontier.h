@@ -0,0 +1,60 @@
+#ifndef JIT_AOT_COURSE_DOMTREE_DOM_FRONTIER_H_
+#define JIT_AOT_COURSE_DOMTREE_DOM_FRONTIER_H_
+
+#include "graph.h"
+#include <span>
+
+namespace ir {
+// Dominance frontiers of all the blocks of a graph with a valid dominator
+// tree, computed as in "A Simple, Fast Dominance Algorithm" by Cooper et al.
+// The frontiers are stored in CSR layout: one array of blocks and offsets of
+// the frontier of every block id into it. Blocks unreachable from the first
+// one have empty frontiers and never appear in them.
+//
+// The frontiers are a snapshot: CFG edits and blocks created later are not
+// reflected in them.
+class DominanceFrontiers {
+  public:
+    DominanceFrontiers(Graph *graph, memory::ArenaAllocator *allocator);
+    DominanceFrontiers(const DominanceFrontiers &) = delete;
+    DominanceFrontiers &operator=(const DominanceFrontiers &) = delete;
+    DominanceFrontiers(DominanceFrontiers &&) = delete;
+    DominanceFrontiers &operator=(DominanceFrontiers &&) = delete;
+    ~DominanceFrontiers() = default;
+
+    std::span<BB *const> GetFrontier(BB *bblock) const {
+        assert(bblock && bblock->GetId() + 1 < offsets_.size());
+        auto id = bblock->GetId();
+        return {frontiers_.data() + offsets_[id],
+                frontiers_.data() + offsets_[id + 1]};
+    }
+    // Sum of sizes of all the frontiers
+    size_t GetTotalSize() const { return frontiers_.size(); }
+
+    // Appends the iterated dominance frontier of the blocks, i.e. the blocks
+    // needing phis for a variable defined in them, to the result. The result
+    // must not live in the graph's scratch arena.
+    void ComputeIteratedFrontier(std::span<BB *const> defs,
+                                 memory::ArenaVector<BB *> *result) const;
+
+  private:
+    void Compute();
+    // Calls visit(bblock, join) for every block with the join block in its
+    // frontier, once per pair
+    template <typename VisitorT> void ForEachFrontierEntry(VisitorT visit);
+
+    Graph *graph_;
+    memory::ArenaVector<uint32_t> offsets_;
+    memory::ArenaVector<BB *> frontiers_;
+};
+
+// Same as DominanceFrontiers::ComputeIteratedFrontier, but walks the
+// dominator tree instead of the frontiers as in "A Linear Time Algorithm for
+// Placing phi-nodes" by Sreedhar and Gao. Needs no precomputation and is
+// linear in the size of the CFG, so it is preferable for a few queries or
+// when the frontiers are large.
+void ComputeIteratedDomFrontier(Graph *graph, std::span<BB *const> defs,
+                                memory::ArenaVector<BB *> *result);
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_DOMTREE_DOM_FRONTIER_H_
@@ -1,9 +1,10 @@
 #include "domTree.h"
-#include <numeric>
+#include <algorithm>
 
 namespace ir {
 
-void DomTreeBuilder::Construct(Graph *graph) {
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::Construct(Graph *graph) {
     assert(graph);
 
     // Terminate early for empty graphs
@@ -11,124 +12,210 @@ void DomTreeBuilder::Construct(Graph *graph) {
         return;
     }
 
-    // Prepare internal structures for processing
-    auto sdomsHelper = InitializeStructures(graph);
-    // Begin depth-first search from the first basic block
-    PerformDFS(graph->GetFirstBB());
+    // Drop the results of the previous construction
+    graph->ForEachBB([](BB *bblock) { DirectionT::Unlink(bblock); });
+    auto *root = DirectionT::GetRoot(graph);
+    if (root == nullptr) {
+        // no exit to post-dominate the blocks
+        graph->GetAnalyses().CountComputation(DirectionT::ANALYSIS);
+        graph->GetAnalyses().SetValid(DirectionT::ANALYSIS);
+        return;
+    }
+
+    memory::ArenaScope scope(graph->GetScratchAllocator());
+    memory::ArenaTagScope tagScope(graph->GetScratchAllocator(),
+                                   memory::ArenaTag::DOMINATOR_TABLES);
+    assert(graph->GetBBCount() < NONE);
+    ReserveTables(GetTablesAllocator(graph), graph->GetBBCount(),
+                  graph->GetBBIdsBound());
+
+    // Begin depth-first search from the root
+    PerformDFS(root, [](BB *, BB *) { return true; });
+
+    // blocks unreachable from the root are left out of the tree
+    assert(size_ <= graph->GetBBCount());
 
-    // Validate the graph's connectivity
-    assert(lastVisited_ == static_cast<int>(graph->GetBBCount()) - 1);
+    DeriveDominators();
 
+    NumberDomTree(graph);
+    graph->GetAnalyses().CountComputation(DirectionT::ANALYSIS);
+    graph->GetAnalyses().SetValid(DirectionT::ANALYSIS);
+}
+
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::DeriveDominators() {
     // Calculate semi-dominators for all blocks
+    DSU sdomsHelper(ancestors_, labels_, semiDoms_, stack_, size_);
+    sdomsHelper.Reset();
     DeriveSemiDominators(sdomsHelper);
 
     // Calculate immediate dominators
-    DeriveImmediateDominators();
+    if (algorithm_ == DomTreeAlgorithm::SEMI_NCA) {
+        DeriveImmediateDominatorsSemiNCA();
+    } else {
+        DeriveImmediateDominators();
+    }
+    LinkDominators();
+
+    for (DfsNumber i = 0; i < size_; ++i) {
+        numbers_[vertices_[i]->GetId()] = NONE;
+    }
 }
 
-DSU DomTreeBuilder::InitializeStructures(Graph *graph) {
-    lastVisited_ = -1;
-    // Resetting internal variables for the new graph
-    auto bblocksCount = graph->GetBBCount();
-    auto *allocator = graph->GetAllocator();
-    if (semiDoms_ == nullptr) {
-        semiDoms_ = allocator->template NewVector<size_t>(bblocksCount,
-                                                          ir::INVALID_BB_ID);
-        semiDomSet_ = allocator->template NewVector<ArenaVector<BB *>>(
-            bblocksCount, ArenaVector<BB *>(allocator->ToSTL()));
-        immDoms_ = allocator->template NewVector<BB *>(bblocksCount, nullptr);
-        nodeLabels_ =
-            allocator->template NewVector<BB *>(bblocksCount, nullptr);
-        orderedBlocks_ =
-            allocator->template NewVector<BB *>(bblocksCount, nullptr);
-        blockAncestors_ =
-            allocator->template NewVector<BB *>(bblocksCount, nullptr);
-    } else {
-        semiDoms_->clear();
-        semiDomSet_->clear();
-        immDoms_->clear();
-        nodeLabels_->clear();
-        orderedBlocks_->clear();
-        blockAncestors_->clear();
-
-        semiDoms_->resize(bblocksCount, ir::INVALID_BB_ID);
-        semiDomSet_->resize(bblocksCount,
-                            ArenaVector<BB *>(allocator->ToSTL()));
-        immDoms_->resize(bblocksCount, nullptr);
-        nodeLabels_->resize(bblocksCount, nullptr);
-        orderedBlocks_->resize(bblocksCount, nullptr);
-        blockAncestors_->resize(bblocksCount, nullptr);
+template <typename DirectionT>
+memory::ArenaAllocator *
+GenericDomTreeBuilder<DirectionT>::GetTablesAllocator(Graph *graph) {
+    if (storage_) {
+        return storage_;
     }
-    return DSU(nodeLabels_, semiDoms_, allocator);
+    // the tables of the previous construction were released by its scope
+    verticesCapacity_ = 0;
+    idsCapacity_ = 0;
+    return graph->GetScratchAllocator();
 }
 
-void DomTreeBuilder::PerformDFS(BB *block) {
-    ++lastVisited_;
-    assert((block) && (lastVisited_ < static_cast<int>(getSize())));
-
-    // Set the current block's label and semi-dominator
-    auto blockId = block->GetId();
-    nodeLabels_->at(blockId) = block;
-    setSemiDomNumber(block, lastVisited_);
-    setOrderedBlock(lastVisited_, block);
-
-    // Recursively analyze each successor block
-    for (auto *successor : block->GetSuccessors()) {
-        if (getLabel(successor) == nullptr) {
-            setBlockDFOParent(successor, block); // Record ancestor
-            PerformDFS(successor);               // Continue DFS on successor
-        }
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::ReserveTables(
+    memory::ArenaAllocator *allocator, size_t verticesCount, size_t idsBound) {
+    if (verticesCount <= verticesCapacity_ && idsBound <= idsCapacity_) {
+        return;
+    }
+    if (storage_) {
+        // the outgrown tables are the only contents of the storage
+        storage_->Reset();
     }
+    verticesCapacity_ = std::max(verticesCount, verticesCapacity_);
+    idsCapacity_ = std::max(idsBound, idsCapacity_);
+
+    // per vertex: the block and 9 numbers, per block id: its number
+    constexpr size_t NUMBERS_PER_VERTEX = 9;
+    auto numbersCount = NUMBERS_PER_VERTEX * verticesCapacity_ + idsCapacity_;
+    auto wordsCount =
+        verticesCapacity_ +
+        (numbersCount * sizeof(DfsNumber) + sizeof(BB *) - 1) / sizeof(BB *);
+    vertices_ = allocator->template AllocateArray<BB *>(
+        wordsCount, memory::ArenaTag::DOMINATOR_TABLES);
+    auto *numbers =
+        reinterpret_cast<DfsNumber *>(vertices_ + verticesCapacity_);
+    for (auto **table : {&parents_, &semiDoms_, &immDoms_, &labels_,
+                         &ancestors_, &bucketHeads_, &bucketNext_, &nextSuccs_,
+                         &stack_}) {
+        *table = numbers;
+        numbers += verticesCapacity_;
+    }
+    numbers_ = numbers;
+    std::fill_n(numbers_, idsCapacity_, NONE);
 }
 
-void DomTreeBuilder::DeriveSemiDominators(DSU &sdomsHelper) {
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::DeriveSemiDominators(DSU &sdomsHelper) {
     // Process blocks in reverse order of DFS
-
-    for (int i = getSize() - 1; i >= 0; --i) {
-        auto *currentBlock = getOrderedBlock(i);
-        assert(currentBlock);
-        for (const auto &pred : currentBlock->GetPredecessors()) {
-            auto nodeWithMinLabel = sdomsHelper.Find(pred);
-            auto id = std::min(getSemiDomNumber(currentBlock),
-                               getSemiDomNumber(nodeWithMinLabel));
-            setSemiDomNumber(currentBlock, id);
+    for (auto i = static_cast<DfsNumber>(size_ - 1); i > 0; --i) {
+        for (auto *pred : DirectionT::GetPredecessors(vertices_[i])) {
+            auto predNumber = numbers_[pred->GetId()];
+            // predecessors outside of a region
+            if (predNumber == NONE) {
+                continue;
+            }
+            auto nodeWithMinLabel = sdomsHelper.Find(predNumber);
+            semiDoms_[i] = std::min(semiDoms_[i], semiDoms_[nodeWithMinLabel]);
         }
-
-        if (i > 0) {
-            registerSemiDom(currentBlock);
-            sdomsHelper.Unite(currentBlock, getBlockDFOParent(currentBlock));
+        auto parent = parents_[i];
+        sdomsHelper.Unite(i, parent);
+        if (algorithm_ == DomTreeAlgorithm::SEMI_NCA) {
+            continue;
         }
 
-        for (auto dominatee : getSemiDoms(currentBlock)) {
+        addToBucket(semiDoms_[i], i);
+        // the parent's bucket is complete, as semi-dominators of vertices
+        // are their ancestors in the DFS tree
+        for (auto dominatee = bucketHeads_[parent]; dominatee != NONE;
+             dominatee = bucketNext_[dominatee]) {
             auto minSDom = sdomsHelper.Find(dominatee);
+            immDoms_[dominatee] =
+                semiDoms_[minSDom] < semiDoms_[dominatee] ? minSDom : parent;
+        }
+        bucketHeads_[parent] = NONE;
+    }
+}
 
-            auto dominateeId = dominatee->GetId();
-            if (getSemiDomNumber(minSDom) == getSemiDomNumber(dominatee)) {
-                setImmDominator(dominateeId,
-                                getOrderedBlock(getSemiDomNumber(dominatee)));
-            } else {
-                setImmDominator(dominateeId, minSDom);
-            }
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::DeriveImmediateDominators() {
+    // Refine immediate dominators in the DFS order
+    for (DfsNumber i = 1; i < size_; ++i) {
+        if (immDoms_[i] != semiDoms_[i]) {
+            immDoms_[i] = immDoms_[immDoms_[i]];
         }
     }
 }
 
-void DomTreeBuilder::DeriveImmediateDominators() {
-    // Refine immediate dominators iteratively
-
-    for (size_t i = 1; i < getSize(); ++i) {
-        auto *currentBlock = getOrderedBlock(i);
-        auto currentBlockId = currentBlock->GetId();
-        if (getImmDominator(currentBlockId) !=
-            getOrderedBlock(getSemiDomNumber(currentBlock))) {
-            setImmDominator(
-                currentBlockId,
-                getImmDominator(getImmDominator(currentBlockId)->GetId()));
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::DeriveImmediateDominatorsSemiNCA() {
+    // The dominator tree is built in the DFS order. The immediate dominator
+    // of a vertex is the nearest ancestor of its DFS parent in the tree built
+    // so far whose number does not exceed the vertex's semi-dominator
+    immDoms_[0] = NONE;
+    for (DfsNumber i = 1; i < size_; ++i) {
+        auto immDom = parents_[i];
+        while (immDom > semiDoms_[i]) {
+            immDom = immDoms_[immDom];
         }
+        immDoms_[i] = immDom;
+    }
+}
 
-        auto *immDom = getImmDominator(currentBlockId);
-        currentBlock->SetDominator(immDom);
-        immDom->AddDominatedBlock(currentBlock);
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::LinkDominators() {
+    for (DfsNumber i = 0; i < size_; ++i) {
+        DirectionT::GetDominatedBBs(vertices_[i]).clear();
+    }
+    // immediate dominators precede blocks in the DFS order, so their depths
+    // are already set
+    for (DfsNumber i = 1; i < size_; ++i) {
+        DirectionT::Link(vertices_[i], vertices_[immDoms_[i]]);
     }
 }
+
+template <typename DirectionT>
+void GenericDomTreeBuilder<DirectionT>::NumberDomTree(Graph *graph) {
+    memory::ArenaScope scope(graph->GetScratchAllocator());
+    // iterative, as the dominator tree of a long chain is as deep as the chain
+    auto *stack = graph->GetScratchAllocator()
+                      ->template NewVector<std::pair<BB *, size_t>>();
+    auto *root = DirectionT::GetRoot(graph);
+    stack->emplace_back(root, 0);
+    size_t counter = 0;
+    DirectionT::SetInterval(root, ++counter, 0);
+    while (!stack->empty()) {
+        auto &[bblock, nextChild] = stack->back();
+        auto &dominated = DirectionT::GetDominatedBBs(bblock);
+        if (nextChild == dominated.size()) {
+            DirectionT::SetInterval(bblock, DirectionT::GetEnter(bblock),
+                                    ++counter);
+            stack->pop_back();
+            continue;
+        }
+        auto *child = dominated[nextChild++];
+        DirectionT::SetInterval(child, ++counter, 0);
+        stack->emplace_back(child, 0);
+    }
+    // the post-dominator tree is never updated incrementally
+    if constexpr (DirectionT::ANALYSIS == AnalysisKind::DOM_TREE) {
+        graph->GetAnalyses().SetDomTreeNumbered(true);
+    }
+}
+
+template <typename DirectionT>
+GenericDomTreeBuilder<DirectionT> *GetThreadLocalDomTreeBuilder() {
+    thread_local memory::ArenaAllocator storage;
+    thread_local GenericDomTreeBuilder<DirectionT> builder(&storage);
+    return &builder;
+}
+
+template class GenericDomTreeBuilder<ForwardCFG>;
+template class GenericDomTreeBuilder<ReverseCFG>;
+template GenericDomTreeBuilder<ForwardCFG> *
+GetThreadLocalDomTreeBuilder<ForwardCFG>();
+template GenericDomTreeBuilder<ReverseCFG> *
+GetThreadLocalDomTreeBuilder<ReverseCFG>();
 } // namespace ir
@@ -5,7 +5,7 @@
 #include "dsu.h"
 #include "graph.h"
 #include <cassert>
-#include <vector>
+#include <cstdint>
 
 /*
 Algorithm description based on the reference in the README:
@@ -41,85 +41,254 @@ the computation vertex by vertex in increasing order based on their labels.
 */
 
 namespace ir {
-class DomTreeBuilder {
+// Directions of the CFG a dominator tree is built over: the CFG itself from
+// its first block for the dominator tree, and the reversed CFG from its last
+// block for the post-dominator tree. They also tell which links of blocks
+// keep the tree.
+struct ForwardCFG {
+    static constexpr AnalysisKind ANALYSIS = AnalysisKind::DOM_TREE;
+
+    static BB *GetRoot(Graph *graph) { return graph->GetFirstBB(); }
+    static ArenaVector<BB *> &GetSuccessors(BB *bblock) {
+        return bblock->GetSuccessors();
+    }
+    static ArenaVector<BB *> &GetPredecessors(BB *bblock) {
+        return bblock->GetPredecessors();
+    }
+
+    static ArenaVector<BB *> &GetDominatedBBs(BB *bblock) {
+        return bblock->GetDominatedBBs();
+    }
+    static void Link(BB *bblock, BB *dominator) {
+        bblock->SetDominator(dominator);
+        bblock->SetDomTreeDepth(dominator->GetDomTreeDepth() + 1);
+        dominator->AddDominatedBlock(bblock);
+    }
+    static void Unlink(BB *bblock) {
+        bblock->SetDominator(nullptr);
+        bblock->GetDominatedBBs().clear();
+        bblock->SetDomTreeInterval(0, 0);
+        bblock->SetDomTreeDepth(0);
+    }
+    static size_t GetEnter(BB *bblock) { return bblock->GetDomTreeEnter(); }
+    static void SetInterval(BB *bblock, size_t enter, size_t exit) {
+        bblock->SetDomTreeInterval(enter, exit);
+    }
+};
+
+struct ReverseCFG {
+    static constexpr AnalysisKind ANALYSIS = AnalysisKind::POST_DOM_TREE;
+
+    static BB *GetRoot(Graph *graph) { return graph->GetLastBB(); }
+    static ArenaVector<BB *> &GetSuccessors(BB *bblock) {
+        return bblock->GetPredecessors();
+    }
+    static ArenaVector<BB *> &GetPredecessors(BB *bblock) {
+        return bblock->GetSuccessors();
+    }
+
+    static ArenaVector<BB *> &GetDominatedBBs(BB *bblock) {
+        return bblock->GetPostDominatedBBs();
+    }
+    static void Link(BB *bblock, BB *dominator) {
+        bblock->SetPostDominator(dominator);
+        bblock->SetPostDomTreeDepth(dominator->GetPostDomTreeDepth() + 1);
+        dominator->AddPostDominatedBlock(bblock);
+    }
+    static void Unlink(BB *bblock) {
+        bblock->SetPostDominator(nullptr);
+        bblock->GetPostDominatedBBs().clear();
+        bblock->SetPostDomTreeInterval(0, 0);
+        bblock->SetPostDomTreeDepth(0);
+    }
+    static size_t GetEnter(BB *bblock) {
+        return bblock->GetPostDomTreeEnter();
+    }
+    static void SetInterval(BB *bblock, size_t enter, size_t exit) {
+        bblock->SetPostDomTreeInterval(enter, exit);
+    }
+};
+
+// Dominator tree construction by one of DomTreeAlgorithm. Neither the DFS nor
+// the path compression recurse, so the depth of a CFG is limited only by
+// memory. All the tables are arrays indexed by DFS numbers carved from a
+// single buffer, the buckets of vertices with the same semi-dominator are
+// linked lists threaded through one of them.
+//
+// The direction selects the tree: DomTreeBuilder builds the dominator tree,
+// PostDomTreeBuilder builds the post-dominator tree from the last block.
+template <typename DirectionT> class GenericDomTreeBuilder {
   public:
+    // The tables live in the graph's scratch arena and are released on return
+    explicit GenericDomTreeBuilder(
+        DomTreeAlgorithm algorithm = DEFAULT_DOM_TREE_ALGORITHM)
+        : algorithm_(algorithm) {}
+    // The tables live in the given arena between constructions and are
+    // reused for graphs not larger than the previous ones. The builder resets
+    // the arena when it needs larger tables, so nothing else may use it.
+    explicit GenericDomTreeBuilder(
+        memory::ArenaAllocator *storage,
+        DomTreeAlgorithm algorithm = DEFAULT_DOM_TREE_ALGORITHM)
+        : algorithm_(algorithm), storage_(storage) {}
+    GenericDomTreeBuilder(const GenericDomTreeBuilder &) = delete;
+    GenericDomTreeBuilder &operator=(const GenericDomTreeBuilder &) = delete;
+    GenericDomTreeBuilder(GenericDomTreeBuilder &&) = delete;
+    GenericDomTreeBuilder &operator=(GenericDomTreeBuilder &&) = delete;
+    ~GenericDomTreeBuilder() = default;
+
+    DomTreeAlgorithm GetAlgorithm() const { return algorithm_; }
+    void SetAlgorithm(DomTreeAlgorithm algorithm) { algorithm_ = algorithm; }
+
+    // Links every block with its immediate dominator. Blocks unreachable from
+    // the root have none and are not in the tree. The post-dominator tree
+    // of a graph without the last block is empty.
     void Construct(Graph *graph);
 
-    // Retrieves the immediate dominators for the blocks
-    const ArenaVector<BB *> *GetImmediateDominators() const { return immDoms_; }
+    // Recomputes the dominator subtree of the root over the blocks reachable
+    // from it through the edges accepted by descend(from, to). The root keeps
+    // its dominator and depth, the dominated blocks of every block of the
+    // region are relinked. Predecessors outside the region are ignored, so it
+    // must be entered only through the root. Used by DomTreeUpdater, the
+    // validity of the tree is left to the caller. Returns the region size.
+    template <typename DescendT>
+    size_t ConstructRegion(Graph *graph, BB *root, DescendT descend);
+    // Blocks of the last constructed region in DFS preorder, the root first
+    BB *GetRegionBlock(size_t idx) const {
+        assert(idx < size_);
+        return vertices_[idx];
+    }
+
+    // Assigns DFS intervals of the tree to blocks, so dominance can be
+    // checked in constant time
+    static void NumberDomTree(Graph *graph);
 
   private:
-    // Initializes internal structures based on the number of basic blocks
-    DSU InitializeStructures(Graph *graph);
+    using DfsNumber = uint32_t;
+    static constexpr DfsNumber NONE = UINT32_MAX;
+
+    // Allocates the tables in the arena unless they already fit. Numbers of
+    // all the block ids are NONE in fresh tables, and the constructions
+    // restore them on return.
+    void ReserveTables(memory::ArenaAllocator *allocator, size_t verticesCount,
+                       size_t idsBound);
+    memory::ArenaAllocator *GetTablesAllocator(Graph *graph);
 
-    // Analyzes the specified basic block using DFS
-    void PerformDFS(BB *block);
+    // Numbers the blocks reachable from the start through the edges accepted
+    // by descend(from, to) in DFS preorder
+    template <typename DescendT> void PerformDFS(BB *start, DescendT descend);
+    // Derives immediate dominators of the vertices numbered by the DFS and
+    // links them
+    void DeriveDominators();
 
-    // Calculates semi-dominators for all blocks
+    // Calculates semi-dominators for all blocks. Lengauer-Tarjan also derives
+    // immediate dominators of those whose immediate dominator is their
+    // semi-dominator
     void DeriveSemiDominators(DSU &sdomsHelper);
 
     // Calculates immediate dominators for all blocks
     void DeriveImmediateDominators();
+    void DeriveImmediateDominatorsSemiNCA();
 
-    size_t getSize() const { return immDoms_->size(); }
-
-    BB *getImmDominator(size_t id) { return immDoms_->at(id); }
-    void setImmDominator(size_t id, BB *bblock) { immDoms_->at(id) = bblock; }
+    // Links every vertex with its immediate dominator and sets its depth
+    void LinkDominators();
 
-    size_t getSemiDomNumber(BB *bblock) {
-        assert(bblock);
-        return semiDoms_->at(bblock->GetId());
-    }
-    void setSemiDomNumber(BB *bblock, size_t visitNumber) {
-        assert(bblock);
-        semiDoms_->at(bblock->GetId()) = visitNumber;
+    void addToBucket(DfsNumber bucket, DfsNumber vertex) {
+        bucketNext_[vertex] = bucketHeads_[bucket];
+        bucketHeads_[bucket] = vertex;
     }
 
-    const ArenaVector<BB *> &getSemiDoms(BB *bblock) {
-        assert(bblock);
-        return semiDomSet_->at(bblock->GetId());
-    }
-    void registerSemiDom(BB *bblock) {
-        auto semiDomNumber = getSemiDomNumber(bblock);
-        semiDomSet_->at(getOrderedBlock(semiDomNumber)->GetId())
-            .push_back(bblock);
-    }
+    DomTreeAlgorithm algorithm_;
+    memory::ArenaAllocator *storage_ = nullptr;
+    size_t verticesCapacity_ = 0;
+    size_t idsCapacity_ = 0;
+    size_t size_ = 0; // Number of vertices of the current graph or region
 
-    BB *getLabel(BB *bblock) {
-        assert(bblock);
-        return nodeLabels_->at(bblock->GetId());
-    }
+    // Blocks ordered by their DFS visitation
+    BB **vertices_ = nullptr;
+    // DFS numbers of blocks by their ids
+    DfsNumber *numbers_ = nullptr;
+    DfsNumber *parents_ = nullptr;  // Parents in the DFS tree
+    DfsNumber *semiDoms_ = nullptr; // Semi-dominators
+    DfsNumber *immDoms_ = nullptr;  // Immediate dominators
+    DfsNumber *labels_ = nullptr;   // Labels of the DSU
+    DfsNumber *ancestors_ = nullptr;
+    DfsNumber *bucketHeads_ = nullptr;
+    DfsNumber *bucketNext_ = nullptr;
+    // Successor to visit next by the DFS
+    DfsNumber *nextSuccs_ = nullptr;
+    // Stack of the DFS, then of the DSU path compression
+    DfsNumber *stack_ = nullptr;
+};
 
-    BB *getOrderedBlock(size_t visitNumber) {
-        return orderedBlocks_->at(visitNumber);
-    }
-    void setOrderedBlock(size_t visitNumber, BB *bblock) {
-        assert(bblock);
-        orderedBlocks_->at(visitNumber) = bblock;
-    }
+template <typename DirectionT>
+template <typename DescendT>
+void GenericDomTreeBuilder<DirectionT>::PerformDFS(BB *start,
+                                                   DescendT descend) {
+    assert(start);
+    DfsNumber lastVisited = 0;
+    size_t depth = 0;
+    numbers_[start->GetId()] = lastVisited;
+    vertices_[lastVisited] = start;
+    parents_[lastVisited] = NONE;
+    nextSuccs_[lastVisited] = 0;
+    stack_[depth++] = lastVisited;
 
-    BB *getBlockDFOParent(BB *bblock) {
-        assert(bblock);
-        return blockAncestors_->at(bblock->GetId());
+    while (depth > 0) {
+        auto current = stack_[depth - 1];
+        auto *bblock = vertices_[current];
+        auto &succs = DirectionT::GetSuccessors(bblock);
+        if (nextSuccs_[current] == succs.size()) {
+            --depth;
+            continue;
+        }
+        auto *successor = succs[nextSuccs_[current]++];
+        if (numbers_[successor->GetId()] != NONE ||
+            !descend(bblock, successor)) {
+            continue;
+        }
+        ++lastVisited;
+        assert(lastVisited < verticesCapacity_);
+        numbers_[successor->GetId()] = lastVisited;
+        vertices_[lastVisited] = successor;
+        parents_[lastVisited] = current;
+        nextSuccs_[lastVisited] = 0;
+        stack_[depth++] = lastVisited;
     }
-    void setBlockDFOParent(BB *child, BB *parent) {
-        assert(child);
-        assert(parent);
-        blockAncestors_->at(child->GetId()) = parent;
+
+    size_ = lastVisited + 1;
+    for (DfsNumber i = 0; i < size_; ++i) {
+        semiDoms_[i] = i;
+        immDoms_[i] = NONE;
+        bucketHeads_[i] = NONE;
     }
+}
 
-    // Member variables
-    int lastVisited_ = 0; // Last visited vertex count during DFS
-    ArenaVector<BB *> *immDoms_ = nullptr;    // List of imm doms
-    ArenaVector<size_t> *semiDoms_ = nullptr; // Semi-doms for each block
-    ArenaVector<ArenaVector<BB *>> *semiDomSet_ =
-        nullptr;                              // Sets of semi-dominators
-    ArenaVector<BB *> *nodeLabels_ = nullptr; // Labels assigned during DFS
-    ArenaVector<BB *> *orderedBlocks_ =
-        nullptr; // Blocks ordered by their DFS visitation
-    ArenaVector<BB *> *blockAncestors_ =
-        nullptr; // Ancestors of each block in the DFS tree
-};
+template <typename DirectionT>
+template <typename DescendT>
+size_t GenericDomTreeBuilder<DirectionT>::ConstructRegion(Graph *graph,
+                                                          BB *root,
+                                                          DescendT descend) {
+    assert(graph && root && root->GetGraph() == graph);
+    memory::ArenaScope scope(graph->GetScratchAllocator());
+    memory::ArenaTagScope tagScope(graph->GetScratchAllocator(),
+                                   memory::ArenaTag::DOMINATOR_TABLES);
+    assert(graph->GetBBCount() < NONE);
+    ReserveTables(GetTablesAllocator(graph), graph->GetBBCount(),
+                  graph->GetBBIdsBound());
+    PerformDFS(root, descend);
+    DeriveDominators();
+    return size_;
+}
+
+extern template class GenericDomTreeBuilder<ForwardCFG>;
+extern template class GenericDomTreeBuilder<ReverseCFG>;
+using DomTreeBuilder = GenericDomTreeBuilder<ForwardCFG>;
+using PostDomTreeBuilder = GenericDomTreeBuilder<ReverseCFG>;
+
+// Builder keeping its tables in a thread-local arena, so that they are
+// reused by all the graphs compiled by the thread
+template <typename DirectionT = ForwardCFG>
+GenericDomTreeBuilder<DirectionT> *GetThreadLocalDomTreeBuilder();
 } // namespace ir
 
 #endif // JIT_AOT_COURSE_DOMTREE_DOMTREE
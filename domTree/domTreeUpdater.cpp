@@ -0,0 +1,271 @@
+#include "domTreeUpdater.h"
+#include "bitVector.h"
+#include "domTree.h"
+#include <queue>
+
+namespace ir {
+
+BB *DomTreeUpdater::FindNearestCommonDominator(BB *lhs, BB *rhs) {
+    assert(IsInDomTree(lhs) && IsInDomTree(rhs));
+    while (lhs->GetDomTreeDepth() > rhs->GetDomTreeDepth()) {
+        lhs = lhs->GetDominator();
+    }
+    while (rhs->GetDomTreeDepth() > lhs->GetDomTreeDepth()) {
+        rhs = rhs->GetDominator();
+    }
+    while (lhs != rhs) {
+        lhs = lhs->GetDominator();
+        rhs = rhs->GetDominator();
+    }
+    assert(lhs);
+    return lhs;
+}
+
+void DomTreeUpdater::InsertEdge(BB *from, BB *to) {
+    assert(from && to);
+    if (IsInDomTree(from)) {
+        if (IsInDomTree(to)) {
+            InsertReachable(from, to);
+        } else {
+            InsertUnreachable(from, to);
+        }
+    }
+    Finish();
+}
+
+void DomTreeUpdater::InsertReachable(BB *from, BB *to) {
+    auto *ncd = FindNearestCommonDominator(from, to);
+    // the edge is a back edge or does not bypass the current dominator
+    if (ncd == to || ncd == to->GetDominator()) {
+        return;
+    }
+    auto ncdDepth = ncd->GetDomTreeDepth();
+
+    // Blocks deeper than the nearest common dominator lose their immediate
+    // dominators if they are reachable from the target through blocks not
+    // shallower than themselves. They are visited from the deepest ones.
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    memory::ArenaTagScope tagScope(allocator,
+                                   memory::ArenaTag::DOMINATOR_TABLES);
+    using DepthBB = std::pair<size_t, BB *>;
+    auto byDepth = [](const DepthBB &lhs, const DepthBB &rhs) {
+        return lhs.first < rhs.first;
+    };
+    std::priority_queue<DepthBB, ArenaVector<DepthBB>, decltype(byDepth)>
+        bucket(byDepth, *allocator->template NewVector<DepthBB>());
+    auto *affected = allocator->template NewVector<BB *>();
+    auto *unaffected = allocator->template NewVector<BB *>();
+    BitVector visited(graph_->GetBBIdsBound(), allocator);
+
+    bucket.emplace(to->GetDomTreeDepth(), to);
+    visited.Set(to->GetId());
+    while (!bucket.empty()) {
+        auto [currentDepth, bblock] = bucket.top();
+        bucket.pop();
+        affected->push_back(bblock);
+        while (true) {
+            for (auto *succ : bblock->GetSuccessors()) {
+                if (!IsInDomTree(succ)) {
+                    continue;
+                }
+                auto succDepth = succ->GetDomTreeDepth();
+                if (succDepth <= ncdDepth + 1 ||
+                    visited.TestAndSet(succ->GetId())) {
+                    continue;
+                }
+                if (succDepth > currentDepth) {
+                    unaffected->push_back(succ);
+                } else {
+                    bucket.emplace(succDepth, succ);
+                }
+            }
+            if (unaffected->empty()) {
+                break;
+            }
+            bblock = unaffected->back();
+            unaffected->pop_back();
+        }
+    }
+
+    for (auto *bblock : *affected) {
+        Reparent(bblock, ncd);
+    }
+    for (auto *bblock : *affected) {
+        UpdateSubtreeDepths(bblock);
+    }
+}
+
+void DomTreeUpdater::InsertUnreachable(BB *from, BB *to) {
+    to->ResetDomTreeLinks();
+    to->SetDominator(from);
+    to->SetDomTreeDepth(from->GetDomTreeDepth() + 1);
+    from->AddDominatedBlock(to);
+
+    // the blocks reachable only through the target form its subtree
+    auto *builder = GetThreadLocalDomTreeBuilder();
+    auto regionSize = builder->ConstructRegion(
+        graph_, to, [](BB *, BB *succ) { return !IsInDomTree(succ); });
+
+    // edges from the region to the rest of the tree are new for it
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    memory::ArenaTagScope tagScope(allocator,
+                                   memory::ArenaTag::DOMINATOR_TABLES);
+    BitVector inRegion(graph_->GetBBIdsBound(), allocator);
+    auto *region = allocator->template NewVector<BB *>(regionSize, nullptr);
+    for (size_t i = 0; i < regionSize; ++i) {
+        (*region)[i] = builder->GetRegionBlock(i);
+        inRegion.Set((*region)[i]->GetId());
+    }
+    for (auto *bblock : *region) {
+        for (auto *succ : bblock->GetSuccessors()) {
+            if (!inRegion.Test(succ->GetId())) {
+                InsertReachable(bblock, succ);
+            }
+        }
+    }
+}
+
+void DomTreeUpdater::DeleteEdge(BB *from, BB *to) {
+    assert(from && to);
+    if (!IsInDomTree(from) || !IsInDomTree(to)) {
+        Finish();
+        return;
+    }
+    auto *ncd = FindNearestCommonDominator(from, to);
+    // the target dominates the source, e.g. the edge is a back edge
+    if (ncd == to) {
+        Finish();
+        return;
+    }
+    if (to->GetDominator() == from && !HasProperSupport(to)) {
+        // the target is unreachable, the tree stays invalid
+        return;
+    }
+
+    // Only the blocks dominated by the nearest common dominator may get new
+    // immediate dominators, all of them are deeper than it
+    auto ncdDepth = ncd->GetDomTreeDepth();
+    GetThreadLocalDomTreeBuilder()->ConstructRegion(
+        graph_, ncd, [ncdDepth](BB *, BB *succ) {
+            return IsInDomTree(succ) && succ->GetDomTreeDepth() > ncdDepth;
+        });
+    Finish();
+}
+
+bool DomTreeUpdater::HasProperSupport(BB *bblock) {
+    for (auto *pred : bblock->GetPredecessors()) {
+        if (IsInDomTree(pred) &&
+            FindNearestCommonDominator(bblock, pred) != bblock) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DomTreeUpdater::SplitBlock(BB *bblock, BB *newBBlock) {
+    assert(bblock && newBBlock);
+    assert(bblock->GetSuccessors().size() == 1 &&
+           bblock->GetSuccessors()[0] == newBBlock);
+    newBBlock->ResetDomTreeLinks();
+    // the new block dominates everything the split one did
+    auto &dominated = bblock->GetDominatedBBs();
+    for (auto *child : dominated) {
+        child->SetDominator(newBBlock);
+        newBBlock->AddDominatedBlock(child);
+    }
+    dominated.clear();
+    newBBlock->SetDominator(bblock);
+    bblock->AddDominatedBlock(newBBlock);
+    UpdateSubtreeDepths(bblock);
+    Finish();
+}
+
+void DomTreeUpdater::SpliceSubgraph(BB *splitBlock, BB *entry,
+                                    BB *continuation) {
+    assert(splitBlock && entry && continuation);
+    assert(IsInDomTree(splitBlock));
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    memory::ArenaTagScope tagScope(allocator,
+                                   memory::ArenaTag::DOMINATOR_TABLES);
+    auto &dominated = splitBlock->GetDominatedBBs();
+    auto *oldChildren =
+        allocator->template NewVector<BB *>(dominated.begin(), dominated.end());
+    dominated.clear();
+
+    entry->ResetDomTreeLinks();
+    entry->SetDominator(splitBlock);
+    entry->SetDomTreeDepth(splitBlock->GetDomTreeDepth() + 1);
+    splitBlock->AddDominatedBlock(entry);
+    // the continuation is the only exit of the subgraph, so its dominator
+    // is found within the subgraph
+    continuation->ResetDomTreeLinks();
+    GetThreadLocalDomTreeBuilder()->ConstructRegion(
+        graph_, entry,
+        [continuation](BB *from, BB *) { return from != continuation; });
+    assert(continuation->GetDominator() != nullptr);
+
+    // the continuation dominates everything the split block did
+    for (auto *child : *oldChildren) {
+        child->SetDominator(continuation);
+        continuation->AddDominatedBlock(child);
+    }
+    UpdateSubtreeDepths(continuation);
+    Finish();
+}
+
+void DomTreeUpdater::InsertDominatingBlock(BB *bblock, BB *newBBlock) {
+    assert(bblock && newBBlock);
+    newBBlock->ResetDomTreeLinks();
+    // the predecessors left to the block are dominated by it, so the nearest
+    // common dominator of the moved ones is the block's immediate dominator
+    auto *dominator = bblock->GetDominator();
+    if (dominator != nullptr) {
+        Reparent(bblock, newBBlock);
+        newBBlock->SetDominator(dominator);
+        dominator->AddDominatedBlock(newBBlock);
+        newBBlock->SetDomTreeDepth(dominator->GetDomTreeDepth() + 1);
+    } else {
+        // the block was the root of the tree
+        assert(graph_->GetFirstBB() == newBBlock);
+        bblock->SetDominator(newBBlock);
+        newBBlock->AddDominatedBlock(bblock);
+    }
+    UpdateSubtreeDepths(newBBlock);
+    Finish();
+}
+
+void DomTreeUpdater::UpdateSubtreeDepths(BB *root) {
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    memory::ArenaTagScope tagScope(allocator,
+                                   memory::ArenaTag::DOMINATOR_TABLES);
+    auto *stack = allocator->template NewVector<BB *>();
+    stack->push_back(root);
+    while (!stack->empty()) {
+        auto *bblock = stack->back();
+        stack->pop_back();
+        for (auto *child : bblock->GetDominatedBBs()) {
+            child->SetDomTreeDepth(bblock->GetDomTreeDepth() + 1);
+            stack->push_back(child);
+        }
+    }
+}
+
+void DomTreeUpdater::Reparent(BB *bblock, BB *newDominator) {
+    auto *oldDominator = bblock->GetDominator();
+    assert(oldDominator);
+    oldDominator->RemoveDominatedBlock(bblock);
+    bblock->SetDominator(newDominator);
+    bblock->SetDomTreeDepth(newDominator->GetDomTreeDepth() + 1);
+    newDominator->AddDominatedBlock(bblock);
+}
+
+void DomTreeUpdater::Finish() {
+    auto &analyses = graph_->GetAnalyses();
+    analyses.SetValid(AnalysisKind::DOM_TREE);
+    analyses.SetDomTreeNumbered(false);
+}
+} // namespace ir
@@ -0,0 +1,66 @@
+#ifndef JIT_AOT_COURSE_DOMTREE_DOM_TREE_UPDATER_H_
+#define JIT_AOT_COURSE_DOMTREE_DOM_TREE_UPDATER_H_
+
+#include "graph.h"
+
+namespace ir {
+// Brings a dominator tree, which was valid before a CFG edit, in line with
+// the edited CFG instead of rebuilding it. Blocks unreachable from the first
+// one are not in the tree and have no dominator. Updates leave the DFS
+// intervals of blocks stale, AnalysisManager::RequireDomTree renumbers them.
+//
+// Edge insertion follows the depth-based algorithm of Alstrup and Lauridsen
+// (as described in "An Experimental Study of Dynamic Dominators" by
+// Georgiadis et al.), edge deletion rebuilds the dominator subtree of the
+// nearest common dominator of the edge's ends.
+class DomTreeUpdater {
+  public:
+    explicit DomTreeUpdater(Graph *graph) : graph_(graph) { assert(graph_); }
+    DomTreeUpdater(const DomTreeUpdater &) = delete;
+    DomTreeUpdater &operator=(const DomTreeUpdater &) = delete;
+    DomTreeUpdater(DomTreeUpdater &&) = delete;
+    DomTreeUpdater &operator=(DomTreeUpdater &&) = delete;
+    ~DomTreeUpdater() = default;
+
+    // The edge was added to the CFG. A target unreachable before gets the
+    // blocks reachable only through it into the tree
+    void InsertEdge(BB *from, BB *to);
+    // The edge was removed from the CFG. The tree is dropped if the target
+    // becomes unreachable, the blocks must be removed before it is rebuilt
+    void DeleteEdge(BB *from, BB *to);
+    // The block was split, the new block took its successors and is its only
+    // successor
+    void SplitBlock(BB *bblock, BB *newBBlock);
+    // The block was split without connecting its halves, then the subgraph
+    // with the given entry was placed between them: the entry is the only
+    // successor of the split block, the subgraph is left only to the
+    // continuation block, which took the successors of the split block
+    void SpliceSubgraph(BB *splitBlock, BB *entry, BB *continuation);
+    // The new block was placed in front of the block: it took all the
+    // predecessors of the block not dominated by it, e.g. a loop preheader,
+    // and is their only successor. The first block may be moved this way too.
+    void InsertDominatingBlock(BB *bblock, BB *newBBlock);
+
+    static bool IsInDomTree(BB *bblock) {
+        assert(bblock);
+        return bblock->GetDominator() != nullptr ||
+               (bblock->GetGraph() != nullptr &&
+                bblock->GetGraph()->GetFirstBB() == bblock);
+    }
+    static BB *FindNearestCommonDominator(BB *lhs, BB *rhs);
+
+  private:
+    void InsertReachable(BB *from, BB *to);
+    void InsertUnreachable(BB *from, BB *to);
+    bool HasProperSupport(BB *bblock);
+    // Sets depths of the blocks dominated by the root from the root's one
+    void UpdateSubtreeDepths(BB *root);
+    void Reparent(BB *bblock, BB *newDominator);
+    // The tree matches the CFG again, but its numbering is stale
+    void Finish();
+
+    Graph *graph_;
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_DOMTREE_DOM_TREE_UPDATER_H_
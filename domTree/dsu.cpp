@@ -3,53 +3,50 @@
 
 namespace ir {
 
+void DSU::Reset() {
+    for (uint32_t i = 0; i < size_; ++i) {
+        ancestors_[i] = ROOT;
+        labels_[i] = i;
+    }
+}
+
 // Find operation in the DSU
-BB *DSU::Find(BB *bblock) {
-    // Validate the block and check for a valid ID
-    if (bblock == nullptr || bblock->GetId() >= GetSize()) {
+uint32_t DSU::Find(uint32_t vertex) {
+    if (vertex >= GetSize()) {
         std::cout << "[DSU Error] in Find" << std::endl;
         std::abort();
     }
 
-    if (getParentLinks(bblock->GetId()) == nullptr) { // root
-        return bblock;
+    if (ancestors_[vertex] == ROOT) {
+        return vertex;
     }
 
     // Update the ancestor path to find the representative
-    UpdateAncestorPath(bblock);
-    return labels_->at(bblock->GetId());
+    UpdateAncestorPath(vertex);
+    return labels_[vertex];
 }
 
-// Update the ancestor path to optimize future queries
-void DSU::UpdateAncestorPath(BB *bblock) {
-    // Get the ancestor of the current block
-    auto ancestor = getParentLinks(bblock->GetId());
-
-    if (ancestor == nullptr) {
-        std::cout << "[DSU Error] UpdateAncestorPath Universum" << std::endl;
-        std::abort();
-    }
-
-    // If the ancestor is a root, stop the recursion
-    if (getParentLinks(ancestor->GetId()) == nullptr) {
-        return;
+// Compresses the path from the vertex to the root of its tree, so that every
+// vertex on it links directly to the child of the root
+void DSU::UpdateAncestorPath(uint32_t vertex) {
+    // collect the vertices whose ancestor is not the root, the one closest to
+    // the root ends up on the top of the stack
+    size_t depth = 0;
+    for (auto current = vertex; ancestors_[ancestors_[current]] != ROOT;
+         current = ancestors_[current]) {
+        assert(depth < size_);
+        pathStack_[depth++] = current;
     }
 
-    // Recursively update the ancestor path
-    UpdateAncestorPath(ancestor);
-
-    // Determine the minimum semi-dominator for the current block
-    auto minForBBlock = labels_->at(bblock->GetId());
-    auto minForAnc = labels_->at(ancestor->GetId());
-
-    // Compare the semi-dominators to update the label if necessary
-    if (sdoms_->at(minForAnc->GetId()) < sdoms_->at(minForBBlock->GetId())) {
-        labels_->at(bblock->GetId()) =
-            minForAnc; // Update label to the ancestor
+    while (depth > 0) {
+        auto current = pathStack_[--depth];
+        auto ancestor = ancestors_[current];
+        // the ancestor's label is already the minimum on its path
+        if (sdoms_[labels_[ancestor]] < sdoms_[labels_[current]]) {
+            labels_[current] = labels_[ancestor];
+        }
+        ancestors_[current] = ancestors_[ancestor];
     }
-
-    // Path compression - connect the block to its ancestor's parent
-    setParentLinks(bblock->GetId(), getParentLinks(ancestor->GetId()));
 }
 
 } // namespace ir
@@ -1,45 +1,51 @@
 #ifndef JIT_AOT_COMPILERS_DOMTREE_DSU_H_
 #define JIT_AOT_COMPILERS_DOMTREE_DSU_H_
 
-#include "arena.h"
-#include "bb.h"
-#include <numeric>
-#include <stdexcept>
-#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 
 namespace ir {
 
-using memory::ArenaVector;
+// Forest of the processed vertices of the Lengauer-Tarjan algorithm over
+// flat arrays indexed by DFS numbers. The arrays are owned by the caller, the
+// path stack must fit every vertex.
 class DSU {
   public:
+    static constexpr uint32_t ROOT = UINT32_MAX;
+
     DSU() = delete;
-    DSU(memory::ArenaVector<BB *> *labels,
-        const memory::ArenaVector<size_t> *sdoms,
-        ArenaAllocator *const allocator)
-        : parentLinks_(labels->size(), nullptr, allocator->ToSTL()),
-          labels_(labels), sdoms_(sdoms) {}
+    DSU(uint32_t *ancestors, uint32_t *labels, const uint32_t *sdoms,
+        uint32_t *pathStack, size_t size)
+        : ancestors_(ancestors), labels_(labels), sdoms_(sdoms),
+          pathStack_(pathStack), size_(size) {}
     DSU(const DSU &) = default;
     DSU &operator=(const DSU &) = default;
     DSU(DSU &&) = default;
     DSU &operator=(DSU &&) = default;
     ~DSU() = default;
-    BB *Find(BB *bblock);
-    size_t GetSize() const { return parentLinks_.size(); }
-    void Unite(BB *target, BB *parent) {
-        setParentLinks(target->GetId(), parent);
-    }
 
-    BB *getParentLinks(size_t id) { return parentLinks_.at(id); }
-    void setParentLinks(size_t id, BB *bblock) { parentLinks_.at(id) = bblock; }
+    // Vertices are their own labels and roots of their trees
+    void Reset();
+    // Returns the vertex with the minimal semi-dominator on the path from the
+    // vertex to the root of its tree, excluding the root
+    uint32_t Find(uint32_t vertex);
+    size_t GetSize() const { return size_; }
+    void Unite(uint32_t target, uint32_t parent) {
+        assert(target < size_ && parent < size_);
+        ancestors_[target] = parent;
+    }
 
   private:
-    void UpdateAncestorPath(BB *bblock);
+    void UpdateAncestorPath(uint32_t vertex);
 
   private:
-    ArenaVector<BB *> parentLinks_;
-    ArenaVector<BB *> *labels_;
-    const ArenaVector<size_t> *sdoms_;
+    uint32_t *ancestors_;
+    uint32_t *labels_;
+    const uint32_t *sdoms_;
+    uint32_t *pathStack_;
+    size_t size_;
 };
 
 } // namespace ir
-#endif // JIT_AOT_COMPILERS_DOMTREE_DSU_H_
\ No newline at end of file
+#endif // JIT_AOT_COMPILERS_DOMTREE_DSU_H_
@@ -0,0 +1,104 @@
+#include "inductionVariables.h"
+#include "instructions.h"
+
+namespace ir {
+namespace {
+bool IsAffineOpcode(Opcode opcode) {
+    return opcode == Opcode::ADD || opcode == Opcode::ADDI ||
+           opcode == Opcode::MUL || opcode == Opcode::MULI;
+}
+} // namespace
+
+InductionVariables::InductionVariables(Loop *loop, ArenaAllocator *allocator)
+    : loop_(loop), allocator_(allocator),
+      variables_(allocator->ToSTL(memory::ArenaTag::LOOP_INFO)),
+      indices_(allocator->ToSTL(memory::ArenaTag::LOOP_INFO)) {
+    assert((loop) && (allocator));
+    if (loop->IsRoot() || loop->IsIrreducible() ||
+        loop->GetBackEdges().size() != 1) {
+        return;
+    }
+    FindBasicVariables();
+    if (!variables_.empty()) {
+        FindDerivedVariables();
+    }
+}
+
+const InductionVariable *
+InductionVariables::Find(const SingleInstruction *instr) const {
+    assert(instr);
+    auto it = indices_.find(instr->GetInstID());
+    return it != indices_.end() ? &variables_[it->second] : nullptr;
+}
+
+bool InductionVariables::IsInvariant(SingleInstruction *instr) const {
+    assert(instr);
+    auto *bblock = instr->GetInstBB();
+    return bblock == nullptr || !loop_->Contains(bblock);
+}
+
+void InductionVariables::FindBasicVariables() {
+    auto *header = loop_->GetHeader();
+    auto *latch = loop_->GetBackEdges()[0];
+    for (auto *instr : *header) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        if (phi->GetInputsCount() != 2 || !IsIntegerType(phi->GetType())) {
+            continue;
+        }
+        size_t latchIdx = phi->GetSourceBB(0) == latch ? 0 : 1;
+        if (phi->GetSourceBB(latchIdx) != latch) {
+            continue;
+        }
+        // the phi is increased by an invariant on every iteration
+        auto *update = phi->GetInput(latchIdx).GetInstruction();
+        auto opcode = update->GetOpcode();
+        if ((opcode != Opcode::ADD && opcode != Opcode::ADDI) ||
+            update->GetType() != phi->GetType()) {
+            continue;
+        }
+        auto *add = static_cast<InputsInstr *>(update);
+        for (size_t i = 0; i < 2; ++i) {
+            auto *step = add->GetInput(1 - i).GetInstruction();
+            if (add->GetInput(i) == phi && step != phi && IsInvariant(step)) {
+                AddVariable({phi, phi, nullptr, step, latchIdx});
+                break;
+            }
+        }
+    }
+}
+
+void InductionVariables::FindDerivedVariables() {
+    // the bases are visited before the values derived from them. Variables
+    // are added meanwhile, so no scope is opened for the transient vector.
+    auto *bblocks = loop_->GetBlocksInDomOrder(allocator_);
+
+    for (auto *bblock : *bblocks) {
+        for (auto *instr : *bblock) {
+            if (!IsAffineOpcode(instr->GetOpcode())) {
+                continue;
+            }
+            auto *withInputs = static_cast<InputsInstr *>(instr);
+            for (size_t i = 0; i < 2; ++i) {
+                auto *base = withInputs->GetInput(i).GetInstruction();
+                auto *other = withInputs->GetInput(1 - i).GetInstruction();
+                const auto *baseVariable = Find(base);
+                if (baseVariable != nullptr && IsInvariant(other) &&
+                    instr->GetType() == base->GetType()) {
+                    AddVariable(
+                        {instr, baseVariable->basis, base, other, i});
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void InductionVariables::AddVariable(const InductionVariable &variable) {
+    assert((variable.instr) && (variable.basis) && (variable.invariant));
+    indices_.insert({variable.instr->GetInstID(), variables_.size()});
+    variables_.push_back(variable);
+}
+} // namespace ir
@@ -0,0 +1,60 @@
+#ifndef JIT_AOT_COURSE_DOMTREE_INDUCTION_VARIABLES_H_
+#define JIT_AOT_COURSE_DOMTREE_INDUCTION_VARIABLES_H_
+
+#include "arena.h"
+#include "loop.h"
+
+namespace ir {
+class SingleInstruction;
+class PhiInstr;
+
+// Value changed by the same loop invariant amount on every iteration. A basic
+// variable is a header phi increased by an invariant step on the back edge,
+// derived ones are its affine functions computed by ADD, ADDI, MUL and MULI
+// of another variable and an invariant.
+struct InductionVariable {
+    SingleInstruction *instr = nullptr;
+    // basic variable the value is derived from, the phi itself for basic ones
+    PhiInstr *basis = nullptr;
+    // variable the value is computed from, nullptr for basic ones
+    SingleInstruction *base = nullptr;
+    // step of a basic variable, the other operand of a derived one. Immediates
+    // of ADDI and MULI are constants out of the blocks.
+    SingleInstruction *invariant = nullptr;
+    // index of the base among the inputs, of the back edge value for phis
+    size_t baseIdx = 0;
+
+    bool IsBasic() const { return base == nullptr; }
+};
+
+// Finds the induction variables of a reducible loop with a single back edge,
+// other loops have none. Requires valid dominator and loop trees, which the
+// results are valid with.
+class InductionVariables {
+  public:
+    InductionVariables(Loop *loop, ArenaAllocator *allocator);
+
+    Loop *GetLoop() const { return loop_; }
+    // Variables dominating their users come first
+    const ArenaVector<InductionVariable> &GetVariables() const {
+        return variables_;
+    }
+    const InductionVariable *Find(const SingleInstruction *instr) const;
+    // Defined out of the loop, so the same on every iteration
+    bool IsInvariant(SingleInstruction *instr) const;
+
+  private:
+    void FindBasicVariables();
+    void FindDerivedVariables();
+    void AddVariable(const InductionVariable &variable);
+
+  private:
+    Loop *loop_;
+    ArenaAllocator *allocator_;
+    ArenaVector<InductionVariable> variables_;
+    // instruction ids to the indices of the variables
+    ArenaUnorderedMap<size_t, size_t> indices_;
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_DOMTREE_INDUCTION_VARIABLES_H_
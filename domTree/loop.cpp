@@ -1,4 +1,6 @@
 #include "loop.h"
+#include "domTreeUpdater.h"
+#include "graph.h"
 #include <iostream>
 
 namespace ir {
@@ -10,22 +12,19 @@ BB *Loop::GetHeader() { return header_; }
 const BB *Loop::GetHeader() const { return header_; }
 
 void Loop::AddBackEdge(BB *backEdgeSource) {
-    if (std::find(backEdges_.begin(), backEdges_.end(), backEdgeSource) !=
-        backEdges_.end()) {
-        std::cout << "[Loop Error] AddBackEdge failed" << std::endl;
-        std::abort();
-    }
+    // the loop checker adds every source once, searching them would make
+    // loops with many latches quadratic
+    assert(backEdgeSource);
     backEdges_.push_back(backEdgeSource);
 }
 
-ArenaVector<BB *> Loop::GetBackEdges() { return backEdges_; }
+const ArenaVector<BB *> &Loop::GetBackEdges() const { return backEdges_; }
 
-ArenaVector<BB *> Loop::GetBasicBlocks() { return basicBlocks_; }
+const ArenaVector<BB *> &Loop::GetBasicBlocks() const { return basicBlocks_; }
 
 void Loop::AddBB(BB *bblock) {
-    if (!(bblock) || (bblock->GetLoop() != nullptr) ||
-        !(std::find(basicBlocks_.begin(), basicBlocks_.end(), bblock) ==
-          basicBlocks_.end())) {
+    // a block is in a single loop, so it cannot be added twice
+    if (!(bblock) || (bblock->GetLoop() != nullptr)) {
         std::cout << "[Loop Error] while adding basic block" << std::endl;
         std::abort();
     }
@@ -35,6 +34,8 @@ void Loop::AddBB(BB *bblock) {
 
 Loop *Loop::GetOuterLoop() { return outerLoop_; }
 
+const Loop *Loop::GetOuterLoop() const { return outerLoop_; }
+
 void Loop::SetOuterLoop(Loop *loop) { outerLoop_ = loop; }
 
 const ArenaVector<Loop *> &Loop::GetInnerLoops() const { return innerLoops_; }
@@ -48,6 +49,174 @@ void Loop::AddInnerLoop(Loop *loop) {
     innerLoops_.push_back(loop);
 }
 
+size_t Loop::GetDepth() const { return depth_; }
+
+void Loop::SetDepth(size_t depth) { depth_ = depth; }
+
+bool Loop::Contains(const Loop *loop) const {
+    while (loop != nullptr && loop->GetDepth() > depth_) {
+        loop = loop->GetOuterLoop();
+    }
+    return loop == this;
+}
+
+bool Loop::Contains(const BB *bblock) const {
+    assert(bblock);
+    return Contains(bblock->GetLoop());
+}
+
+ArenaVector<Loop *> *Loop::GetLoopsOuterFirst(ArenaAllocator *allocator) {
+    assert(allocator);
+    auto *loops = allocator->template NewVector<Loop *>(1, this);
+    for (size_t i = 0; i < loops->size(); ++i) {
+        for (auto *inner : (*loops)[i]->GetInnerLoops()) {
+            loops->push_back(inner);
+        }
+    }
+    return loops;
+}
+
+ArenaVector<BB *> *Loop::GetBlocksInDomOrder(ArenaAllocator *allocator) {
+    assert((allocator) && !IsRoot());
+    auto *bblocks = allocator->template NewVector<BB *>(1, header_);
+    for (size_t i = 0; i < bblocks->size(); ++i) {
+        for (auto *dominated : (*bblocks)[i]->GetDominatedBBs()) {
+            if (Contains(dominated)) {
+                bblocks->push_back(dominated);
+            }
+        }
+    }
+    return bblocks;
+}
+
+const ArenaVector<Loop::Edge> &Loop::GetExitEdges() const {
+    return exitEdges_;
+}
+
+void Loop::AddExitEdge(BB *from, BB *to) {
+    assert(from && to);
+    exitEdges_.emplace_back(from, to);
+}
+
+BB *Loop::GetPreHeader() {
+    assert(!isRoot_);
+    BB *preHeader = nullptr;
+    for (auto *pred : header_->GetPredecessors()) {
+        if (Contains(pred)) {
+            continue;
+        }
+        if (preHeader != nullptr) {
+            return nullptr;
+        }
+        preHeader = pred;
+    }
+    if (preHeader == nullptr || preHeader->GetSuccessors().size() != 1) {
+        return nullptr;
+    }
+    return preHeader;
+}
+
+BB *Loop::GetOrCreatePreHeader() {
+    assert(!isRoot_ && !isIrreducible_ && outerLoop_);
+    if (auto *preHeader = GetPreHeader()) {
+        return preHeader;
+    }
+    auto *graph = header_->GetGraph();
+    auto &analyses = graph->GetAnalyses();
+    // the CFG edits drop the analyses, which are then patched
+    bool isDomTreeValid = analyses.IsValid(AnalysisKind::DOM_TREE);
+    bool isLoopTreeValid = analyses.IsValid(AnalysisKind::LOOP_TREE);
+
+    auto *allocator = graph->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    memory::ArenaTagScope tagScope(allocator, memory::ArenaTag::LOOP_INFO);
+    // an entry is repeated for each of its edges to the header
+    auto *entries = allocator->template NewVector<BB *>();
+    for (auto *pred : header_->GetPredecessors()) {
+        if (!Contains(pred)) {
+            entries->push_back(pred);
+        }
+    }
+
+    auto *preHeader = graph->CreateEmptyBB();
+    MoveHeaderPhiInputs(preHeader, *entries);
+    for (auto *entry : *entries) {
+        entry->ReplaceSuccessor(header_, preHeader);
+        header_->DeletePredecessors(entry);
+        preHeader->AddPredecessors(entry);
+        // the edge left the loops of the entry which do not contain the
+        // header, now it enters the outer loop of the header instead
+        for (auto *loop = entry->GetLoop(); !loop->Contains(header_);
+             loop = loop->GetOuterLoop()) {
+            auto &exits = loop->exitEdges_;
+            auto it = std::find(exits.begin(), exits.end(),
+                                Edge{entry, header_});
+            assert(it != exits.end());
+            it->second = preHeader;
+        }
+    }
+    if (graph->GetFirstBB() == header_) {
+        graph->SetFirstBB(preHeader);
+    }
+    preHeader->AddSuccessors(header_);
+    header_->AddPredecessors(preHeader);
+    outerLoop_->AddBB(preHeader);
+
+    if (isDomTreeValid) {
+        DomTreeUpdater(graph).InsertDominatingBlock(header_, preHeader);
+    }
+    if (isLoopTreeValid) {
+        analyses.SetValid(AnalysisKind::LOOP_TREE);
+    }
+    return preHeader;
+}
+
+void Loop::MoveHeaderPhiInputs(BB *preHeader,
+                               const ArenaVector<BB *> &entries) {
+    if (entries.empty()) {
+        return;
+    }
+    auto isEntry = [&entries](BB *bblock) {
+        return std::find(entries.begin(), entries.end(), bblock) !=
+               entries.end();
+    };
+    auto *graph = header_->GetGraph();
+    for (auto *instr : *header_) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        auto &sources = phi->GetSourceBBs();
+        if (entries.size() == 1) {
+            auto it = std::find(sources.begin(), sources.end(), entries[0]);
+            if (it != sources.end()) {
+                *it = preHeader;
+            }
+            continue;
+        }
+        // values coming from several entries are merged in the preheader
+        auto &inputs = phi->GetInputs();
+        PhiInstr *merged = nullptr;
+        for (size_t i = 0; i < sources.size();) {
+            if (!isEntry(sources[i])) {
+                ++i;
+                continue;
+            }
+            if (merged == nullptr) {
+                merged = graph->GetInstructionBuilder()->BuildPhi(
+                    phi->GetType());
+            }
+            merged->AddPhiInput(inputs[i], sources[i]);
+            inputs.erase(inputs.begin() + static_cast<ptrdiff_t>(i));
+            sources.erase(sources.begin() + static_cast<ptrdiff_t>(i));
+        }
+        if (merged != nullptr) {
+            preHeader->PushInstForward(merged);
+            phi->AddPhiInput(merged, preHeader);
+        }
+    }
+}
+
 void Loop::SetIrreducibility(bool isIrr) { isIrreducible_ = isIrr; }
 
 bool Loop::IsIrreducible() const { return isIrreducible_; }
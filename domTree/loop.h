@@ -4,6 +4,7 @@
 #include "arena.h"
 #include "bb.h"
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 namespace ir {
@@ -11,38 +12,79 @@ namespace ir {
 using memory::ArenaAllocator;
 using memory::ArenaVector;
 
-enum class DFSColors : uint32_t { WHITE = 0, GREY, BLACK, COLORS_SIZE = BLACK };
-
+// Node of the loop nesting tree. The root loop is the whole graph and has no
+// header. Blocks belong to the innermost loop containing them, so basic blocks
+// of a loop do not include the blocks of its inner loops. An irreducible loop
+// has several entries, its header is the one visited first by DFS.
 class Loop {
   public:
+    // Edge leaving the loop, from a block of the loop (or of its inner loops)
+    using Edge = std::pair<BB *, BB *>;
+
     Loop(size_t id, BB *header, bool isIrreducible,
          ArenaAllocator *const allocator, bool isRoot = false)
-        : id_(id), header_(header), backEdges_(allocator->ToSTL()),
-          basicBlocks_(allocator->ToSTL()), outerLoop_(nullptr),
-          innerLoops_(allocator->ToSTL()), isIrreducible_(isIrreducible),
-          isRoot_(isRoot) {}
+        : id_(id), header_(header),
+          backEdges_(allocator->ToSTL(memory::ArenaTag::LOOP_INFO)),
+          basicBlocks_(allocator->ToSTL(memory::ArenaTag::LOOP_INFO)),
+          outerLoop_(nullptr),
+          innerLoops_(allocator->ToSTL(memory::ArenaTag::LOOP_INFO)),
+          exitEdges_(allocator->ToSTL(memory::ArenaTag::LOOP_INFO)),
+          isIrreducible_(isIrreducible), isRoot_(isRoot) {}
 
     size_t GetId() const;
     BB *GetHeader();
     const BB *GetHeader() const;
 
     void AddBackEdge(BB *backEdgeSource);
-    ArenaVector<BB *> GetBackEdges();
+    const ArenaVector<BB *> &GetBackEdges() const;
 
-    ArenaVector<BB *> GetBasicBlocks();
+    const ArenaVector<BB *> &GetBasicBlocks() const;
 
     void AddBB(BB *bblock);
 
     Loop *GetOuterLoop();
+    const Loop *GetOuterLoop() const;
     void SetOuterLoop(Loop *loop);
 
     const ArenaVector<Loop *> &GetInnerLoops() const;
     void AddInnerLoop(Loop *loop);
 
+    // Number of loops containing this one, 0 for the root loop
+    size_t GetDepth() const;
+    void SetDepth(size_t depth);
+
+    // The loop contains the block or the loop if they are in it or in one of
+    // its inner loops
+    bool Contains(const Loop *loop) const;
+    bool Contains(const BB *bblock) const;
+
+    // This loop and the loops nested in it, every loop is listed before its
+    // inner ones
+    ArenaVector<Loop *> *GetLoopsOuterFirst(ArenaAllocator *allocator);
+    // Blocks of the loop and of its inner loops in the order of the dominator
+    // tree, so every block follows its dominator. The dominator tree must be
+    // valid, the loop must not be the root one.
+    ArenaVector<BB *> *GetBlocksInDomOrder(ArenaAllocator *allocator);
+
+    const ArenaVector<Edge> &GetExitEdges() const;
+    void AddExitEdge(BB *from, BB *to);
+
+    // The only predecessor of the header outside of the loop, if the header
+    // is its only successor
+    BB *GetPreHeader();
+    // Creates the preheader if there is none: the entries of the loop are
+    // redirected to a new block of the outer loop, phis of the header get
+    // the values from the new block. The dominator and loop trees are kept
+    // valid. The loop must be reducible.
+    BB *GetOrCreatePreHeader();
+
     void SetIrreducibility(bool isIrr);
     bool IsIrreducible() const;
     bool IsRoot() const;
 
+  private:
+    void MoveHeaderPhiInputs(BB *preHeader, const ArenaVector<BB *> &entries);
+
   private:
     size_t id_;
     BB *header_;
@@ -50,6 +92,8 @@ class Loop {
     ArenaVector<BB *> basicBlocks_;
     Loop *outerLoop_;
     ArenaVector<Loop *> innerLoops_;
+    ArenaVector<Edge> exitEdges_;
+    size_t depth_ = 0;
     bool isIrreducible_;
     bool isRoot_;
 };
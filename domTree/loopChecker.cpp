@@ -13,55 +13,220 @@ void LoopChecker::VerifyGraphLoops(Graph *targetGraph) {
         return;
     }
 
+    // loops are kept in the graph's arena, the rest is released on return
+    memory::ArenaScope scope(targetGraph->GetScratchAllocator());
+    memory::ArenaTagScope tagScope(targetGraph->GetScratchAllocator(),
+                                   memory::ArenaTag::LOOP_INFO);
     InitializeLoopStructures(targetGraph);
-    DomTreeBuilder().Construct(targetGraph);
-    IdentifyBackEdges();
-    targetGraph->ReleaseMarker(greyMarker_);
-    targetGraph->ReleaseMarker(blackMarker_);
-    OrganizeLoops();
+    // loop passes rely on both trees, though the forest does not need the
+    // dominator tree
+    targetGraph->GetAnalyses().RequireDomTree();
+    NumberBlocks();
+    CollectPredecessorRanges();
+    IdentifyLoops();
     ConstructLoopTree();
+    dfsBlocks_ = nullptr;
+    loops_ = nullptr;
+    targetGraph->GetAnalyses().CountComputation(AnalysisKind::LOOP_TREE);
+    targetGraph->GetAnalyses().SetValid(AnalysisKind::LOOP_TREE);
 }
 
 void LoopChecker::InitializeLoopStructures(Graph *targetGraph) {
     graph_ = targetGraph;
-    blockId_ = 0;
+    // loops of the previous run are dropped, so the graph can be rechecked
+    graph_->ForEachBB([](BB *bblock) { bblock->SetLoop(nullptr); });
+    graph_->SetLoopTree(nullptr);
     auto bblocksCount = graph_->GetBBCount();
-    if (dfsBlocks_ == nullptr) {
-        auto *allocator = graph_->GetAllocator();
-        dfsBlocks_ = allocator->NewVector<BB *>(bblocksCount, nullptr);
-        loops_ = allocator->NewVector<Loop *>();
-    } else {
-        dfsBlocks_->clear();
-        dfsBlocks_->clear();
-        loops_->clear();
-
-        dfsBlocks_->resize(bblocksCount, nullptr);
-    }
-    greyMarker_ = graph_->GetNewMarker();
-    blackMarker_ = graph_->GetNewMarker();
+    auto idsBound = graph_->GetBBIdsBound();
+    assert(idsBound < NONE);
+    auto *allocator = graph_->GetScratchAllocator();
+    auto newArray = [allocator, bblocksCount](uint32_t value) {
+        auto *array = allocator->template AllocateArray<uint32_t>(bblocksCount);
+        std::fill_n(array, bblocksCount, value);
+        return array;
+    };
+    numbers_ = allocator->template AllocateArray<uint32_t>(idsBound);
+    std::fill_n(numbers_, idsBound, NONE);
+    dfsBlocks_ = allocator->NewVector<BB *>();
+    dfsBlocks_->reserve(bblocksCount);
+    last_ = newArray(NONE);
+    unionParents_ = newArray(NONE);
+    headedLoops_ = allocator->template AllocateArray<Loop *>(bblocksCount);
+    std::fill_n(headedLoops_, bblocksCount, nullptr);
+    edges_ = allocator->NewVector<Edge>();
+    edges_->reserve(bblocksCount);
+    releasedEdges_ = newArray(NONE);
+    collapsedEdges_ = newArray(NONE);
+    minPredecessors_ = newArray(NONE);
+    maxPredecessors_ = newArray(0);
+    body_ = allocator->NewVector<uint32_t>();
+    worklist_ = allocator->NewVector<uint32_t>();
+    bodyStamps_ = newArray(NONE);
+    sourceStamps_ = newArray(NONE);
+    loops_ = allocator->NewVector<Loop *>();
 }
 
-void LoopChecker::IdentifyBackEdges() {
+void LoopChecker::NumberBlocks() {
     assert(graph_);
-    DiscoverBackEdges(graph_->GetFirstBB(), graph_->GetAllocator());
-    assert(blockId_ == graph_->GetBBCount());
-}
-
-void LoopChecker::OrganizeLoops() {
-    for (auto *bblock : *dfsBlocks_) {
-        auto *loop = bblock->GetLoop();
-        if (!loop || loop->GetHeader() != bblock) {
+    // edges grow along, so the stack is not released before the checker ends
+    auto *allocator = graph_->GetScratchAllocator();
+    // blocks on the DFS path with the index of their next successor. Union
+    // parents of the blocks on the path are the blocks themselves, finished
+    // blocks are linked to their DFS parents.
+    auto *stack = allocator->NewVector<std::pair<BB *, size_t>>();
+    auto visit = [this, stack](BB *bblock) {
+        auto number = static_cast<uint32_t>(dfsBlocks_->size());
+        numbers_[bblock->GetId()] = number;
+        unionParents_[number] = number;
+        dfsBlocks_->push_back(bblock);
+        stack->emplace_back(bblock, 0);
+        return number;
+    };
+    visit(graph_->GetFirstBB());
+    while (!stack->empty()) {
+        auto &[bblock, succIdx] = stack->back();
+        auto number = numbers_[bblock->GetId()];
+        const auto &successors = bblock->GetSuccessors();
+        if (succIdx == successors.size()) {
+            last_[number] = dfsBlocks_->size() - 1;
+            stack->pop_back();
+            if (!stack->empty()) {
+                unionParents_[number] = numbers_[stack->back().first->GetId()];
+            }
             continue;
         }
-        if (loop->IsIrreducible()) {
-            for (auto *backEdgeSource : loop->GetBackEdges()) {
-                if (!backEdgeSource->GetLoop()) {
-                    backEdgeSource->SetLoop(loop);
-                }
+        auto *succ = successors[succIdx++];
+        auto succNumber = numbers_[succ->GetId()];
+        if (succNumber == NONE) {
+            AddEdge(number, number, visit(succ));
+        } else if (unionParents_[succNumber] != succNumber) {
+            // the successor is finished, the nearest common ancestor is
+            // the nearest one of the successor on the DFS path
+            AddEdge(Find(succNumber), number, succNumber);
+        }
+        // otherwise the successor is on the path, it is a back edge
+    }
+    assert(dfsBlocks_->size() == graph_->GetBBCount());
+    for (uint32_t i = 0; i < dfsBlocks_->size(); ++i) {
+        unionParents_[i] = i;
+    }
+}
+
+void LoopChecker::AddEdge(uint32_t ancestor, uint32_t source,
+                          uint32_t target) {
+    edges_->push_back({source, target, releasedEdges_[ancestor]});
+    releasedEdges_[ancestor] = edges_->size() - 1;
+}
+
+void LoopChecker::CollectPredecessorRanges() {
+    for (uint32_t number = 0; number < dfsBlocks_->size(); ++number) {
+        for (auto *pred : dfsBlocks_->at(number)->GetPredecessors()) {
+            auto predNumber = numbers_[pred->GetId()];
+            if (predNumber != NONE) {
+                minPredecessors_[number] =
+                    std::min(minPredecessors_[number], predNumber);
+                maxPredecessors_[number] =
+                    std::max(maxPredecessors_[number], predNumber);
             }
+        }
+    }
+}
+
+void LoopChecker::IdentifyLoops() {
+    auto *allocator = graph_->GetAllocator();
+    for (auto number = static_cast<uint32_t>(dfsBlocks_->size());
+         number-- > 0;) {
+        // the loops of the block and its ancestors may contain the edges,
+        // they are given to the headers of the loops found so far
+        for (auto idx = releasedEdges_[number]; idx != NONE;) {
+            auto &edge = edges_->at(idx);
+            auto next = edge.next;
+            auto target = Find(edge.target);
+            edge.next = collapsedEdges_[target];
+            collapsedEdges_[target] = idx;
+            idx = next;
+        }
+        CollectLoopBody(number, allocator);
+    }
+}
+
+uint32_t LoopChecker::Find(uint32_t number) {
+    while (unionParents_[number] != number) {
+        // path halving
+        unionParents_[number] = unionParents_[unionParents_[number]];
+        number = unionParents_[number];
+    }
+    return number;
+}
+
+void LoopChecker::CollectLoopBody(uint32_t header,
+                                  ArenaAllocator *const allocator) {
+    auto *headerBBlock = dfsBlocks_->at(header);
+    body_->clear();
+    auto addToBody = [this, header](uint32_t number) {
+        auto bodyBlock = Find(number);
+        if (bodyBlock != header && bodyStamps_[bodyBlock] != header) {
+            bodyStamps_[bodyBlock] = header;
+            body_->push_back(bodyBlock);
+            worklist_->push_back(bodyBlock);
+        }
+    };
+    bool isLoop = false;
+    for (auto *pred : headerBBlock->GetPredecessors()) {
+        auto predNumber = numbers_[pred->GetId()];
+        if (predNumber != NONE && IsAncestor(header, predNumber)) {
+            isLoop = true;
+            addToBody(predNumber);
+        }
+    }
+    if (!isLoop) {
+        return;
+    }
+
+    bool isIrreducible = false;
+    auto minPredecessor = minPredecessors_[header];
+    auto maxPredecessor = maxPredecessors_[header];
+    while (!worklist_->empty()) {
+        auto bodyBlock = worklist_->back();
+        worklist_->pop_back();
+        isIrreducible |= minPredecessors_[bodyBlock] < header ||
+                         maxPredecessors_[bodyBlock] > last_[header];
+        minPredecessor = std::min(minPredecessor, minPredecessors_[bodyBlock]);
+        maxPredecessor = std::max(maxPredecessor, maxPredecessors_[bodyBlock]);
+        for (auto idx = collapsedEdges_[bodyBlock]; idx != NONE;
+             idx = edges_->at(idx).next) {
+            // released at an ancestor of the header, so it is in the subtree
+            assert(IsAncestor(header, edges_->at(idx).source));
+            addToBody(edges_->at(idx).source);
+        }
+        collapsedEdges_[bodyBlock] = NONE;
+    }
+    minPredecessors_[header] = minPredecessor;
+    maxPredecessors_[header] = maxPredecessor;
+
+    auto *loop = allocator->template NewWithTag<Loop>(
+        memory::ArenaTag::LOOP_INFO, loops_->size(), headerBBlock,
+        isIrreducible, allocator);
+    loops_->push_back(loop);
+    headedLoops_[header] = loop;
+    loop->AddBB(headerBBlock);
+    for (auto *pred : headerBBlock->GetPredecessors()) {
+        auto predNumber = numbers_[pred->GetId()];
+        // a source may have several edges to the header
+        if (predNumber != NONE && IsAncestor(header, predNumber) &&
+            sourceStamps_[predNumber] != header) {
+            sourceStamps_[predNumber] = header;
+            loop->AddBackEdge(pred);
+        }
+    }
+    for (auto bodyBlock : *body_) {
+        if (auto *innerLoop = headedLoops_[bodyBlock]) {
+            innerLoop->SetOuterLoop(loop);
+            loop->AddInnerLoop(innerLoop);
         } else {
-            ClassifyReducibleLoop(loop);
+            loop->AddBB(dfsBlocks_->at(bodyBlock));
         }
+        unionParents_[bodyBlock] = header;
     }
 }
 
@@ -74,8 +239,9 @@ void LoopChecker::ConstructLoopTree() {
     }
 
     auto *allocator = graph_->GetAllocator();
-    auto *rootLoop = allocator->template New<Loop>(loops_->size(), nullptr,
-                                                   false, allocator, true);
+    auto *rootLoop = allocator->template NewWithTag<Loop>(
+        memory::ArenaTag::LOOP_INFO, loops_->size(), nullptr, false, allocator,
+        true);
     loops_->push_back(rootLoop);
 
     for (auto *bblock : *dfsBlocks_) {
@@ -88,89 +254,37 @@ void LoopChecker::ConstructLoopTree() {
         }
     }
 
-    graph_->SetLoopTree(rootLoop);
-}
-
-void LoopChecker::DiscoverBackEdges(BB *bblock,
-                                    ArenaAllocator *const allocator) {
-    if (!bblock) {
-        std::cerr << "[LoopChecker Error] Block is null" << std::endl;
-        std::abort();
-    }
-    bblock->SetMarker(greyMarker_);
-    for (BB *succ : bblock->GetSuccessors()) {
-        if (succ->IsMarkerSet(greyMarker_)) {
-            RecordLoopInfo(succ, bblock, allocator);
-        } else if (!succ->IsMarkerSet(blackMarker_)) {
-            DiscoverBackEdges(succ, allocator);
+    // outer loops precede the inner ones
+    auto *worklist = graph_->GetScratchAllocator()->NewVector<Loop *>();
+    worklist->push_back(rootLoop);
+    while (!worklist->empty()) {
+        auto *loop = worklist->back();
+        worklist->pop_back();
+        for (auto *inner : loop->GetInnerLoops()) {
+            inner->SetDepth(loop->GetDepth() + 1);
+            worklist->push_back(inner);
         }
     }
 
-    bblock->ClearMarker(greyMarker_);
-    bblock->SetMarker(blackMarker_);
-    dfsBlocks_->at(blockId_++) = bblock;
-}
-
-void LoopChecker::RecordLoopInfo(BB *header, BB *backEdgeSource,
-                                 ArenaAllocator *const allocator) {
-    Loop *loop = header->GetLoop();
-    if (!loop) {
-        loop = allocator->template New<Loop>(
-            loops_->size(), header, IsLoopIrreducible(header, backEdgeSource),
-            allocator);
-        loop->AddBB(header);
-        loop->AddBackEdge(backEdgeSource);
-        loops_->push_back(loop);
-        header->SetLoop(loop);
-    } else {
-        loop->AddBackEdge(backEdgeSource);
-        if (IsLoopIrreducible(header, backEdgeSource)) {
-            loop->SetIrreducibility(true);
+    // an edge exits every loop containing its source up to the innermost
+    // one containing its destination, both chains are walked up at once
+    for (auto *bblock : *dfsBlocks_) {
+        for (auto *succ : bblock->GetSuccessors()) {
+            const Loop *succLoop = succ->GetLoop();
+            for (auto *loop = bblock->GetLoop();;
+                 loop = loop->GetOuterLoop()) {
+                while (succLoop->GetDepth() > loop->GetDepth()) {
+                    succLoop = succLoop->GetOuterLoop();
+                }
+                if (succLoop == loop) {
+                    break;
+                }
+                loop->AddExitEdge(bblock, succ);
+            }
         }
     }
-}
-
-void LoopChecker::ClassifyReducibleLoop(Loop *loop) {
-    if (!loop) {
-        std::cerr << "[Loop Checker Error] Loop is null during reducible loop "
-                     "classification"
-                  << std::endl;
-        std::abort();
-    }
-
-    blackMarker_ = graph_->GetNewMarker();
-    loop->GetHeader()->SetMarker(blackMarker_);
-
-    for (BB *backEdgeSource : loop->GetBackEdges()) {
-        CollectLoopDetails(loop, backEdgeSource);
-    }
-    graph_->ReleaseMarker(blackMarker_);
-}
-
-void LoopChecker::CollectLoopDetails(Loop *loop, BB *bblock) {
-    if (!loop || !bblock) {
-        std::cerr << "[LoopChecker Error] Loop or block is null" << std::endl;
-        std::abort();
-    }
-
-    if (bblock->IsMarkerSet(blackMarker_)) {
-        return; // Already processed
-    }
-
-    bblock->SetMarker(blackMarker_);
-    Loop *blockLoop = bblock->GetLoop();
-
-    if (!blockLoop) {
-        loop->AddBB(bblock);
-    } else if (blockLoop->GetId() != loop->GetId() &&
-               !blockLoop->GetOuterLoop()) {
-        blockLoop->SetOuterLoop(loop);
-        loop->AddInnerLoop(blockLoop);
-    }
 
-    for (BB *pred : bblock->GetPredecessors()) {
-        CollectLoopDetails(loop, pred);
-    }
+    graph_->SetLoopTree(rootLoop);
 }
 
 } // namespace ir
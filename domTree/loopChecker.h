@@ -6,32 +6,77 @@
 
 namespace ir {
 
+// Builds the loop nesting forest as in "Nesting of Reducible and Irreducible
+// Loops" by Havlak. Blocks are numbered in DFS preorder and visited backwards,
+// so inner loops are found before the outer ones and are collapsed into their
+// headers with union-find. A loop with an entry from outside of the DFS
+// subtree of its header is irreducible, the loops around it still contain the
+// whole region.
+//
+// Havlak passes such entries on from header to header, which is quadratic
+// for deeply nested irreducible regions, e.g. in generated state machines.
+// Following Ramalingam, an edge is rather kept until the nearest common DFS
+// ancestor of its ends is visited: only the loops of that block and its
+// ancestors can contain the edge. Irreducibility is decided by the range of
+// predecessor numbers of the collapsed blocks.
 class LoopChecker {
   public:
     void VerifyGraphLoops(Graph *targetGraph);
 
   private:
     void InitializeLoopStructures(Graph *targetGraph);
-    void IdentifyBackEdges();
-    void OrganizeLoops();
+    void NumberBlocks();
+    void AddEdge(uint32_t ancestor, uint32_t source, uint32_t target);
+    void CollectPredecessorRanges();
+    void IdentifyLoops();
+    void CollectLoopBody(uint32_t header, ArenaAllocator *const allocator);
     void ConstructLoopTree();
-    void DiscoverBackEdges(BB *bblock, ArenaAllocator *const allocator);
-    void RecordLoopInfo(BB *header, BB *backEdgeSource,
-                        ArenaAllocator *const allocator);
-    void ClassifyReducibleLoop(Loop *loop);
-    void CollectLoopDetails(Loop *loop, BB *bblock);
-
-    static bool IsLoopIrreducible(const BB *header, const BB *backEdgeSource) {
-        return !header->Domites(backEdgeSource);
+
+    // Header of the outermost loop found so far containing the block. During
+    // DFS, the nearest ancestor on the DFS path.
+    uint32_t Find(uint32_t number);
+
+    bool IsAncestor(uint32_t ancestor, uint32_t number) const {
+        return ancestor <= number && number <= last_[ancestor];
     }
 
   private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Forward, tree or cross edge, linked into the list of the block it is
+    // released at and then of the header collapsing its target
+    struct Edge {
+        uint32_t source;
+        uint32_t target;
+        uint32_t next;
+    };
+
     Graph *graph_ = nullptr;
 
-    Marker greyMarker_;
-    Marker blackMarker_;
-    size_t blockId_ = 0;
+    // preorder numbers of blocks by their ids
+    uint32_t *numbers_ = nullptr;
+    // blocks in preorder and the last number in the DFS subtree of each one
     ArenaVector<BB *> *dfsBlocks_ = nullptr;
+    uint32_t *last_ = nullptr;
+    uint32_t *unionParents_ = nullptr;
+    // the loop headed by a block, if any
+    Loop **headedLoops_ = nullptr;
+
+    ArenaVector<Edge> *edges_ = nullptr;
+    // edges released once the block is visited
+    uint32_t *releasedEdges_ = nullptr;
+    // released edges into the blocks collapsed into a header
+    uint32_t *collapsedEdges_ = nullptr;
+    // range of predecessor numbers of the blocks collapsed into a header
+    uint32_t *minPredecessors_ = nullptr;
+    uint32_t *maxPredecessors_ = nullptr;
+
+    ArenaVector<uint32_t> *body_ = nullptr;
+    ArenaVector<uint32_t> *worklist_ = nullptr;
+    // the header a block was last added to the body of
+    uint32_t *bodyStamps_ = nullptr;
+    // the header a block was last recorded as a back edge source of
+    uint32_t *sourceStamps_ = nullptr;
     ArenaVector<Loop *> *loops_ = nullptr;
 };
 
@@ -0,0 +1,247 @@
+#include "tripCount.h"
+#include "instructions.h"
+
+namespace ir {
+namespace {
+// Values of the integer types are kept as signed 64-bit numbers, so u64
+// values above the maximum of i64 are not supported
+bool GetTypeRange(InstType type, size_t *width, int64_t *min, int64_t *max) {
+    bool isSigned = true;
+    switch (type) {
+    case InstType::i8:
+    case InstType::i16:
+    case InstType::i32:
+    case InstType::i64:
+        *width = 8U << (static_cast<size_t>(type) -
+                        static_cast<size_t>(InstType::i8));
+        break;
+    case InstType::u8:
+    case InstType::u16:
+    case InstType::u32:
+    case InstType::u64:
+        *width = 8U << (static_cast<size_t>(type) -
+                        static_cast<size_t>(InstType::u8));
+        isSigned = false;
+        break;
+    default:
+        return false;
+    }
+    if (isSigned) {
+        *max = static_cast<int64_t>((uint64_t{1} << (*width - 1)) - 1);
+        *min = -*max - 1;
+    } else {
+        *max = *width == 64
+                   ? INT64_MAX
+                   : static_cast<int64_t>((uint64_t{1} << *width) - 1);
+        *min = 0;
+    }
+    return true;
+}
+
+int64_t SignExtend(uint64_t raw, size_t width) {
+    auto shift = 64 - width;
+    return static_cast<int64_t>(raw << shift) >> shift;
+}
+
+bool GetConstValue(SingleInstruction *instr, InstType type, int64_t *value) {
+    assert((instr) && instr->IsConst());
+    size_t width = 0;
+    int64_t min = 0;
+    int64_t max = 0;
+    [[maybe_unused]] bool isInteger = GetTypeRange(type, &width, &min, &max);
+    assert(isInteger);
+    auto raw = static_cast<ConstInstr *>(instr)->GetValue();
+    if (min < 0) {
+        *value = SignExtend(raw, width);
+        return true;
+    }
+    if (width < 64) {
+        raw &= (uint64_t{1} << width) - 1;
+    }
+    *value = static_cast<int64_t>(raw);
+    return raw <= static_cast<uint64_t>(max);
+}
+
+// Compare with the operands swapped
+Conditions Mirror(Conditions cond) {
+    switch (cond) {
+    case Conditions::LSTHAN:
+        return Conditions::GRTHAN;
+    case Conditions::GRTHAN:
+        return Conditions::LSTHAN;
+    default:
+        return cond;
+    }
+}
+
+// The first j >= 0 such that value + j * step compared with the bound gives
+// exitValue, false if there is no such j before an overflow
+bool FindFirstExit(Conditions cond, bool exitValue, int64_t value,
+                   int64_t step, int64_t bound, uint64_t *result) {
+    assert(step != 0);
+    if (step == INT64_MIN) {
+        return false;
+    }
+    int64_t diff = 0;
+    switch (cond) {
+    case Conditions::EQ:
+    case Conditions::NONEQ:
+        if ((cond == Conditions::EQ) != exitValue) {
+            // leaves once the value is not the bound
+            *result = value != bound ? 0 : 1;
+            return true;
+        }
+        if (__builtin_sub_overflow(bound, value, &diff) || diff % step != 0 ||
+            diff / step < 0) {
+            return false;
+        }
+        *result = static_cast<uint64_t>(diff / step);
+        return true;
+    case Conditions::LSTHAN:
+    case Conditions::GRTHAN: {
+        bool isLess = cond == Conditions::LSTHAN;
+        // v >= b is v > b - 1 and v <= b is v < b + 1
+        if (!exitValue) {
+            isLess = !isLess;
+            if (__builtin_add_overflow(bound, isLess ? 1 : -1, &bound)) {
+                // always true
+                *result = 0;
+                return true;
+            }
+        }
+        if (isLess ? value < bound : value > bound) {
+            *result = 0;
+            return true;
+        }
+        if ((step > 0) == isLess) {
+            // the value moves away from the bound
+            return false;
+        }
+        if (__builtin_sub_overflow(value, bound, &diff)) {
+            return false;
+        }
+        // diff and step have the same sign
+        *result = static_cast<uint64_t>(diff / -step) + 1;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+} // namespace
+
+bool ComputeTripCount(Loop *loop, CountedLoop *result) {
+    assert((loop) && (result));
+    if (loop->IsRoot() || loop->IsIrreducible() ||
+        loop->GetBackEdges().size() != 1 ||
+        loop->GetExitEdges().size() != 1) {
+        return false;
+    }
+    auto *header = loop->GetHeader();
+    auto *latch = loop->GetBackEdges()[0];
+    auto [exiting, exit] = loop->GetExitEdges()[0];
+    // the test must be done on every iteration
+    if (!exiting->Domites(latch) || exiting->GetSuccessors().size() != 2) {
+        return false;
+    }
+    auto *jump = exiting->GetLastInstBB();
+    if (jump == nullptr || !jump->IsBranch() ||
+        jump->GetPrevInst() == nullptr ||
+        jump->GetPrevInst()->GetOpcode() != Opcode::CMP) {
+        return false;
+    }
+    auto *compare = static_cast<CompInstr *>(jump->GetPrevInst());
+    auto *value = compare->GetInput(0).GetInstruction();
+    auto *boundInstr = compare->GetInput(1).GetInstruction();
+    auto cond = compare->GetCondCode();
+    if (value->IsConst()) {
+        std::swap(value, boundInstr);
+        cond = Mirror(cond);
+    }
+    if (!boundInstr->IsConst()) {
+        return false;
+    }
+
+    // either the phi or its update is compared
+    PhiInstr *phi = nullptr;
+    if (value->IsPhi()) {
+        phi = static_cast<PhiInstr *>(value);
+    } else if (value->GetOpcode() == Opcode::ADDI) {
+        auto *input =
+            static_cast<BinaryRegInstr *>(value)->GetInput(0).GetInstruction();
+        if (input->IsPhi()) {
+            phi = static_cast<PhiInstr *>(input);
+        }
+    }
+    if (phi == nullptr || phi->GetInstBB() != header ||
+        phi->GetInputsCount() != 2) {
+        return false;
+    }
+    size_t latchIdx = phi->GetSourceBB(0) == latch ? 0 : 1;
+    if (phi->GetSourceBB(latchIdx) != latch ||
+        loop->Contains(phi->GetSourceBB(1 - latchIdx))) {
+        return false;
+    }
+    auto *update = phi->GetInput(latchIdx).GetInstruction();
+    auto *startInstr = phi->GetInput(1 - latchIdx).GetInstruction();
+    if (update->GetOpcode() != Opcode::ADDI ||
+        (value != phi && value != update) || !startInstr->IsConst()) {
+        return false;
+    }
+    // the immediate is kept as a constant input
+    auto *updateInstr = static_cast<BinaryRegInstr *>(update);
+    auto *stepInstr = updateInstr->GetInput(1).GetInstruction();
+    if (updateInstr->GetInput(0) != phi || !stepInstr->IsConst()) {
+        return false;
+    }
+
+    auto type = phi->GetType();
+    size_t width = 0;
+    int64_t min = 0;
+    int64_t max = 0;
+    if (update->GetType() != type ||
+        !GetTypeRange(type, &width, &min, &max)) {
+        return false;
+    }
+    auto step =
+        SignExtend(static_cast<ConstInstr *>(stepInstr)->GetValue(), width);
+    int64_t start = 0;
+    int64_t bound = 0;
+    if (step == 0 || !GetConstValue(startInstr, type, &start) ||
+        !GetConstValue(boundInstr, type, &bound)) {
+        return false;
+    }
+
+    // the update is compared with the values one step ahead
+    int64_t compared = start;
+    if (value == update && __builtin_add_overflow(start, step, &compared)) {
+        return false;
+    }
+    bool exitValue = exiting->GetSuccessors()[0] == exit;
+    uint64_t iteration = 0;
+    if (!FindFirstExit(cond, exitValue, compared, step, bound, &iteration)) {
+        return false;
+    }
+    // the values are monotonic, so they all fit the type if the last update
+    // does
+    int64_t last = 0;
+    if (iteration >= static_cast<uint64_t>(INT64_MAX) ||
+        __builtin_mul_overflow(static_cast<int64_t>(iteration + 1), step,
+                               &last) ||
+        __builtin_add_overflow(start, last, &last) || last < min ||
+        last > max) {
+        return false;
+    }
+
+    result->induction = phi;
+    result->update = updateInstr;
+    result->compare = compare;
+    result->exiting = exiting;
+    result->exit = exit;
+    result->start = start;
+    result->step = step;
+    result->bound = bound;
+    result->tripCount = iteration + 1;
+    return true;
+}
+} // namespace ir
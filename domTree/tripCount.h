@@ -0,0 +1,38 @@
+#ifndef JIT_AOT_COURSE_DOMTREE_TRIP_COUNT_H_
+#define JIT_AOT_COURSE_DOMTREE_TRIP_COUNT_H_
+
+#include "loop.h"
+#include <cstdint>
+
+namespace ir {
+class PhiInstr;
+class BinaryRegInstr;
+class CompInstr;
+
+// Loop counted by a phi of its header increased by a constant step on every
+// iteration. The only exit of the loop is taken by the compare of the phi or
+// of its update with a constant, in a block executed on every iteration.
+struct CountedLoop {
+    PhiInstr *induction = nullptr;
+    // ADDI of the induction phi, its input from the latch
+    BinaryRegInstr *update = nullptr;
+    // compare read by the conditional jump ending the exiting block
+    CompInstr *compare = nullptr;
+    BB *exiting = nullptr;
+    BB *exit = nullptr;
+    int64_t start = 0;
+    int64_t step = 0;
+    int64_t bound = 0;
+    // executions of the header, the last one leaves the loop at the exiting
+    // block. A loop testing its condition in the header runs its body one
+    // time less.
+    uint64_t tripCount = 0;
+};
+
+// Requires valid dominator and loop trees. Returns false if the loop is not
+// counted or the number of its iterations is not a compile-time constant,
+// e.g. when the induction variable would overflow its type first.
+bool ComputeTripCount(Loop *loop, CountedLoop *result);
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_DOMTREE_TRIP_COUNT_H_
@@ -1,16 +1,116 @@
 #include "compiler.h"
+#include "domTree/domTreeUpdater.h"
 #include "domTree/loop.h"
 #include "graphHelper.h"
+#include "optimizations/checkElimination.h"
+#include "optimizations/peepholes.h"
+#include "optimizations/staticInline.h"
 
 namespace ir {
-Graph *Compiler::CreateNewGraph(InstructionBuilder *instrBuilder) {
+Compiler::~Compiler() {
+    for (auto &entry : functions_) {
+        if (entry.graph != nullptr) {
+            destroyGraph(entry.graph);
+            entry.graph = nullptr;
+        }
+    }
+}
+
+Graph *Compiler::CreateNewGraph() {
+    auto allocator = acquireArena();
+    auto *instrBuilder =
+        allocator->template New<InstructionBuilder>(allocator.get());
     auto *graph =
-        allocator_.template New<Graph>(this, &allocator_, instrBuilder);
-    graph->SetId(functionsGraphs_.size());
-    functionsGraphs_.push_back(graph);
+        allocator->template New<Graph>(this, allocator.get(), instrBuilder);
+    registerGraph(graph);
+    arenaOwners_[allocator.get()] = graph->GetId();
+    functions_.back().allocator = std::move(allocator);
+    return graph;
+}
+
+Graph *Compiler::CreateNewGraph(InstructionBuilder *instrBuilder) {
+    assert(instrBuilder);
+    auto *allocator = instrBuilder->GetAllocator();
+    auto *graph = allocator->template New<Graph>(this, allocator, instrBuilder);
+    registerGraph(graph);
+    // the graph must be destroyed before the arena it lives in is recycled
+    auto it = arenaOwners_.find(allocator);
+    if (it != arenaOwners_.end()) {
+        functions_[it->second].dependents.push_back(graph->GetId());
+    }
     return graph;
 }
 
+bool Compiler::DeleteFunctionGraph(FunctionID functionId) {
+    if (functionId >= functions_.size() ||
+        functions_[functionId].graph == nullptr) {
+        return false;
+    }
+    auto &entry = functions_[functionId];
+    destroyGraph(entry.graph);
+    entry.graph = nullptr;
+    if (entry.allocator) {
+        for (auto dependentId : entry.dependents) {
+            auto &dependent = functions_[dependentId];
+            if (dependent.graph != nullptr) {
+                destroyGraph(dependent.graph);
+                dependent.graph = nullptr;
+            }
+        }
+        arenaOwners_.erase(entry.allocator.get());
+        releaseArena(std::move(entry.allocator));
+    }
+    entry.dependents.clear();
+    entry.dependents.shrink_to_fit();
+    return true;
+}
+
+Graph *Compiler::Optimize(Graph *graph) {
+    assert(graph);
+    PassManager passManager(graph);
+    passManager
+        .AddPass<StaticInline>(MAX_INLINED_CALLEE_INSTRS,
+                               MAX_INSTRS_AFTER_INLINING)
+        .AddPass<Peepholes>()
+        .AddPass<CheckElimination>();
+    passManager.Run();
+    optimizationStats_ = passManager.GetStats();
+    return graph;
+}
+
+Graph *Compiler::registerGraph(Graph *graph) {
+    assert(graph);
+    graph->SetId(functions_.size());
+    functions_.emplace_back();
+    functions_.back().graph = graph;
+    return graph;
+}
+
+std::unique_ptr<ArenaAllocator> Compiler::acquireArena() {
+    if (arenasPool_.empty()) {
+        return std::make_unique<ArenaAllocator>();
+    }
+    auto allocator = std::move(arenasPool_.back());
+    arenasPool_.pop_back();
+    return allocator;
+}
+
+void Compiler::releaseArena(std::unique_ptr<ArenaAllocator> allocator) {
+    assert(allocator);
+    if (arenasPool_.size() >= MAX_POOLED_ARENAS) {
+        // unmapped by the destructor
+        return;
+    }
+    allocator->Reset();
+    arenasPool_.push_back(std::move(allocator));
+}
+
+void Compiler::destroyGraph(Graph *graph) {
+    // memory itself is owned by the arena, but the graph keeps its own scratch
+    // arena which has to be unmapped
+    graph->~Graph();
+}
+
 // Depth first ordered graph copy algorithm implementation.
 Graph *Compiler::CopyGraph(Graph *source, InstructionBuilder *instrBuilder) {
     assert((source) && (instrBuilder));
@@ -55,12 +155,13 @@ std::pair<BB *, BB *> BB::SplitAfterInstruction(SingleInstruction *instr,
     assert(nextInstr);
 
     auto *graph = GetGraph();
+    // the edges are moved one by one, so the dominator tree is updated once
+    // they all are in place
+    bool isDomTreeValid =
+        graph->GetAnalyses().IsValid(AnalysisKind::DOM_TREE);
+    invalidateAnalyses();
     auto *newBBlock = graph->CreateEmptyBB();
 
-    if (connectAfterSplit) {
-        graph->ConnectBBs(this, newBBlock);
-    }
-
     if (GetLoop()) {
         GetLoop()->AddBB(newBBlock);
         newBBlock->SetLoop(GetLoop());
@@ -70,6 +171,11 @@ std::pair<BB *, BB *> BB::SplitAfterInstruction(SingleInstruction *instr,
         graph->ConnectBBs(newBBlock, succ);
     }
     successors_.clear();
+    // connected only now, so the new edge is not moved with the others
+    if (connectAfterSplit) {
+        graph->ConnectBBs(this, newBBlock);
+    }
+    invalidateAnalyses();
 
     instr->SetNextInst(nullptr);
     nextInstr->SetPrevInst(nullptr);
@@ -78,6 +184,8 @@ std::pair<BB *, BB *> BB::SplitAfterInstruction(SingleInstruction *instr,
         newBBlock->size_ += 1;
     }
     size_ -= newBBlock->size_;
+    // the moved instructions keep their increasing orders
+    newBBlock->isOrderValid_ = isOrderValid_;
 
     if (nextInstr->IsPhi()) {
         assert(instr->IsPhi());
@@ -94,6 +202,11 @@ std::pair<BB *, BB *> BB::SplitAfterInstruction(SingleInstruction *instr,
         lastInstBB_ = instr;
     }
 
+    // without the connection the new block is unreachable, see
+    // DomTreeUpdater::SpliceSubgraph
+    if (isDomTreeValid && connectAfterSplit) {
+        DomTreeUpdater(graph).SplitBlock(this, newBBlock);
+    }
     return {this, newBBlock};
 }
 } // namespace ir
\ No newline at end of file
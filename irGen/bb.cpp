@@ -1,4 +1,5 @@
 #include "bb.h"
+#include "graph.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
@@ -16,6 +17,7 @@ void BB::AddSuccessors(BB *bb) {
         std::abort();
     }
     successors_.push_back(bb);
+    invalidateAnalyses();
 }
 
 void BB::DeleteSuccessors(BB *bb) {
@@ -27,6 +29,7 @@ void BB::DeleteSuccessors(BB *bb) {
     auto it = std::find(successors_.begin(), successors_.end(), bb);
     if (it != successors_.end()) {
         successors_.erase(it);
+        invalidateAnalyses();
     } else {
         std::cout << "[BB Error] DeleteSuccessors." << std::endl;
         std::abort();
@@ -40,6 +43,7 @@ void BB::AddPredecessors(BB *bb) {
         std::abort();
     }
     predecessors_.push_back(bb);
+    invalidateAnalyses();
 }
 
 void BB::DeletePredecessors(BB *bb) {
@@ -52,6 +56,7 @@ void BB::DeletePredecessors(BB *bb) {
     if (it != predecessors_.end()) {
         *it = predecessors_.back();
         predecessors_.pop_back();
+        invalidateAnalyses();
     } else {
         std::cout << "[BB Error] DeletePredecessors." << std::endl;
         std::abort();
@@ -64,7 +69,23 @@ void BB::SetInstructionAsDead(SingleInstruction *inst) {
                   << std::endl;
         std::abort();
     }
-    inst->SetBB(nullptr); // unlink
+    UnlinkInstruction(inst);
+    if (graph_) {
+        graph_->AddDeadInstruction(inst);
+    }
+}
+
+void BB::KillInstruction(SingleInstruction *inst) {
+    assert((inst) && inst->GetInstBB() == this);
+    if (inst->HasInputs()) {
+        static_cast<InputsInstr *>(inst)->ClearInputs();
+    }
+    SetInstructionAsDead(inst);
+}
+
+void BB::UnlinkInstruction(SingleInstruction *inst) {
+    assert((inst) && inst->GetInstBB() == this);
+    inst->SetBB(nullptr);
     auto *tmpPrev = inst->GetPrevInst();
     auto *tmpNext = inst->GetNextInst();
     inst->SetPrevInst(nullptr);
@@ -113,6 +134,13 @@ void BB::ReplaceSuccessor(BB *prevSucc, BB *newSucc) {
     auto it = std::find(successors_.begin(), successors_.end(), prevSucc);
     assert(it != successors_.end());
     *it = newSucc;
+    invalidateAnalyses();
+}
+
+void BB::invalidateAnalyses(AnalysisSet analyses) {
+    if (graph_ != nullptr) {
+        graph_->InvalidateAnalyses(analyses);
+    }
 }
 
 void BB::ReplaceInControlFlow(SingleInstruction *prevInstr,
@@ -138,8 +166,8 @@ void BB::InsertSingleInstrBefore(SingleInstruction *instToMove,
                   << std::endl;
         std::abort();
     }
-    if (instToMove->GetInstBB() == nullptr ||
-        currentInstr->GetInstBB() == nullptr) {
+    // the inserted instruction may come from outside of any block
+    if (instToMove->GetInstBB() == nullptr) {
         std::cout
             << "[BB Error] One of BB went nullptr (InsertSingleInstrBefore)"
             << std::endl;
@@ -154,10 +182,11 @@ void BB::InsertSingleInstrBefore(SingleInstruction *instToMove,
         tmpPrev->SetNextInst(currentInstr);
     }
 
-    if (!tmpPrev) {
+    if (instToMove == firstInstBB_) {
         firstInstBB_ = currentInstr;
     }
     size_ += 1;
+    assignOrder(currentInstr);
 }
 
 void BB::InsertSingleInstrAfter(SingleInstruction *instToInsert,
@@ -168,8 +197,7 @@ void BB::InsertSingleInstrAfter(SingleInstruction *instToInsert,
                   << std::endl;
         std::abort();
     }
-    if (instToInsert->GetInstBB() == nullptr ||
-        currentInstr->GetInstBB() == nullptr) {
+    if (instToInsert->GetInstBB() == nullptr) {
         std::cout
             << "[BB Error] One of BB went nullptr (InsertSingleInstrAfter)"
             << std::endl;
@@ -180,12 +208,15 @@ void BB::InsertSingleInstrAfter(SingleInstruction *instToInsert,
     instToInsert->SetNextInst(currentInstr);
     currentInstr->SetPrevInst(instToInsert);
     currentInstr->SetNextInst(tmpNext);
-    tmpNext->SetPrevInst(currentInstr);
+    if (tmpNext) {
+        tmpNext->SetPrevInst(currentInstr);
+    }
 
     if (!tmpNext) {
         lastInstBB_ = currentInstr;
     }
     size_ += 1;
+    assignOrder(currentInstr);
 }
 
 template <bool PushBack> void BB::PushInstruction(SingleInstruction *instr) {
@@ -214,6 +245,7 @@ template <bool PushBack> void BB::PushInstruction(SingleInstruction *instr) {
         }
     }
     size_ += 1;
+    assignOrder(instr);
 }
 
 void BB::PushInstForward(SingleInstruction *instr) {
@@ -242,6 +274,54 @@ void BB::PushPhi(SingleInstruction *instr) {
     }
 }
 
+void BB::assignOrder(SingleInstruction *instr) {
+    assert((instr) && instr->GetInstBB() == this);
+    if (!isOrderValid_) {
+        return;
+    }
+    auto *prev = instr->GetPrevInst();
+    auto *next = instr->GetNextInst();
+    if (prev == nullptr && next == nullptr) {
+        instr->SetOrder(0);
+    } else if (prev == nullptr) {
+        instr->SetOrder(next->GetOrder() - INSTR_ORDER_STEP);
+    } else if (next == nullptr) {
+        instr->SetOrder(prev->GetOrder() + INSTR_ORDER_STEP);
+    } else if (next->GetOrder() - prev->GetOrder() > 1) {
+        instr->SetOrder(prev->GetOrder() +
+                        (next->GetOrder() - prev->GetOrder()) / 2);
+    } else {
+        isOrderValid_ = false;
+    }
+}
+
+void BB::UpdateInstructionsOrder() {
+    if (isOrderValid_) {
+        return;
+    }
+    int64_t order = 0;
+    for (auto *instr : *this) {
+        instr->SetOrder(order);
+        order += INSTR_ORDER_STEP;
+    }
+    isOrderValid_ = true;
+}
+
+void BB::RemoveDominatedBlock(BB *bblock) {
+    auto it = std::find(dominated_.begin(), dominated_.end(), bblock);
+    assert(it != dominated_.end());
+    dominated_.erase(it);
+    invalidateAnalyses({AnalysisKind::DOM_TREE});
+}
+
+void BB::ResetDomTreeLinks() {
+    dominator_ = nullptr;
+    dominated_.clear();
+    domTreeEnter_ = 0;
+    domTreeExit_ = 0;
+    domTreeDepth_ = 0;
+}
+
 bool BB::Domites(const BB *bblock) const {
     if (bblock == nullptr) {
         std::cout << "[BB Error] in Domites" << std::endl;
@@ -251,6 +331,12 @@ bool BB::Domites(const BB *bblock) const {
     if (bblock == this) {
         return true;
     }
+    if (graph_ != nullptr && graph_->IsDomTreeNumbered()) {
+        return domTreeEnter_ <= bblock->domTreeEnter_ &&
+               bblock->domTreeExit_ <= domTreeExit_ &&
+               bblock->domTreeEnter_ != 0;
+    }
+    // stale numbering, fall back to walking the dominators chain
     auto *dom = bblock->GetDominator();
     while (dom != nullptr) {
         if (dom == this) {
@@ -261,6 +347,18 @@ bool BB::Domites(const BB *bblock) const {
     return false;
 }
 
+bool BB::PostDominates(const BB *bblock) const {
+    assert(bblock);
+    assert(graph_ &&
+           graph_->GetAnalyses().IsValid(AnalysisKind::POST_DOM_TREE));
+    if (bblock == this) {
+        return true;
+    }
+    return postDomTreeEnter_ <= bblock->postDomTreeEnter_ &&
+           bblock->postDomTreeExit_ <= postDomTreeExit_ &&
+           bblock->postDomTreeEnter_ != 0;
+}
+
 void BB::PrintSSA() {
     std::cout << "Basic Block ID: " << GetId() << std::endl;
 
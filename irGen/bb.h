@@ -25,6 +25,7 @@
 #ifndef JIT_AOT_COURSE_IR_GEN_BB_H_
 #define JIT_AOT_COURSE_IR_GEN_BB_H_
 
+#include "domTree/analysisManager.h"
 #include "domTree/arena.h"
 #include "instructions.h"
 #include "singleInstruction.h"
@@ -72,6 +73,15 @@ class BB : public Markable {
         return dominated_;
     }
     bool Domites(const BB *bblock) const;
+    // Immediate post-dominator, null for the last block and for blocks not
+    // reaching it
+    BB *GetPostDominator() { return postDominator_; }
+    const BB *GetPostDominator() const { return postDominator_; }
+    memory::ArenaVector<BB *> &GetPostDominatedBBs() { return postDominated_; }
+    const memory::ArenaVector<BB *> &GetPostDominatedBBs() const {
+        return postDominated_;
+    }
+    bool PostDominates(const BB *bblock) const;
     Loop *GetLoop() { return loop_; }
     const Loop *GetLoop() const { return loop_; }
 
@@ -88,6 +98,13 @@ class BB : public Markable {
                                 SingleInstruction *currentInstr);
     void SetGraph(Graph *newGraph) { graph_ = newGraph; }
     void SetInstructionAsDead(SingleInstruction *inst);
+    // Clears the inputs, so that the instruction leaves the users lists of
+    // its inputs, and marks it as dead. The instruction may be accessed until
+    // the next pass starts, then it is recycled.
+    void KillInstruction(SingleInstruction *inst);
+    // Unlinks the instruction keeping its inputs and users, so that it can be
+    // pushed into another place
+    void UnlinkInstruction(SingleInstruction *inst);
     void ReplaceInstruction(SingleInstruction *prevInstr,
                             SingleInstruction *newInstr);
     void ReplaceInDataFlow(SingleInstruction *prevInstr,
@@ -95,6 +112,13 @@ class BB : public Markable {
     void ReplaceSuccessor(BB *prevSucc, BB *newSucc);
     size_t GetSize() const { return size_; }
 
+    // Instructions are numbered sparsely, so insertions mostly take an order
+    // from the gap between their neighbours. Once a gap is exhausted, the
+    // whole block is renumbered on the next query.
+    static constexpr int64_t INSTR_ORDER_STEP = 1024;
+    bool IsInstructionsOrderValid() const { return isOrderValid_; }
+    void UpdateInstructionsOrder();
+
     std::pair<BB *, BB *> SplitAfterInstruction(SingleInstruction *instr,
                                                 bool connectAfterSplit);
 
@@ -153,14 +177,58 @@ class BB : public Markable {
     void PushInstBackward(SingleInstruction *instr);
 
     void PushPhi(SingleInstruction *instr);
-    void SetDominator(BB *newIDom) { dominator_ = newIDom; }
-    void AddDominatedBlock(BB *bblock) { dominated_.push_back(bblock); }
+    void SetDominator(BB *newIDom) {
+        dominator_ = newIDom;
+        invalidateAnalyses({AnalysisKind::DOM_TREE});
+    }
+    void AddDominatedBlock(BB *bblock) {
+        dominated_.push_back(bblock);
+        invalidateAnalyses({AnalysisKind::DOM_TREE});
+    }
+    // Entry and exit indices of the block in a DFS over the dominator tree
+    size_t GetDomTreeEnter() const { return domTreeEnter_; }
+    size_t GetDomTreeExit() const { return domTreeExit_; }
+    void SetDomTreeInterval(size_t enter, size_t exit) {
+        domTreeEnter_ = enter;
+        domTreeExit_ = exit;
+    }
+    // Number of dominators of the block, kept up to date by the incremental
+    // updates unlike the intervals
+    size_t GetDomTreeDepth() const { return domTreeDepth_; }
+    void SetDomTreeDepth(size_t depth) { domTreeDepth_ = depth; }
+    void RemoveDominatedBlock(BB *bblock);
+    // Drops the links of the block in the dominator tree, e.g. when it is
+    // moved to another graph
+    void ResetDomTreeLinks();
+
+    void SetPostDominator(BB *newIPDom) {
+        postDominator_ = newIPDom;
+        invalidateAnalyses({AnalysisKind::POST_DOM_TREE});
+    }
+    void AddPostDominatedBlock(BB *bblock) {
+        postDominated_.push_back(bblock);
+        invalidateAnalyses({AnalysisKind::POST_DOM_TREE});
+    }
+    // Same as for the dominator tree, but the post-dominator tree is always
+    // numbered while it is valid
+    size_t GetPostDomTreeEnter() const { return postDomTreeEnter_; }
+    size_t GetPostDomTreeExit() const { return postDomTreeExit_; }
+    void SetPostDomTreeInterval(size_t enter, size_t exit) {
+        postDomTreeEnter_ = enter;
+        postDomTreeExit_ = exit;
+    }
+    size_t GetPostDomTreeDepth() const { return postDomTreeDepth_; }
+    void SetPostDomTreeDepth(size_t depth) { postDomTreeDepth_ = depth; }
     void SetLoop(Loop *newLoop) { loop_ = newLoop; }
     void PrintSSA();
 
     void ReplaceInControlFlow(SingleInstruction *prevInstr,
                               SingleInstruction *newInstr);
 
+  private:
+    void assignOrder(SingleInstruction *instr);
+    void invalidateAnalyses(AnalysisSet analyses = AnalysisSet::All());
+
   public:
     // STL compatible iterator
     template <typename T, bool OnlyPhi = false> class Iterator {
@@ -218,6 +286,15 @@ class BB : public Markable {
     Loop *loop_ = nullptr;
     Graph *graph_ = nullptr;
     memory::ArenaVector<BB *> dominated_;
+    size_t domTreeEnter_ = 0;
+    size_t domTreeExit_ = 0;
+    size_t domTreeDepth_ = 0;
+    BB *postDominator_ = nullptr;
+    memory::ArenaVector<BB *> postDominated_;
+    size_t postDomTreeEnter_ = 0;
+    size_t postDomTreeExit_ = 0;
+    size_t postDomTreeDepth_ = 0;
+    bool isOrderValid_ = true;
 };
 
 static_assert(std::input_or_output_iterator<BB::Iterator<SingleInstruction *>>);
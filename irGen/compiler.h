@@ -4,41 +4,70 @@
 #include "base.h"
 #include "domTree/arena.h"
 #include "helperBuilderFunctions.h"
+#include "optimizations/passManager.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace ir {
 using namespace memory;
 
+// Every function graph created from scratch owns an arena, which also keeps
+// the graph's InstructionBuilder and the graphs copied with that builder
+// (e.g. callee copies made for inlining). Deleting the owner returns the arena
+// into a pool reused by the following compilations.
 class Compiler : public CompilerBase {
   public:
-    Compiler() : allocator_(), functionsGraphs_(allocator_.ToSTL()) {}
+    Compiler() = default;
+    ~Compiler() override;
 
-    Graph *CreateNewGraph() override {
-        auto *instrBuilder =
-            allocator_.template New<InstructionBuilder>(&allocator_);
-        return CreateNewGraph(instrBuilder);
-    }
+    Graph *CreateNewGraph() override;
+    // Creates a graph sharing the arena of the builder
     Graph *CreateNewGraph(InstructionBuilder *instrBuilder);
     Graph *CopyGraph(Graph *source, InstructionBuilder *instrBuilder) override;
-    Graph *Optimize(Graph *graph) override { return graph; }
+    // Runs the default pipeline: inlining, peepholes and checks elimination
+    Graph *Optimize(Graph *graph) override;
+    // Statistics of the passes run by the last Optimize call
+    const std::vector<PassStats> &GetOptimizationStats() const {
+        return optimizationStats_;
+    }
     Graph *GetFunction(FunctionID functionId) override {
-        if (functionId >= functionsGraphs_.size()) {
+        if (functionId >= functions_.size()) {
             return nullptr;
         }
-        return functionsGraphs_[functionId];
+        return functions_[functionId].graph;
     }
 
-    bool DeleteFunctionGraph(FunctionID functionId) override {
-        if (functionId >= functionsGraphs_.size()) {
-            return false;
-        }
-        functionsGraphs_.erase(functionsGraphs_.begin() + functionId);
-        return true;
-    }
+    bool DeleteFunctionGraph(FunctionID functionId) override;
+
+    size_t GetPooledArenasCount() const { return arenasPool_.size(); }
+
+    static constexpr size_t MAX_POOLED_ARENAS = 16;
+    static constexpr size_t MAX_INLINED_CALLEE_INSTRS = 25;
+    static constexpr size_t MAX_INSTRS_AFTER_INLINING = 500;
+
+  private:
+    struct FunctionEntry {
+        Graph *graph = nullptr;
+        // set only for graphs owning their arena
+        std::unique_ptr<ArenaAllocator> allocator;
+        // graphs allocated in the owned arena
+        std::vector<FunctionID> dependents;
+    };
+
+    Graph *registerGraph(Graph *graph);
+    std::unique_ptr<ArenaAllocator> acquireArena();
+    void releaseArena(std::unique_ptr<ArenaAllocator> allocator);
+    static void destroyGraph(Graph *graph);
 
   private:
-    memory::ArenaAllocator allocator_;
-    ArenaVector<Graph *> functionsGraphs_;
+    // function ids are never reused, so the bookkeeping lives outside arenas
+    // to be freed as the functions are deleted
+    std::vector<FunctionEntry> functions_;
+    std::unordered_map<ArenaAllocator *, FunctionID> arenaOwners_;
+    std::vector<std::unique_ptr<ArenaAllocator>> arenasPool_;
+    std::vector<PassStats> optimizationStats_;
 };
 
 };     // namespace ir
-#endif // JIT_AOT_COURSE_IR_GEN_COMPILER
\ No newline at end of file
+#endif // JIT_AOT_COURSE_IR_GEN_COMPILER
@@ -1,4 +1,6 @@
 #include "graph.h"
+#include "domTree/domTreeUpdater.h"
+#include "helperBuilderFunctions.h"
 #include <algorithm>
 #include <cstdlib>
 
@@ -11,7 +13,14 @@ size_t Graph::CountInstructions() {
 }
 
 BB *Graph::CreateEmptyBB(bool isTerminal) {
-    auto *bblock = allocator_->template New<BB>(this);
+    BB *bblock = nullptr;
+    if (freeBBs_.empty()) {
+        bblock = allocator_->template NewWithTag<BB>(ArenaTag::BASIC_BLOCKS,
+                                                     this);
+    } else {
+        bblock = new (freeBBs_.back()) BB(this);
+        freeBBs_.pop_back();
+    }
     AddBB(bblock);
     if (isTerminal) {
         if (!GetLastBB()) {
@@ -24,8 +33,23 @@ BB *Graph::CreateEmptyBB(bool isTerminal) {
 
 void Graph::ConnectBBs(BB *lhs, BB *rhs) {
     assert((lhs) && (rhs));
+    // the dominator tree is updated rather than dropped by the edit
+    bool isDomTreeValid = analyses_.IsValid(AnalysisKind::DOM_TREE);
     lhs->AddSuccessors(rhs);
     rhs->AddPredecessors(lhs);
+    if (isDomTreeValid) {
+        DomTreeUpdater(this).InsertEdge(lhs, rhs);
+    }
+}
+
+void Graph::DisconnectBBs(BB *lhs, BB *rhs) {
+    assert((lhs) && (rhs));
+    bool isDomTreeValid = analyses_.IsValid(AnalysisKind::DOM_TREE);
+    lhs->DeleteSuccessors(rhs);
+    rhs->DeletePredecessors(lhs);
+    if (isDomTreeValid) {
+        DomTreeUpdater(this).DeleteEdge(lhs, rhs);
+    }
 }
 
 void Graph::AddBB(BB *bb) {
@@ -35,7 +59,12 @@ void Graph::AddBB(BB *bb) {
     }
     bb->SetId(BBs_.size()); // because it was the last one
     BBs_.push_back(bb);
+    ++addedBBsCount_;
     bb->SetGraph(this);
+    // the block is unreachable until it is connected to the graph's blocks,
+    // so the dominator tree stays valid
+    bb->ResetDomTreeLinks();
+    InvalidateAnalyses(~AnalysisSet{AnalysisKind::DOM_TREE});
 }
 
 // AddBBAsPredecessor -> AddBBBefore
@@ -51,6 +80,7 @@ void Graph::AddBBBefore(BB *bb_before, BB *bb) {
         std::abort();
     }
     bb->SetGraph(this);
+    InvalidateAnalyses();
 
     // add of the same part as succ
     for (auto *b : bb_before->GetPredecessors()) {
@@ -79,9 +109,116 @@ void Graph::SetBBAsDeadImpl(BB *bblock) {
     auto id = bblock->GetId();
     assert(id < BBs_.size() && BBs_[id] == bblock);
     BBs_[id] = nullptr;
+    InvalidateAnalyses();
     bblock->SetId(ir::INVALID_BB_ID);
     bblock->SetGraph(nullptr);
     ++deadInstrCounter_;
+    deadBBs_.push_back(bblock);
+}
+
+void Graph::AddDeadInstruction(SingleInstruction *instr) {
+    assert((instr) && instr->GetInstBB() == nullptr);
+    deadInstrs_.push_back(instr);
+    ++killedInstrsCount_;
+}
+
+template <typename T> static void SortAndUnique(ArenaVector<T *> &vector) {
+    std::sort(vector.begin(), vector.end());
+    vector.erase(std::unique(vector.begin(), vector.end()), vector.end());
+}
+
+template <typename T>
+static bool Contains(const ArenaVector<T *> &sorted, const T *value) {
+    return std::binary_search(sorted.begin(), sorted.end(), value);
+}
+
+void Graph::RecycleDeadNodes() {
+    if (deadInstrs_.empty() && deadBBs_.empty()) {
+        return;
+    }
+    assert(instrBuilder_->GetAllocator() == allocator_);
+    memory::ArenaScope scope(GetScratchAllocator());
+
+    // an instruction could have been killed several times or moved back
+    // into a block
+    std::erase_if(deadInstrs_, [](SingleInstruction *instr) {
+        return instr->GetInstBB() != nullptr;
+    });
+    SortAndUnique(deadInstrs_);
+    SortAndUnique(deadBBs_);
+
+    // dead nodes still referenced by the alive IR are kept
+    auto *keptInstrs =
+        GetScratchAllocator()->template NewVector<SingleInstruction *>();
+    auto *keptBBs = GetScratchAllocator()->template NewVector<BB *>();
+    auto keepBB = [this, keptBBs](BB *bblock) {
+        if (bblock != nullptr && Contains(deadBBs_, bblock)) {
+            keptBBs->push_back(bblock);
+        }
+    };
+    ForEachBB([this, keptInstrs, &keepBB](BB *bblock) {
+        std::ranges::for_each(bblock->GetPredecessors(), keepBB);
+        std::ranges::for_each(bblock->GetSuccessors(), keepBB);
+        std::ranges::for_each(bblock->GetDominatedBBs(), keepBB);
+        keepBB(bblock->GetDominator());
+        std::ranges::for_each(bblock->GetPostDominatedBBs(), keepBB);
+        keepBB(bblock->GetPostDominator());
+        for (auto *instr : *bblock) {
+            if (instr->IsPhi()) {
+                std::ranges::for_each(
+                    static_cast<PhiInstr *>(instr)->GetSourceBBs(), keepBB);
+            }
+            auto *withInputs = dynamic_cast<InputsInstr *>(instr);
+            if (withInputs == nullptr) {
+                continue;
+            }
+            for (size_t i = 0, end = withInputs->GetInputsCount(); i < end;
+                 ++i) {
+                auto *input = withInputs->GetInput(i).GetInstruction();
+                if (input != nullptr && Contains(deadInstrs_, input)) {
+                    keptInstrs->push_back(input);
+                }
+            }
+        }
+    });
+    SortAndUnique(*keptInstrs);
+    SortAndUnique(*keptBBs);
+
+    auto *recycledInstrs =
+        GetScratchAllocator()->template NewVector<SingleInstruction *>();
+    std::ranges::set_difference(deadInstrs_, *keptInstrs,
+                                std::back_inserter(*recycledInstrs));
+    deadInstrs_.assign(keptInstrs->begin(), keptInstrs->end());
+
+    // unlink the recycled instructions from their inputs, then drop the uses
+    // of them left in the kept dead instructions
+    for (auto *instr : *recycledInstrs) {
+        if (auto *withInputs = dynamic_cast<InputsInstr *>(instr)) {
+            withInputs->ClearInputs();
+        }
+    }
+    for (auto *instr : *recycledInstrs) {
+        while (auto *use = instr->GetFirstUse()) {
+            use->SetInstruction(nullptr);
+        }
+    }
+    for (auto *instr : *recycledInstrs) {
+        instrBuilder_->RecycleInstruction(instr);
+    }
+
+    // blocks keeping instructions or belonging to a loop are never recycled,
+    // as these would still refer to them
+    std::erase_if(deadBBs_, [this, keptBBs](BB *bblock) {
+        if (Contains(*keptBBs, bblock)) {
+            return false;
+        }
+        if (bblock->IsEmpty() && bblock->GetLoop() == nullptr &&
+            bblock->HasNoPredecessors() && bblock->HasNoSuccessors()) {
+            bblock->~BB();
+            freeBBs_.push_back(bblock);
+        }
+        return true;
+    });
 }
 
 bool BB::IsFirstInGraph() { return GetGraph()->GetFirstBB() == this; }
@@ -131,8 +268,12 @@ void Graph::PrintSSA() {
 }
 
 BB::BB(Graph *graph)
-    : bbId_(INVALID_BB_ID), predecessors_(graph->GetAllocator()->ToSTL()),
-      successors_(graph->GetAllocator()->ToSTL()), graph_(graph),
-      dominated_(graph->GetAllocator()->ToSTL()) {}
+    : bbId_(INVALID_BB_ID),
+      predecessors_(graph->GetAllocator()->ToSTL(ArenaTag::CFG_EDGES)),
+      successors_(graph->GetAllocator()->ToSTL(ArenaTag::CFG_EDGES)),
+      graph_(graph),
+      dominated_(graph->GetAllocator()->ToSTL(ArenaTag::DOMINATED_BBS)),
+      postDominated_(graph->GetAllocator()->ToSTL(ArenaTag::DOMINATED_BBS)) {
+}
 
 } // namespace ir
@@ -15,6 +15,7 @@
 #define JIT_AOT_COURSE_IR_GEN_GRAPH_H_
 
 #include "bb.h"
+#include "domTree/analysisManager.h"
 #include "domTree/arena.h"
 #include "helperBuilderFunctions.h"
 #include "marker.h"
@@ -35,7 +36,9 @@ class Graph : public MarkerManager {
           InstructionBuilder *instrBuilder)
         : compiler_(compiler), allocator_(allocator), firstBB_(nullptr),
           lastBB_(nullptr), BBs_(allocator_->ToSTL()), loopTreeRoot_(nullptr),
-          instrBuilder_(instrBuilder) {
+          instrBuilder_(instrBuilder), deadInstrs_(allocator_->ToSTL()),
+          deadBBs_(allocator_->ToSTL()), freeBBs_(allocator_->ToSTL()),
+          analyses_(this, allocator_) {
         assert(compiler_);
         assert(allocator_);
         assert(instrBuilder_);
@@ -55,21 +58,50 @@ class Graph : public MarkerManager {
   public:
     BB *GetFirstBB() { return firstBB_; }
     BB *GetLastBB() { return lastBB_; }
-    void SetFirstBB(BB *bb) { firstBB_ = bb; }
-    void SetLastBB(BB *bb) { lastBB_ = bb; }
+    void SetFirstBB(BB *bb) {
+        if (firstBB_ != bb) {
+            firstBB_ = bb;
+            InvalidateAnalyses();
+        }
+    }
+    void SetLastBB(BB *bb) {
+        if (lastBB_ != bb) {
+            lastBB_ = bb;
+            InvalidateAnalyses({AnalysisKind::POST_DOM_TREE});
+        }
+    }
     ArenaVector<BB *> GetBBs() { return BBs_; }
     Loop *GetLoopTree() { return loopTreeRoot_; }
     const Loop *GetLoopTree() const { return loopTreeRoot_; }
     ArenaAllocator *GetAllocator() const { return allocator_; }
+    // Allocator for analyses' transient data, IR must not be allocated here
+    ArenaAllocator *GetScratchAllocator() { return &scratchAllocator_; }
+    void ResetScratchAllocator() { scratchAllocator_.Reset(); }
     InstructionBuilder *GetInstructionBuilder() { return instrBuilder_; }
 
+    AnalysisManager &GetAnalyses() { return analyses_; }
+    // Blocks keep DFS intervals of the dominator tree, which are valid only
+    // until the CFG or the dominator tree is changed
+    bool IsDomTreeNumbered() const { return analyses_.IsDomTreeNumbered(); }
+    void InvalidateAnalyses(AnalysisSet analyses = AnalysisSet::All()) {
+        analyses_.Invalidate(analyses);
+    }
+
   public:
     void AddBB(BB *bb);
     void SetBBAsDeadImpl(BB *bblock);
+    // The dead block may be accessed until the next pass starts, then it is
+    // recycled
     void SetBBAsDead(BB *bb);
     void AddBBBefore(BB *newBB, BB *bb);
     void SetLoopTree(Loop *loop) { loopTreeRoot_ = loop; }
     void CleanupUnusedBlocks();
+    void AddDeadInstruction(SingleInstruction *instr);
+    // Returns memory of dead instructions and empty blocks, which are not
+    // referenced by the IR anymore, to the free lists. Pointers to dead nodes
+    // are invalidated, so it is called between passes, by
+    // OptimizationPassBase::Apply.
+    void RecycleDeadNodes();
     void DeletePredecessors(BB *bb);
     void DeleteSuccessors(BB *bb);
     void UpdPhiInst();
@@ -85,10 +117,19 @@ class Graph : public MarkerManager {
     size_t CountInstructions();
 
     BB *CreateEmptyBB(bool isTerminal = false);
+    // Both keep a valid dominator tree valid
     void ConnectBBs(BB *lhs, BB *rhs);
+    void DisconnectBBs(BB *lhs, BB *rhs);
     size_t GetBBCount() const { return BBs_.size() - deadInstrCounter_; }
+    // Ids of the alive blocks are below it, dense per-block tables use it
+    size_t GetBBIdsBound() const { return BBs_.size(); }
     bool IsEmpty() const { return GetBBCount() == 0; }
 
+    // Monotonic counters of IR changes, passes are measured by their deltas
+    size_t GetAddedBBsCount() const { return addedBBsCount_; }
+    size_t GetDeadBBsCount() const { return deadInstrCounter_; }
+    size_t GetKilledInstructionsCount() const { return killedInstrsCount_; }
+
   private:
     size_t id_ = ir::INVALID_BB_ID;
     CompilerBase *compiler_;
@@ -97,8 +138,17 @@ class Graph : public MarkerManager {
     BB *lastBB_;
     memory::ArenaVector<BB *> BBs_;
     size_t deadInstrCounter_ = 0;
+    size_t addedBBsCount_ = 0;
+    size_t killedInstrsCount_ = 0;
     Loop *loopTreeRoot_;
     InstructionBuilder *instrBuilder_;
+    // nodes waiting for RecycleDeadNodes
+    ArenaVector<SingleInstruction *> deadInstrs_;
+    ArenaVector<BB *> deadBBs_;
+    // memory of recycled blocks
+    ArenaVector<void *> freeBBs_;
+    ArenaAllocator scratchAllocator_;
+    AnalysisManager analyses_;
 };
 } // namespace ir
 
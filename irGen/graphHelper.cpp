@@ -4,17 +4,23 @@
 namespace ir {
 Graph *GraphCopyHelper::CreateCopy(Graph *copyTarget) {
     assert((copyTarget) && copyTarget->IsEmpty());
+    // translation tables are needed only while copying
+    memory::ArenaScope scope(copyTarget->GetScratchAllocator());
+    memory::ArenaTagScope tagScope(copyTarget->GetScratchAllocator(),
+                                   memory::ArenaTag::COPY_MAPS);
     Reset(copyTarget);
     DfoCopy(source_->GetFirstBB());
     assert(target_->GetBBCount() == source_->GetBBCount());
     FixDFG();
+    instrsTranslation_ = nullptr;
+    visited_ = nullptr;
     return target_;
 }
 
 void GraphCopyHelper::Reset(Graph *copyTarget) {
     assert(copyTarget);
     target_ = copyTarget;
-    auto *allocator = copyTarget->GetAllocator();
+    auto *allocator = copyTarget->GetScratchAllocator();
     instrsTranslation_ =
         allocator->NewUnorderedMap<size_t, SingleInstruction *>();
     visited_ = allocator->NewUnorderedMap<size_t, BB *>();
@@ -51,25 +57,24 @@ void GraphCopyHelper::FixDFG() {
         std::for_each(
             bblock->begin(), bblock->end(),
             [translation](SingleInstruction *instr) {
-                // set correct inputs
-                if (instr->HasInputs()) {
-                    auto *withInputs = static_cast<InputsInstr *>(instr);
-                    for (size_t i = 0, end = withInputs->GetInputsCount();
-                         i < end; ++i) {
-                        auto &input = withInputs->GetInput(i);
-                        withInputs->SetInput(
-                            translation->at(input->GetInstID()), i);
-                    }
+                // relinking the inputs to the copies also sets their users
+                auto *withInputs = dynamic_cast<InputsInstr *>(instr);
+                if (withInputs == nullptr) {
+                    return;
                 }
-
-                // set correct users
-                memory::ArenaVector<SingleInstruction *> newUsers(
-                    translation->get_allocator());
-                newUsers.reserve(instr->UsersCount());
-                for (auto *user : instr->GetUsers()) {
-                    newUsers.push_back(translation->at(user->GetInstID()));
+                for (size_t i = 0, end = withInputs->GetInputsCount(); i < end;
+                     ++i) {
+                    auto &input = withInputs->GetInput(i);
+                    if (input.GetInstruction() == nullptr) {
+                        continue;
+                    }
+                    // instructions placed out of blocks, e.g. immediates,
+                    // are not copied and stay shared
+                    auto it = translation->find(input->GetInstID());
+                    if (it != translation->end()) {
+                        withInputs->SetInput(it->second, i);
+                    }
                 }
-                instr->SetNewUsers(std::move(newUsers));
             });
     });
 }
@@ -4,6 +4,7 @@
 #include "domTree/arena.h"
 #include "graph.h"
 #include "instructions.h"
+#include <array>
 #include <cstdint>
 #include <type_traits>
 #include <vector>
@@ -16,24 +17,56 @@ class InstructionBuilder {
 
   private:
     ArenaAllocator *const allocator_;
-    ArenaVector<SingleInstruction *> instructions_;
-    static constexpr uint8_t ARITHM = static_cast<uint8_t>(InstrProp::ARITH) ||
+    // ids are given in the order of building, the memory of the recycled
+    // instructions is tracked by the free lists only
+    size_t builtInstrsCount_ = 0;
+    static constexpr uint8_t ARITHM = static_cast<uint8_t>(InstrProp::ARITH) |
                                       static_cast<uint8_t>(InstrProp::INPUT);
     static constexpr uint8_t SIDE_EFFECTS_ARITHM =
-        static_cast<uint8_t>(InstrProp::ARITH) ||
-        static_cast<uint8_t>(InstrProp::INPUT) ||
+        static_cast<uint8_t>(InstrProp::ARITH) |
+        static_cast<uint8_t>(InstrProp::INPUT) |
         static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
     static constexpr uint8_t INPUT_MEM =
-        static_cast<uint8_t>(InstrProp::INPUT) ||
-        static_cast<uint8_t>(InstrProp::MEM) ||
+        static_cast<uint8_t>(InstrProp::INPUT) |
+        static_cast<uint8_t>(InstrProp::MEM) |
         static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
     static constexpr uint8_t INPUT_SIDE_EFFECTS =
-        static_cast<uint8_t>(InstrProp::INPUT) ||
+        static_cast<uint8_t>(InstrProp::INPUT) |
         static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
 
+    // Recycled instructions are kept in free lists by their sizes, the link
+    // to the next free node is placed into the recycled memory itself
+    struct FreeNode {
+        FreeNode *next;
+    };
+    static constexpr size_t FREE_LISTS_COUNT = 64;
+    std::array<FreeNode *, FREE_LISTS_COUNT> freeLists_{};
+    size_t freeInstrsCount_ = 0;
+
+    static constexpr size_t GetSizeClass(size_t size) {
+        return memory::AlignUp(size, memory::DEFAULT_ALIGNMENT) /
+               memory::DEFAULT_ALIGNMENT;
+    }
+
+    template <typename T, typename... ArgsT> T *newInstr(ArgsT &&...args) {
+        static_assert(std::is_base_of_v<SingleInstruction, T>);
+        // recycled memory is reused regardless of the original type
+        static_assert(alignof(T) <= memory::DEFAULT_ALIGNMENT);
+        constexpr auto sizeClass = GetSizeClass(sizeof(T));
+        if constexpr (sizeClass < FREE_LISTS_COUNT) {
+            if (auto *node = freeLists_[sizeClass]) {
+                freeLists_[sizeClass] = node->next;
+                --freeInstrsCount_;
+                return new (node) T(std::forward<ArgsT>(args)...);
+            }
+        }
+        return allocator_->template NewWithTag<T>(
+            memory::ArenaTag::INSTRUCTIONS, std::forward<ArgsT>(args)...);
+    }
+
   public:
     explicit InstructionBuilder(ArenaAllocator *const allocator)
-        : allocator_(allocator), instructions_(allocator_->ToSTL()) {
+        : allocator_(allocator) {
         assert(allocator_);
     }
     InstructionBuilder(const InstructionBuilder &) = delete;
@@ -51,86 +84,88 @@ class InstructionBuilder {
     }
 
     void AttachInstruction(SingleInstruction *inst) {
-        assert(inst);
-        assert(std::find(instructions_.begin(), instructions_.end(), inst) ==
-               instructions_.end());
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        assert((inst) && inst->GetInstID() == SingleInstruction::INVALID_ID);
+        inst->SetInstId(++builtInstrsCount_);
     }
 
-    SingleInstruction *GetLastInst() {
-        return instructions_[instructions_.size() - 1];
+    ArenaAllocator *GetAllocator() const { return allocator_; }
+    // Instructions built or attached so far, recycled ones included
+    size_t GetBuiltInstructionsCount() const { return builtInstrsCount_; }
+
+    // Takes memory of a dead instruction, which must not be referenced by
+    // the IR anymore, to reuse it in the following Build* calls
+    void RecycleInstruction(SingleInstruction *instr) {
+        assert((instr) && instr->GetInstBB() == nullptr);
+        assert(instr->UsersCount() == 0);
+        auto sizeClass = GetSizeClass(instr->GetObjectSize());
+        if (sizeClass >= FREE_LISTS_COUNT) {
+            return;
+        }
+        instr->~SingleInstruction();
+        auto *node = new (instr) FreeNode{freeLists_[sizeClass]};
+        freeLists_[sizeClass] = node;
+        ++freeInstrsCount_;
     }
 
+    size_t GetFreeInstructionsCount() const { return freeInstrsCount_; }
+
   public:
     template <typename T> ConstInstr *BuildConst(InstType type, T imm) {
-        auto *inst = allocator_->template New<ConstInstr>(Opcode::CONST, type,
-                                                          imm, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<ConstInstr>(Opcode::CONST, type, imm, allocator_);
+        AttachInstruction(inst);
         return inst;
     }
 
     CastInstr *BuildCast(InstType fromType, InstType targetType, Input input) {
-        auto *inst = allocator_->template New<CastInstr>(fromType, targetType,
-                                                         input, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<CastInstr>(
+            fromType, targetType, input, allocator_);
+        AttachInstruction(inst);
         inst->SetProperty(InstrProp::INPUT);
         return inst;
     }
 
     CompInstr *BuildCmp(InstType type, Conditions conditions, Input input1,
                         Input input2) {
-        auto *inst = allocator_->template New<CompInstr>(
+        auto *inst = newInstr<CompInstr>(
             Opcode::CMP, type, conditions, input1, input2, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        auto prop = static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
-        inst->SetProperty(prop);
+        AttachInstruction(inst);
+        // sets the flags read by the following conditional jump
+        inst->SetProperty(INPUT_SIDE_EFFECTS);
         return inst;
     }
 
     JumpInstr *BuildJmp() {
-        auto *inst =
-            allocator_->template New<JumpInstr>(Opcode::JMP, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<JumpInstr>(Opcode::JMP, allocator_);
+        AttachInstruction(inst);
         inst->SetProperty(InstrProp::JUMP);
         return inst;
     }
 
     CondJumpInstr *BuildJcmp() {
-        auto *inst = allocator_->template New<CondJumpInstr>(allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<CondJumpInstr>(allocator_);
+        AttachInstruction(inst);
         return inst;
     }
 
     RetInstr *BuildRet(InstType type, Input input) {
-        auto *inst =
-            allocator_->template New<RetInstr>(type, input, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        auto prop = static_cast<uint8_t>(InstrProp::JUMP) ||
-                    static_cast<uint8_t>(InstrProp::INPUT) ||
+        auto *inst = newInstr<RetInstr>(type, input, allocator_);
+        AttachInstruction(inst);
+        auto prop = static_cast<uint8_t>(InstrProp::JUMP) |
+                    static_cast<uint8_t>(InstrProp::INPUT) |
                     static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
         inst->SetProperty(prop);
         return inst;
     }
 
     RetVoidInstr *BuildRetVoid() {
-        auto *inst = allocator_->template New<RetVoidInstr>(allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<RetVoidInstr>(allocator_);
+        AttachInstruction(inst);
         return inst;
     }
 
     CallInstr *BuildCall(InstType type, FunctionID target) {
-        auto *inst =
-            allocator_->template New<CallInstr>(type, target, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<CallInstr>(type, target, allocator_);
+        AttachInstruction(inst);
         auto prop = static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
         inst->SetProperty(prop);
         return inst;
@@ -139,147 +174,126 @@ class InstructionBuilder {
     template <typename Ins>
     CallInstr *BuildCall(InstType type, FunctionID target,
                          std::initializer_list<Ins> args) {
-        auto *inst =
-            allocator_->template New<CallInstr>(type, target, args, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        auto prop = static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
-        inst->SetProperty(prop);
+        auto *inst = newInstr<CallInstr>(type, target, args, allocator_);
+        AttachInstruction(inst);
+        inst->SetProperty(INPUT_SIDE_EFFECTS);
         return inst;
     }
 
     template <typename Ins, typename AllocatorT>
     CallInstr *BuildCall(InstType type, FunctionID target,
                          std::vector<Ins, AllocatorT> args) {
-        auto *inst =
-            allocator_->template New<CallInstr>(type, target, args, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        auto prop = static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
-        inst->SetProperty(prop);
+        auto *inst = newInstr<CallInstr>(type, target, args, allocator_);
+        AttachInstruction(inst);
+        inst->SetProperty(INPUT_SIDE_EFFECTS);
         return inst;
     }
 
     LengthInstr *BuildLen(Input array) {
-        auto *inst = allocator_->template New<LengthInstr>(array, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        inst->SetProperty(INPUT_MEM);
+        auto *inst = newInstr<LengthInstr>(array, allocator_);
+        AttachInstruction(inst);
+        // lengths of arrays never change and null arrays are ruled out by
+        // explicit checks, so reading a length has no side effects
+        inst->SetProperty(InstrProp::INPUT | InstrProp::MEM);
         return inst;
     }
 
     NewArrayInstr *BuildNewArray(Input length, TypeId typeId) {
-        auto *inst =
-            allocator_->template New<NewArrayInstr>(length, typeId, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        auto prop = static_cast<uint8_t>(InstrProp::MEM) ||
+        auto *inst = newInstr<NewArrayInstr>(length, typeId, allocator_);
+        AttachInstruction(inst);
+        auto prop = static_cast<uint8_t>(InstrProp::INPUT) |
+                    static_cast<uint8_t>(InstrProp::MEM) |
                     static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
         inst->SetProperty(prop);
         return inst;
     }
 
     NewArrayImmInstr *BuildNewArrayImm(uint64_t length, TypeId typeId) {
-        auto *inst = allocator_->template New<NewArrayImmInstr>(length, typeId,
-                                                                allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        auto prop = static_cast<uint8_t>(InstrProp::MEM) ||
+        auto *inst = newInstr<NewArrayImmInstr>(length, typeId, allocator_);
+        AttachInstruction(inst);
+        auto prop = static_cast<uint8_t>(InstrProp::MEM) |
                     static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
         inst->SetProperty(prop);
         return inst;
     }
 
     NewObjectInstr *BuildNewObject(TypeId typeId) {
-        auto *inst =
-            allocator_->template New<NewObjectInstr>(typeId, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
-        auto prop = static_cast<uint8_t>(InstrProp::MEM) ||
+        auto *inst = newInstr<NewObjectInstr>(typeId, allocator_);
+        AttachInstruction(inst);
+        auto prop = static_cast<uint8_t>(InstrProp::MEM) |
                     static_cast<uint8_t>(InstrProp::SIDE_EFFECTS);
         inst->SetProperty(prop);
         return inst;
     }
 
     LoadArrayInstr *BuildLoadArray(InstType type, Input array, Input idx) {
-        auto *inst = allocator_->template New<LoadArrayInstr>(type, array, idx,
-                                                              allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<LoadArrayInstr>(type, array, idx, allocator_);
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_MEM);
         return inst;
     }
 
     LoadImmInstr *BuildLoadArrayImm(InstType type, Input array, uint64_t idx) {
-        auto *inst = allocator_->template New<LoadImmInstr>(
+        auto *inst = newInstr<LoadImmInstr>(
             Opcode::LOAD_ARRAY_IMM, type, array, idx, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_MEM);
         return inst;
     }
 
     LoadImmInstr *BuildLoadObject(InstType type, Input obj, uint64_t offset) {
-        auto *inst = allocator_->template New<LoadImmInstr>(
+        auto *inst = newInstr<LoadImmInstr>(
             Opcode::LOAD_OBJECT, type, obj, offset, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_MEM);
         return inst;
     }
 
     StoreArrayInstr *BuildStoreArray(Input array, Input storedValue,
                                      Input idx) {
-        auto *inst = allocator_->template New<StoreArrayInstr>(
+        auto *inst = newInstr<StoreArrayInstr>(
             array, storedValue, idx, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_MEM);
         return inst;
     }
 
     StoreImmInstr *BuildStoreArrayImm(Input array, Input storedValue,
                                       uint64_t idx) {
-        auto *inst = allocator_->template New<StoreImmInstr>(
+        auto *inst = newInstr<StoreImmInstr>(
             Opcode::STORE_ARRAY_IMM, array, storedValue, idx, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_MEM);
         return inst;
     }
 
     StoreImmInstr *BuildStoreObject(Input obj, Input storedValue,
                                     uint64_t offset) {
-        auto *inst = allocator_->template New<StoreImmInstr>(
+        auto *inst = newInstr<StoreImmInstr>(
             Opcode::STORE_OBJECT, obj, storedValue, offset, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_MEM);
         return inst;
     }
 
     UnaryRegInstr *BuildNullCheck(Input input) {
-        auto *inst = allocator_->template New<UnaryRegInstr>(
+        auto *inst = newInstr<UnaryRegInstr>(
             Opcode::NULL_CHECK, InstType::INVALID, input, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_SIDE_EFFECTS);
         return inst;
     }
 
     BoundsCheckInstr *BuildBoundsCheck(Input arr, Input idx) {
-        auto *inst =
-            allocator_->template New<BoundsCheckInstr>(arr, idx, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<BoundsCheckInstr>(arr, idx, allocator_);
+        AttachInstruction(inst);
         inst->SetProperty(INPUT_SIDE_EFFECTS);
         return inst;
     }
 
     PhiInstr *BuildPhi(InstType type) {
-        auto *inst = allocator_->template New<PhiInstr>(type, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<PhiInstr>(type, allocator_);
+        AttachInstruction(inst);
         inst->SetProperty(InstrProp::INPUT);
         return inst;
     }
@@ -287,66 +301,57 @@ class InstructionBuilder {
     template <typename Ins, typename Sources>
     PhiInstr *BuildPhi(InstType type, std::initializer_list<Ins> inputs,
                        std::initializer_list<Sources> sources) {
-        auto *inst = allocator_->template New<PhiInstr>(type, inputs, sources,
-                                                        allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<PhiInstr>(type, inputs, sources, allocator_);
+        AttachInstruction(inst);
         inst->SetProperty(InstrProp::INPUT);
         return inst;
     }
 
     template <typename Ins, typename Sources>
     PhiInstr *BuildPhi(InstType type, Ins inputs, Sources sources) {
-        auto *inst = allocator_->template New<PhiInstr>(type, inputs, sources,
-                                                        allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<PhiInstr>(type, inputs, sources, allocator_);
+        AttachInstruction(inst);
         inst->SetProperty(InstrProp::INPUT);
         return inst;
     }
 
     InputArgInstr *BuildArg(InstType type) {
-        auto *inst = allocator_->template New<InputArgInstr>(type, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        auto *inst = newInstr<InputArgInstr>(type, allocator_);
+        AttachInstruction(inst);
         return inst;
     }
 
     BinaryRegInstr *BuildShr(InstType type, Input input1, Input input2) {
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::SHR, type, input1, input2, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(ARITHM);
         return inst;
     }
 
     BinaryRegInstr *BuildXor(InstType type, Input input1, Input input2) {
         auto prop = ARITHM | static_cast<uint8_t>(InstrProp::COMMUTABLE);
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::XOR, type, input1, input2, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(prop);
         return inst;
     }
 
     BinaryRegInstr *BuildMul(InstType type, Input input1, Input input2) {
         auto prop = ARITHM | static_cast<uint8_t>(InstrProp::COMMUTABLE);
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::MUL, type, input1, input2, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(prop);
         return inst;
     }
 
     BinaryRegInstr *BuildAdd(InstType type, Input input1, Input input2) {
         auto prop = ARITHM | static_cast<uint8_t>(InstrProp::COMMUTABLE);
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::ADD, type, input1, input2, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(prop);
         return inst;
     }
@@ -354,13 +359,12 @@ class InstructionBuilder {
     template <typename T>
     BinaryRegInstr *BuildAddi(InstType type, Input input, T immediate) {
         auto prop = ARITHM | static_cast<uint8_t>(InstrProp::COMMUTABLE);
-        auto *constInstr = new ConstInstr(
+        auto *constInstr = newInstr<ConstInstr>(
             Opcode::CONST, type, static_cast<uint64_t>(immediate), allocator_);
         Input immInput = Input(constInstr);
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::ADDI, type, input, immInput, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(prop);
         return inst;
     }
@@ -368,39 +372,36 @@ class InstructionBuilder {
     template <typename T>
     BinaryRegInstr *BuildMuli(InstType type, Input input, T immediate) {
         auto prop = ARITHM | static_cast<uint8_t>(InstrProp::COMMUTABLE);
-        auto *constInstr = new ConstInstr(
+        auto *constInstr = newInstr<ConstInstr>(
             Opcode::CONST, type, static_cast<uint64_t>(immediate), allocator_);
         Input immInput = Input(constInstr);
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::MULI, type, input, immInput, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(prop);
         return inst;
     }
 
     template <typename T>
     BinaryRegInstr *BuildXori(InstType type, Input input, T immediate) {
-        auto *constInstr = new ConstInstr(
+        auto *constInstr = newInstr<ConstInstr>(
             Opcode::CONST, type, static_cast<uint64_t>(immediate), allocator_);
         Input immInput = Input(constInstr);
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::XORI, type, input, immInput, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(ARITHM);
         return inst;
     }
 
     template <typename T>
     BinaryRegInstr *BuildShri(InstType type, Input input, T immediate) {
-        auto *constInstr = new ConstInstr(
+        auto *constInstr = newInstr<ConstInstr>(
             Opcode::CONST, type, static_cast<uint64_t>(immediate), allocator_);
         Input immInput = Input(constInstr);
-        auto *inst = allocator_->template New<BinaryRegInstr>(
+        auto *inst = newInstr<BinaryRegInstr>(
             Opcode::SHRI, type, input, immInput, allocator_);
-        instructions_.push_back(inst);
-        inst->SetInstId(instructions_.size());
+        AttachInstruction(inst);
         inst->SetProperty(ARITHM);
         return inst;
     }
@@ -5,25 +5,49 @@ namespace ir {
 
 class SingleInstruction;
 
+// Operand of an instruction. Inputs owned by an instruction are linked into
+// the intrusive users list of the instruction they refer to, so adding,
+// removing and replacing a use does not allocate and takes O(1). Copies
+// refer to the same instruction, but are not owned and not linked.
 class Input {
   public:
-    Input() : instr_(nullptr) {}
+    Input() = default;
     Input(SingleInstruction *instr) : instr_(instr) {}
-    Input(const Input &) = default;
-    Input &operator=(const Input &) = default;
-    Input(Input &&) = default;
-    Input &operator=(Input &&) = default;
-    ~Input() = default;
+    Input(const Input &other) : instr_(other.instr_) {}
+    // assignment keeps the owner and relinks the use
+    Input &operator=(const Input &other) {
+        SetInstruction(other.instr_);
+        return *this;
+    }
+    ~Input() {
+        if (user_ != nullptr && instr_ != nullptr) {
+            unlink();
+        }
+    }
 
   public:
     SingleInstruction *GetInstruction() { return instr_; }
     const SingleInstruction *GetInstruction() const { return instr_; }
-    void SetInstruction(SingleInstruction *newInstr) { instr_ = newInstr; }
+    inline void SetInstruction(SingleInstruction *newInstr);
     SingleInstruction *operator->() { return instr_; }
     const SingleInstruction *operator->() const { return instr_; }
 
+    // Instruction owning this input, nullptr for copies
+    SingleInstruction *GetUser() const { return user_; }
+    inline void SetUser(SingleInstruction *user);
+    Input *GetNextUse() const { return nextUse_; }
+
+  private:
+    inline void link();
+    inline void unlink();
+
   private:
-    SingleInstruction *instr_;
+    SingleInstruction *instr_ = nullptr;
+    SingleInstruction *user_ = nullptr;
+    Input *nextUse_ = nullptr;
+    // points either to the previous use's link or to the list head, so the
+    // use can be unlinked without walking the list
+    Input **prevUse_ = nullptr;
 };
 
 inline bool operator==(const Input &lhs, const Input &rhs) {
@@ -38,4 +62,4 @@ inline bool operator==(const Input &lhs, const SingleInstruction *rhs) {
 
 } // namespace ir
 
-#endif // JIT_AOT_COURSE_IR_GEN_INPUT
\ No newline at end of file
+#endif // JIT_AOT_COURSE_IR_GEN_INPUT
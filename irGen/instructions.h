@@ -31,6 +31,7 @@
 #include "domTree/arena.h"
 #include "input.h"
 #include "singleInstruction.h"
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
@@ -41,6 +42,7 @@
 namespace ir {
 class BB;
 using memory::ArenaAllocator;
+using memory::ArenaTag;
 
 enum class Conditions { EQ, NONEQ, LSTHAN, GRTHAN };
 
@@ -54,22 +56,31 @@ class InputsInstr : public SingleInstruction {
     virtual Input &GetInput(size_t idx) = 0;
     virtual void SetInput(Input newInput, size_t idx) = 0;
     virtual void ReplaceInput(const Input &oldInput, Input newInput) = 0;
+
+    // Drops all the uses, e.g. of an instruction being removed
+    void ClearInputs() {
+        for (size_t i = 0, end = GetInputsCount(); i < end; ++i) {
+            GetInput(i).SetInstruction(nullptr);
+        }
+    }
 };
 
 template <int InputsNum> class ConstInputsInst : public InputsInstr {
   public:
     ConstInputsInst(Opcode opcode, InstType type,
                     ArenaAllocator *const allocator)
-        : InputsInstr(opcode, type, allocator) {}
+        : InputsInstr(opcode, type, allocator) {
+        for (auto &it : inputs_) {
+            it.SetUser(this);
+        }
+    }
 
     template <typename... T>
     ConstInputsInst(Opcode opcode, InstType type,
                     ArenaAllocator *const allocator, T... inputs)
         : InputsInstr(opcode, type, allocator), inputs_{inputs...} {
         for (auto &it : inputs_) {
-            if (it.GetInstruction()) {
-                it->AddUser(this);
-            }
+            it.SetUser(this);
         }
     }
 
@@ -81,9 +92,6 @@ template <int InputsNum> class ConstInputsInst : public InputsInstr {
     Input &GetInput(size_t idx) override { return inputs_.at(idx); }
     void SetInput(Input newInput, size_t idx) override {
         inputs_.at(idx) = newInput;
-        if (newInput.GetInstruction()) {
-            newInput->AddUser(this);
-        }
     }
 
     void ReplaceInput(const Input &oldInput, Input newInput) override {
@@ -102,13 +110,13 @@ template <> class ConstInputsInst<1> : public InputsInstr {
   public:
     ConstInputsInst(Opcode opcode, InstType type,
                     ArenaAllocator *const allocator)
-        : InputsInstr(opcode, type, allocator) {}
+        : InputsInstr(opcode, type, allocator) {
+        input_.SetUser(this);
+    }
     ConstInputsInst(Opcode opcode, InstType type, Input input,
                     ArenaAllocator *const allocator)
         : InputsInstr(opcode, type, allocator), input_(input) {
-        if (input_.GetInstruction()) {
-            input_->AddUser(this);
-        }
+        input_.SetUser(this);
     }
 
     size_t GetInputsCount() const override { return 1; }
@@ -121,9 +129,6 @@ template <> class ConstInputsInst<1> : public InputsInstr {
             std::abort();
         }
         input_ = newInput;
-        if (input_.GetInstruction()) {
-            input_->AddUser(this);
-        }
     }
     void ReplaceInput(const Input &oldInput, Input newInput) override {
         assert(input_ == oldInput);
@@ -138,17 +143,17 @@ class VarInputsInstr : public InputsInstr {
   public:
     VarInputsInstr(Opcode opcode, InstType type,
                    ArenaAllocator *const allocator)
-        : InputsInstr(opcode, type, allocator), inputs_(allocator->ToSTL()) {}
+        : InputsInstr(opcode, type, allocator),
+          inputs_(allocator->ToSTL(ArenaTag::INPUTS)) {}
 
     template <typename Ins>
     VarInputsInstr(Opcode opcode, InstType type, Ins ins,
                    ArenaAllocator *const allocator)
         : InputsInstr(opcode, type, allocator),
-          inputs_(ins.begin(), ins.end(), allocator->ToSTL()) {
+          inputs_(ins.begin(), ins.end(),
+                  allocator->ToSTL(ArenaTag::INPUTS)) {
         for (auto &it : inputs_) {
-            if (it.GetInstruction()) {
-                it->AddUser(this);
-            }
+            it.SetUser(this);
         }
     }
 
@@ -156,11 +161,10 @@ class VarInputsInstr : public InputsInstr {
     VarInputsInstr(Opcode opcode, InstType type, std::initializer_list<Ins> ins,
                    ArenaAllocator *const allocator)
         : InputsInstr(opcode, type, allocator),
-          inputs_(ins.begin(), ins.end(), allocator->ToSTL()) {
+          inputs_(ins.begin(), ins.end(),
+                  allocator->ToSTL(ArenaTag::INPUTS)) {
         for (auto &it : inputs_) {
-            if (it.GetInstruction()) {
-                it->AddUser(this);
-            }
+            it.SetUser(this);
         }
     }
 
@@ -169,11 +173,10 @@ class VarInputsInstr : public InputsInstr {
                    std::vector<Ins, AllocatorT> ins,
                    ArenaAllocator *const allocator)
         : InputsInstr(opcode, type, allocator),
-          inputs_(ins.begin(), ins.end(), allocator->ToSTL()) {
+          inputs_(ins.begin(), ins.end(),
+                  allocator->ToSTL(ArenaTag::INPUTS)) {
         for (auto &it : inputs_) {
-            if (it.GetInstruction()) {
-                it->AddUser(this);
-            }
+            it.SetUser(this);
         }
     }
 
@@ -184,9 +187,6 @@ class VarInputsInstr : public InputsInstr {
     Input &GetInput(size_t idx) override { return inputs_.at(idx); }
     void SetInput(Input newInput, size_t idx) override {
         inputs_.at(idx) = newInput;
-        if (newInput.GetInstruction()) {
-            newInput->AddUser(this);
-        }
     }
 
     void ReplaceInput(const Input &oldInput, Input newInput) override {
@@ -197,10 +197,15 @@ class VarInputsInstr : public InputsInstr {
 
     memory::ArenaVector<Input> &GetInputs() { return inputs_; }
     void AddInput(Input newInput) {
-        inputs_.push_back(newInput);
-        if (newInput.GetInstruction()) {
-            newInput->AddUser(this);
+        if (inputs_.size() == inputs_.capacity()) {
+            // reallocated inputs are copies, which must be linked again
+            inputs_.reserve(std::max<size_t>(1, 2 * inputs_.size()));
+            for (auto &it : inputs_) {
+                it.SetUser(this);
+            }
         }
+        inputs_.push_back(newInput);
+        inputs_.back().SetUser(this);
     }
 
   protected:
@@ -251,6 +256,7 @@ class ConstInstr : public SingleInstruction, public DestIsImm<uint64_t> {
         : SingleInstruction(opcode, type, allocator), DestIsImm<uint64_t>(
                                                           value) {}
     ConstInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(ConstInstr); }
 };
 
 class UnaryRegInstr : public ConstInputsInst<1> {
@@ -259,6 +265,7 @@ class UnaryRegInstr : public ConstInputsInst<1> {
                   ArenaAllocator *const allocator)
         : ConstInputsInst(opcode, type, input, allocator) {}
     UnaryRegInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(UnaryRegInstr); }
 };
 
 class BinaryRegInstr : public ConstInputsInst<2> {
@@ -267,6 +274,7 @@ class BinaryRegInstr : public ConstInputsInst<2> {
                    ArenaAllocator *const allocator)
         : ConstInputsInst(opcode, type, allocator, input1, input2) {}
     BinaryRegInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(BinaryRegInstr); }
 };
 
 class BinaryImmInstr : public ConstInputsInst<1>, public DestIsImm<uint64_t> {
@@ -276,6 +284,7 @@ class BinaryImmInstr : public ConstInputsInst<1>, public DestIsImm<uint64_t> {
         : ConstInputsInst(opcode, type, input, allocator), DestIsImm<uint64_t>(
                                                                imm) {}
     BinaryImmInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(BinaryImmInstr); }
 };
 
 class CompInstr : public ConstInputsInst<2>, public DestCondition {
@@ -285,6 +294,7 @@ class CompInstr : public ConstInputsInst<2>, public DestCondition {
         : ConstInputsInst(opcode, type, allocator, in1, in2),
           DestCondition(ccode) {}
     CompInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(CompInstr); }
 };
 
 class CastInstr : public ConstInputsInst<1> {
@@ -297,6 +307,7 @@ class CastInstr : public ConstInputsInst<1> {
     auto GetTargetType() const { return toType_; }
     void SetTargetType(InstType newType) { toType_ = newType; }
     CastInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(CastInstr); }
 
   private:
     InstType toType_;
@@ -308,6 +319,7 @@ class JumpInstr : public SingleInstruction {
         : SingleInstruction(opcode, InstType::i64, allocator, INVALID_ID,
                             static_cast<uint8_t>(InstrProp::JUMP)) {}
     JumpInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(JumpInstr); }
     BB *GetDestination();
 };
 
@@ -315,7 +327,7 @@ class CondJumpInstr : public SingleInstruction {
   public:
     CondJumpInstr(ArenaAllocator *const allocator)
         : SingleInstruction(Opcode::JCMP, InstType::i64, allocator, INVALID_ID,
-                            static_cast<uint8_t>(InstrProp::JUMP) ||
+                            static_cast<uint8_t>(InstrProp::JUMP) |
                                 static_cast<uint8_t>(InstrProp::SIDE_EFFECTS)) {
     }
 
@@ -323,6 +335,7 @@ class CondJumpInstr : public SingleInstruction {
 
     BB *GetFalseDestination();
     CondJumpInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(CondJumpInstr); }
 
   private:
     template <int CmpRes> BB *GetBranchDestinationImpl();
@@ -333,6 +346,7 @@ class RetInstr : public ConstInputsInst<1> {
     RetInstr(InstType type, Input input, ArenaAllocator *const allocator)
         : ConstInputsInst<1>(Opcode::RET, type, input, allocator) {}
     RetInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(RetInstr); }
 };
 
 class RetVoidInstr : public SingleInstruction {
@@ -340,23 +354,25 @@ class RetVoidInstr : public SingleInstruction {
     RetVoidInstr(ArenaAllocator *const allocator)
         : SingleInstruction(Opcode::RETVOID, InstType::VOID, allocator,
                             INVALID_ID,
-                            static_cast<uint8_t>(InstrProp::JUMP) ||
+                            static_cast<uint8_t>(InstrProp::JUMP) |
                                 static_cast<uint8_t>(InstrProp::SIDE_EFFECTS)) {
     }
     RetVoidInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(RetVoidInstr); }
 };
 
 class PhiInstr : public VarInputsInstr {
   public:
     PhiInstr(InstType type, ArenaAllocator *const allocator)
         : VarInputsInstr(Opcode::PHI, type, allocator),
-          sourceBBs_(allocator->ToSTL()) {}
+          sourceBBs_(allocator->ToSTL(ArenaTag::PHI_SOURCES)) {}
 
     template <typename Ins, typename Sources>
     PhiInstr(InstType type, Ins input, Sources sources,
              ArenaAllocator *const allocator)
         : VarInputsInstr(Opcode::PHI, type, input, allocator),
-          sourceBBs_(sources.cbegin(), sources.cend(), allocator->ToSTL()) {
+          sourceBBs_(sources.cbegin(), sources.cend(),
+                     allocator->ToSTL(ArenaTag::PHI_SOURCES)) {
         assert(inputs_.size() == sourceBBs_.size());
     }
 
@@ -365,7 +381,8 @@ class PhiInstr : public VarInputsInstr {
              std::initializer_list<Sources> sources,
              ArenaAllocator *const allocator)
         : VarInputsInstr(Opcode::PHI, type, input, allocator),
-          sourceBBs_(sources.begin(), sources.end(), allocator->ToSTL()) {
+          sourceBBs_(sources.begin(), sources.end(),
+                     allocator->ToSTL(ArenaTag::PHI_SOURCES)) {
         assert(inputs_.size() == sourceBBs_.size());
     }
 
@@ -385,6 +402,7 @@ class PhiInstr : public VarInputsInstr {
     }
 
     PhiInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(PhiInstr); }
 
   private:
     memory::ArenaVector<BB *> sourceBBs_;
@@ -395,6 +413,7 @@ class InputArgInstr : public SingleInstruction {
     explicit InputArgInstr(InstType type, ArenaAllocator *const allocator)
         : SingleInstruction(Opcode::ARG, type, allocator) {}
     InputArgInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(InputArgInstr); }
 };
 
 class CallInstr : public VarInputsInstr {
@@ -416,10 +435,11 @@ class CallInstr : public VarInputsInstr {
     void SetIsInlined(bool inlined) { isInlined_ = inlined; }
 
     CallInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(CallInstr); }
 
   private:
     FunctionID callTarget_;
-    bool isInlined_;
+    bool isInlined_ = false;
 };
 
 class LengthInstr : public UnaryRegInstr {
@@ -430,6 +450,7 @@ class LengthInstr : public UnaryRegInstr {
     }
 
     LengthInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(LengthInstr); }
 };
 
 class NewArrayInstr : public ConstInputsInst<1>, public DestTypeId {
@@ -442,6 +463,7 @@ class NewArrayInstr : public ConstInputsInst<1>, public DestTypeId {
     }
 
     NewArrayInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(NewArrayInstr); }
 };
 
 class NewArrayImmInstr : public SingleInstruction,
@@ -456,6 +478,7 @@ class NewArrayImmInstr : public SingleInstruction,
     }
 
     NewArrayImmInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(NewArrayImmInstr); }
 };
 
 class NewObjectInstr : public SingleInstruction, public DestTypeId {
@@ -465,6 +488,7 @@ class NewObjectInstr : public SingleInstruction, public DestTypeId {
           DestTypeId(typeId) {}
 
     NewObjectInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(NewObjectInstr); }
 };
 
 class LoadArrayInstr : public BinaryRegInstr {
@@ -477,6 +501,7 @@ class LoadArrayInstr : public BinaryRegInstr {
     }
 
     LoadArrayInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(LoadArrayInstr); }
 };
 
 class LoadImmInstr : public BinaryImmInstr {
@@ -490,6 +515,7 @@ class LoadImmInstr : public BinaryImmInstr {
     }
 
     LoadImmInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(LoadImmInstr); }
 };
 
 class StoreArrayInstr : public ConstInputsInst<3> {
@@ -503,6 +529,7 @@ class StoreArrayInstr : public ConstInputsInst<3> {
     }
 
     StoreArrayInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(StoreArrayInstr); }
 };
 
 class StoreImmInstr : public ConstInputsInst<2>, public DestIsImm<uint64_t> {
@@ -518,6 +545,7 @@ class StoreImmInstr : public ConstInputsInst<2>, public DestIsImm<uint64_t> {
     }
 
     StoreImmInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(StoreImmInstr); }
 };
 
 class BoundsCheckInstr : public ConstInputsInst<2> {
@@ -530,6 +558,7 @@ class BoundsCheckInstr : public ConstInputsInst<2> {
     }
 
     BoundsCheckInstr *Copy(BB *targetBBlock) override;
+    size_t GetObjectSize() const override { return sizeof(BoundsCheckInstr); }
 };
 
 // ------------------------------------------------------------------------------------------
@@ -4,7 +4,8 @@ namespace ir {
 
 BinaryImmInstr *BinaryImmInstr::Copy(BB *targetBBlock) {
     auto *allocator = targetBBlock->GetGraph()->GetAllocator();
-    auto *instr = allocator->template New<BinaryImmInstr>(
+    auto *instr = allocator->template NewWithTag<BinaryImmInstr>(
+        memory::ArenaTag::INSTRUCTIONS,
         GetOpcode(), GetType(), GetInput(0), GetValue(), allocator);
     targetBBlock->GetGraph()->GetInstructionBuilder()->AttachInstruction(instr);
     instr->SetProperty(GetProperties());
@@ -13,7 +14,8 @@ BinaryImmInstr *BinaryImmInstr::Copy(BB *targetBBlock) {
 
 BinaryRegInstr *BinaryRegInstr::Copy(BB *targetBBlock) {
     auto *allocator = targetBBlock->GetGraph()->GetAllocator();
-    auto *instr = allocator->template New<BinaryRegInstr>(
+    auto *instr = allocator->template NewWithTag<BinaryRegInstr>(
+        memory::ArenaTag::INSTRUCTIONS,
         GetOpcode(), GetType(), GetInput(0), GetInput(1), allocator);
     targetBBlock->GetGraph()->GetInstructionBuilder()->AttachInstruction(instr);
     instr->SetProperty(GetProperties());
@@ -22,7 +24,8 @@ BinaryRegInstr *BinaryRegInstr::Copy(BB *targetBBlock) {
 
 UnaryRegInstr *UnaryRegInstr::Copy(BB *targetBBlock) {
     auto *allocator = targetBBlock->GetGraph()->GetAllocator();
-    auto *instr = allocator->template New<UnaryRegInstr>(
+    auto *instr = allocator->template NewWithTag<UnaryRegInstr>(
+        memory::ArenaTag::INSTRUCTIONS,
         GetOpcode(), GetType(), GetInput(0), allocator);
     targetBBlock->GetGraph()->GetInstructionBuilder()->AttachInstruction(instr);
     instr->SetProperty(GetProperties());
@@ -31,7 +34,8 @@ UnaryRegInstr *UnaryRegInstr::Copy(BB *targetBBlock) {
 
 LoadImmInstr *LoadImmInstr::Copy(BB *targetBBlock) {
     auto *allocator = targetBBlock->GetGraph()->GetAllocator();
-    auto *instr = allocator->template New<LoadImmInstr>(
+    auto *instr = allocator->template NewWithTag<LoadImmInstr>(
+        memory::ArenaTag::INSTRUCTIONS,
         GetOpcode(), GetType(), nullptr, GetValue(), allocator);
     targetBBlock->GetGraph()->GetInstructionBuilder()->AttachInstruction(instr);
     instr->SetProperty(GetProperties());
@@ -40,7 +44,8 @@ LoadImmInstr *LoadImmInstr::Copy(BB *targetBBlock) {
 
 StoreImmInstr *StoreImmInstr::Copy(BB *targetBBlock) {
     auto *allocator = targetBBlock->GetGraph()->GetAllocator();
-    auto *instr = allocator->template New<StoreImmInstr>(
+    auto *instr = allocator->template NewWithTag<StoreImmInstr>(
+        memory::ArenaTag::INSTRUCTIONS,
         GetOpcode(), nullptr, nullptr, GetValue(), allocator);
     targetBBlock->GetGraph()->GetInstructionBuilder()->AttachInstruction(instr);
     instr->SetProperty(GetProperties());
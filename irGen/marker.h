@@ -87,8 +87,9 @@ class Markable {
     }
 
   private:
+    // arena memory may be reused, so the markers must not be left undefined
     std::array<Marker, static_cast<uint8_t>(MarkersConstants::MAX_MARKERS)>
-        markers;
+        markers{};
 };
 } // namespace ir
 
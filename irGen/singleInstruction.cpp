@@ -72,18 +72,8 @@ bool SingleInstruction::Dominates(SingleInstruction *other) {
 
 bool SingleInstruction::IsEarlierInBasicBlock(SingleInstruction *other) {
     assert((other) && (GetInstBB()) && other->GetInstBB() == GetInstBB());
-    for (auto *instr : *GetInstBB()) {
-        if (instr == this) {
-            return true;
-        }
-        if (instr == other) {
-            return false;
-        }
-    }
-    std::cerr << "[SingleInstruction Error] Must have encountered either this "
-                 "or other instruction"
-              << std::endl;
-    return false;
+    GetInstBB()->UpdateInstructionsOrder();
+    return GetOrder() <= other->GetOrder();
 }
 
 void SingleInstruction::InsertInstBefore(SingleInstruction *inst) {
@@ -115,11 +105,10 @@ ConstInstr *SingleInstruction::CastToConstant() {
 }
 class InputsInstr;
 void SingleInstruction::ReplaceInputInUsers(SingleInstruction *newInput) {
-    newInput->AddUsers(GetUsers());
-    for (auto &it : GetUsers()) {
-        // assert(it->HasInputs());
-        auto *typed = static_cast<InputsInstr *>(it);
-        typed->ReplaceInput(this, newInput);
+    assert((newInput) && newInput != this);
+    // every relinked use is taken from the head of the list
+    while (auto *use = GetFirstUse()) {
+        use->SetInstruction(newInput);
     }
 }
 
@@ -33,6 +33,7 @@
 #include "marker.h"
 #include "user.h"
 #include <array>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
@@ -185,9 +186,9 @@ class InputsInstr;
 class SingleInstruction : public Markable, public User {
   public:
     SingleInstruction(Opcode opcode, InstType type,
-                      ArenaAllocator *const allocator, size_t id = INVALID_ID,
-                      uint8_t prop = 0)
-        : User(allocator), opcode_(opcode), instType_(type), instID_(id),
+                      [[maybe_unused]] ArenaAllocator *const allocator,
+                      size_t id = INVALID_ID, uint8_t prop = 0)
+        : opcode_(opcode), instType_(type), instID_(id),
           properties_(prop) {}
     SingleInstruction(const SingleInstruction &) = delete;
     SingleInstruction &operator=(const SingleInstruction &) = delete;
@@ -202,6 +203,8 @@ class SingleInstruction : public Markable, public User {
     BB *instBB_ = nullptr;
     InstType instType_;
     size_t instID_;
+    // position in the basic block, valid while the block's orders are valid
+    int64_t order_ = 0;
     uint8_t properties_ = 0;
 
   public:
@@ -215,6 +218,7 @@ class SingleInstruction : public Markable, public User {
     const char *GetOpcodeName(Opcode opcode) const;
     auto GetType() { return instType_; }
     uint8_t GetProperties() const { return properties_; }
+    int64_t GetOrder() const { return order_; }
     bool SatisfiesProperty(InstrProp prop) const {
         return GetProperties() & static_cast<uint8_t>(prop);
     }
@@ -247,6 +251,7 @@ class SingleInstruction : public Markable, public User {
         new_inst->SetNextInst(nextInst_);
 
         new_inst->SetBB(instBB_);
+        new_inst->SetOrder(order_);
 
         RemoveFromBlock();
     }
@@ -254,6 +259,8 @@ class SingleInstruction : public Markable, public User {
     void ReplaceInputInUsers(SingleInstruction *newInput);
 
     virtual SingleInstruction *Copy(BB *targetBBlock) = 0;
+    // Size of the most derived object, used to recycle dead instructions
+    virtual size_t GetObjectSize() const = 0;
 
   public:
     // setters
@@ -262,6 +269,7 @@ class SingleInstruction : public Markable, public User {
     void SetPrevInst(SingleInstruction *inst) { prevInst_ = inst; }
     void SetNextInst(SingleInstruction *inst) { nextInst_ = inst; }
     void SetBB(BB *bb) { instBB_ = bb; }
+    void SetOrder(int64_t order) { order_ = order; }
     void RemoveFromBlock();
     void InsertInstBefore(SingleInstruction *inst);
     void InsertInstAfter(SingleInstruction *inst);
@@ -270,6 +278,52 @@ class SingleInstruction : public Markable, public User {
     bool IsEarlierInBasicBlock(SingleInstruction *other);
 };
 
+// Input's linking needs the full declaration of its target instruction
+void Input::SetInstruction(SingleInstruction *newInstr) {
+    if (user_ == nullptr) {
+        instr_ = newInstr;
+        return;
+    }
+    if (instr_ != nullptr) {
+        unlink();
+    }
+    instr_ = newInstr;
+    if (instr_ != nullptr) {
+        link();
+    }
+}
+
+void Input::SetUser(SingleInstruction *user) {
+    assert((user) && user_ == nullptr);
+    user_ = user;
+    if (instr_ != nullptr) {
+        link();
+    }
+}
+
+void Input::link() {
+    assert((user_) && (instr_));
+    User *target = instr_;
+    nextUse_ = target->firstUse_;
+    if (nextUse_ != nullptr) {
+        nextUse_->prevUse_ = &nextUse_;
+    }
+    prevUse_ = &target->firstUse_;
+    target->firstUse_ = this;
+    ++target->usersCount_;
+}
+
+void Input::unlink() {
+    assert((prevUse_) && (instr_));
+    *prevUse_ = nextUse_;
+    if (nextUse_ != nullptr) {
+        nextUse_->prevUse_ = prevUse_;
+    }
+    nextUse_ = nullptr;
+    prevUse_ = nullptr;
+    --static_cast<User *>(instr_)->usersCount_;
+}
+
 } // namespace ir
 
 #endif // JIT_AOT_COURSE_IR_GEN_SINGLE_INSTRUCTION_H_
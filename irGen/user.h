@@ -1,24 +1,51 @@
 #ifndef JIT_AOT_COURSE_USER_H_
 #define JIT_AOT_COURSE_USER_H_
 
-#include "domTree/arena.h"
-#include <cassert>
-#include <span>
+#include "input.h"
+#include <cstddef>
+#include <iterator>
+#include <ranges>
 
 namespace ir {
 class SingleInstruction;
 
-class User {
+// Walks the intrusive users list, yielding the instruction owning each use.
+// An instruction using the same value several times is yielded for each use.
+class UsersIterator {
   public:
-    explicit User(memory::ArenaAllocator *const allocator)
-        : users_(allocator->ToSTL()) {
-        assert(allocator);
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = SingleInstruction *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = SingleInstruction **;
+    using reference = SingleInstruction *;
+
+    UsersIterator() = default;
+    explicit UsersIterator(Input *use) : use_(use) {}
+
+    SingleInstruction *operator*() const { return use_->GetUser(); }
+    Input *GetUse() const { return use_; }
+
+    UsersIterator &operator++() {
+        use_ = use_->GetNextUse();
+        return *this;
     }
-    User(std::span<SingleInstruction *> instrs,
-         memory::ArenaAllocator *const allocator)
-        : users_(instrs.begin(), instrs.end(), allocator->ToSTL()) {
-        assert(allocator);
+    UsersIterator operator++(int) {
+        auto prev = *this;
+        ++*this;
+        return prev;
     }
+    bool operator==(const UsersIterator &) const = default;
+
+  private:
+    Input *use_ = nullptr;
+};
+
+// The list must not be modified while it is iterated
+using UsersRange = std::ranges::subrange<UsersIterator>;
+
+class User {
+  public:
+    User() = default;
     User(const User &) = delete;
     User &operator=(const User &) = delete;
 
@@ -27,44 +54,18 @@ class User {
 
     virtual ~User() = default;
 
-    const memory::ArenaVector<SingleInstruction *> &GetUsers() const {
-        return users_;
+    UsersRange GetUsers() const {
+        return UsersRange(UsersIterator(firstUse_), UsersIterator());
     }
-    std::span<SingleInstruction *> GetUsers() { return std::span(users_); }
+    Input *GetFirstUse() const { return firstUse_; }
+    size_t UsersCount() const { return usersCount_; }
 
-    void AddUser(SingleInstruction *instr) {
-        assert(instr);
-        users_.push_back(instr);
-    }
-    void AddUsers(std::span<SingleInstruction *> instrs) {
-        users_.reserve(users_.size() + instrs.size());
-        for (auto &&it : instrs) {
-            users_.push_back(it);
-        }
-    }
-
-    void RemoveUser(SingleInstruction *instr) {
-        auto iter = std::find(users_.begin(), users_.end(), instr);
-        assert(iter != users_.end());
-        *iter = users_.back();
-        users_.pop_back();
-    }
-
-    void ReplaceUser(SingleInstruction *oldInstr, SingleInstruction *newInstr) {
-        auto iter = std::find(users_.begin(), users_.end(), oldInstr);
-        assert(iter != users_.end());
-        *iter = newInstr;
-    }
-
-    size_t UsersCount() const { return users_.size(); }
-
-    void SetNewUsers(memory::ArenaVector<SingleInstruction *> &&newUsers) {
-        users_ = std::move(newUsers);
-    }
+  private:
+    friend class Input;
 
-  protected:
-    memory::ArenaVector<SingleInstruction *> users_;
+    Input *firstUse_ = nullptr;
+    size_t usersCount_ = 0;
 };
 } // namespace ir
 
-#endif // JIT_AOT_COURSE_USER_H_
\ No newline at end of file
+#endif // JIT_AOT_COURSE_USER_H_
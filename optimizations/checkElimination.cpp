@@ -1,23 +1,24 @@
 #include "checkElimination.h"
-#include "domTree/dfo_rpo.h"
-#include "domTree/domTree.h"
 #include "graph.h"
 #include "irGen/instructions.h"
+#include "remarks.h"
 
 namespace ir {
 bool CheckElimination::Eliminate(Graph *graph) {
-    auto rpoBBlocks = RPO(graph);
-    DomTreeBuilder().Construct(graph);
+    auto &analyses = graph->GetAnalyses();
+    analyses.RequireDomTree();
 
     bool removed = false;
-    for (auto *bblock : rpoBBlocks) {
+    for (auto *bblock : analyses.GetRPO()) {
         for (auto *current : bblock->IterateNonPhi()) {
             removed |= TryRemoveCheck(current);
         }
     }
 
     if (removed) {
-        assert(Eliminate(graph));
+        // the removed checks may have hidden other redundant ones, the last
+        // round removes nothing
+        Eliminate(graph);
     }
     return removed;
 }
@@ -50,12 +51,16 @@ bool CheckElimination::SingleInputCheckDominates(
     assert((check) && (checkedValue));
     auto opcode = check->GetOpcode();
     bool removed = false;
-    for (auto *user : checkedValue->GetUsers()) {
+    auto *use = checkedValue->GetFirstUse();
+    while (use != nullptr) {
+        // the removed checks leave the users list
+        auto *user = use->GetUser();
+        use = use->GetNextUse();
         if (user != check && user->GetOpcode() == opcode &&
             check->Dominates(user)) {
-            user->GetInstBB()->SetInstructionAsDead(user);
-            std::cout << "Removed redundant "
-                      << " #" << user->GetInstID() << std::endl;
+            user->GetInstBB()->KillInstruction(user);
+            EmitRemark({RemarkKind::CHECK_REMOVED, "CheckElimination",
+                        "dominated by an equal check", user->GetInstID()});
             removed = true;
         }
     }
@@ -68,15 +73,20 @@ bool CheckElimination::boundsCheckDominates(SingleInstruction *check,
     assert((check) && (ref) && (idx));
     auto opcode = check->GetOpcode();
     bool removed = false;
-    for (auto *user : ref->GetUsers()) {
+    auto *use = ref->GetFirstUse();
+    while (use != nullptr) {
+        // the removed checks leave the users list
+        auto *user = use->GetUser();
+        use = use->GetNextUse();
         if (user != check && user->GetOpcode() == opcode &&
             check->Dominates(user)) {
             auto *inputsInstr = static_cast<InputsInstr *>(user);
             assert(inputsInstr->GetInput(0) == ref);
             if (inputsInstr->GetInput(1) == idx) {
-                user->GetInstBB()->SetInstructionAsDead(user);
-                std::cout << "Removed redundant "
-                          << " #" << user->GetInstID() << std::endl;
+                user->GetInstBB()->KillInstruction(user);
+                EmitRemark({RemarkKind::CHECK_REMOVED, "CheckElimination",
+                            "dominated by an equal check",
+                            user->GetInstID()});
                 removed = true;
             }
         }
@@ -9,6 +9,14 @@ class CheckElimination : public OptimizationPassBase {
     explicit CheckElimination(Graph *graph) : OptimizationPassBase(graph) {}
     ~CheckElimination() noexcept override = default;
 
+    bool Run() override { return Eliminate(graph_); }
+    const char *GetName() const override { return "CheckElimination"; }
+    AnalysisSet GetRequiredAnalyses() const override {
+        return {AnalysisKind::RPO, AnalysisKind::DOM_TREE};
+    }
+    AnalysisSet GetPreservedAnalyses() const override {
+        return AnalysisSet::All();
+    }
     bool Eliminate(Graph *graph);
 
   private:
@@ -12,8 +12,7 @@ bool ConstantFolding::ProcessMUL(BinaryRegInstr *instr) {
         auto *newInstr =
             GetInstructionBuilder(instr)->BuildConst(instr->GetType(), value);
 
-        input1->RemoveUser(instr);
-        input2->RemoveUser(instr);
+        instr->ClearInputs();
         instr->GetInstBB()->ReplaceInstruction(instr, newInstr);
 
         return true;
@@ -32,8 +31,7 @@ bool ConstantFolding::ProcessSHR(BinaryRegInstr *instr) {
         auto *newInstr =
             GetInstructionBuilder(instr)->BuildConst(instr->GetType(), value);
 
-        input1->RemoveUser(instr);
-        input2->RemoveUser(instr);
+        instr->ClearInputs();
         instr->GetInstBB()->ReplaceInstruction(instr, newInstr);
 
         return true;
@@ -51,8 +49,7 @@ bool ConstantFolding::ProcessXOR(BinaryRegInstr *instr) {
         auto *newInstr =
             GetInstructionBuilder(instr)->BuildConst(instr->GetType(), value);
 
-        input1->RemoveUser(instr);
-        input2->RemoveUser(instr);
+        instr->ClearInputs();
         instr->GetInstBB()->ReplaceInstruction(instr, newInstr);
 
         return true;
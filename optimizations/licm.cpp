@@ -0,0 +1,122 @@
+#include "licm.h"
+#include "domTree/loop.h"
+#include "graph.h"
+#include "irGen/instructions.h"
+#include "remarks.h"
+
+namespace ir {
+bool LoopInvariantCodeMotion::Run() {
+    hoistedCount_ = 0;
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    auto *loops = graph_->GetLoopTree()->GetLoopsOuterFirst(allocator);
+    // inner loops are visited first
+    for (auto it = loops->rbegin(); it != loops->rend(); ++it) {
+        auto *loop = *it;
+        if (!loop->IsRoot() && !loop->IsIrreducible()) {
+            HoistFromLoop(loop);
+        }
+    }
+    return hoistedCount_ != 0;
+}
+
+void LoopInvariantCodeMotion::HoistFromLoop(Loop *loop) {
+    assert(loop);
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    // definitions are visited before their uses
+    auto *bblocks = loop->GetBlocksInDomOrder(allocator);
+
+    // created only once there is something to hoist
+    BB *preHeader = nullptr;
+    for (auto *bblock : *bblocks) {
+        auto *instr = bblock->GetFirstInstBB();
+        while (instr != nullptr) {
+            auto *next = instr->GetNextInst();
+            if (IsHoistable(loop, instr)) {
+                if (preHeader == nullptr) {
+                    preHeader = loop->GetOrCreatePreHeader();
+                }
+                bblock->UnlinkInstruction(instr);
+                Hoist(preHeader, instr);
+            }
+            instr = next;
+        }
+    }
+}
+
+bool LoopInvariantCodeMotion::IsHoistable(Loop *loop,
+                                          SingleInstruction *instr) const {
+    assert((loop) && (instr));
+    // compares are kept as well, the following jumps read the flags set by
+    // them
+    if (instr->IsPhi() || instr->SatisfiesProperty(InstrProp::JUMP) ||
+        instr->HasSideEffects() || !IsInvariant(loop, instr)) {
+        return false;
+    }
+    auto opcode = instr->GetOpcode();
+    if (instr->SatisfiesProperty(InstrProp::MEM)) {
+        // lengths are the only memory reads never changed by the loop, but
+        // the array must not be null before the first iteration
+        if (opcode != Opcode::LEN) {
+            return false;
+        }
+        auto *array =
+            static_cast<InputsInstr *>(instr)->GetInput(0).GetInstruction();
+        return IsNonNullBefore(loop, array);
+    }
+    return instr->SatisfiesProperty(InstrProp::ARITH) ||
+           opcode == Opcode::CAST || opcode == Opcode::CONST;
+}
+
+bool LoopInvariantCodeMotion::IsInvariant(Loop *loop,
+                                          SingleInstruction *instr) const {
+    if (!instr->HasInputs()) {
+        return true;
+    }
+    auto *inputsInstr = static_cast<InputsInstr *>(instr);
+    for (size_t i = 0, end = inputsInstr->GetInputsCount(); i < end; ++i) {
+        auto *input = inputsInstr->GetInput(i).GetInstruction();
+        assert(input);
+        // the inputs hoisted before are already in the preheader
+        if (input->GetInstBB() != nullptr &&
+            loop->Contains(input->GetInstBB())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LoopInvariantCodeMotion::IsNonNullBefore(Loop *loop,
+                                              SingleInstruction *ref) const {
+    assert(ref);
+    auto opcode = ref->GetOpcode();
+    if (opcode == Opcode::NEW_ARRAY || opcode == Opcode::NEW_ARRAY_IMM) {
+        return true;
+    }
+    // a check outside of the loop dominating its header is done before the
+    // preheader is left
+    for (auto *user : ref->GetUsers()) {
+        auto *checkBlock = user->GetInstBB();
+        if (user->GetOpcode() == Opcode::NULL_CHECK && checkBlock != nullptr &&
+            !loop->Contains(checkBlock) &&
+            checkBlock->Domites(loop->GetHeader())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LoopInvariantCodeMotion::Hoist(BB *preHeader, SingleInstruction *instr) {
+    assert((preHeader) && (instr));
+    auto *last = preHeader->GetLastInstBB();
+    if (last != nullptr && last->SatisfiesProperty(InstrProp::JUMP)) {
+        preHeader->InsertSingleInstrBefore(last, instr);
+    } else {
+        preHeader->PushInstBackward(instr);
+    }
+    ++hoistedCount_;
+    EmitRemark({RemarkKind::INSTR_HOISTED, GetName(),
+                "hoisted into the preheader", instr->GetInstID()});
+}
+} // namespace ir
@@ -0,0 +1,40 @@
+#ifndef JIT_AOT_COURSE_LICM_H_
+#define JIT_AOT_COURSE_LICM_H_
+
+#include "pass.h"
+
+namespace ir {
+// Hoists loop invariant instructions into the preheaders of reducible loops.
+// Loops are visited from the inner to the outer ones, so an instruction
+// moves out of as many loops as it is invariant in.
+class LoopInvariantCodeMotion : public OptimizationPassBase {
+  public:
+    explicit LoopInvariantCodeMotion(Graph *graph)
+        : OptimizationPassBase(graph) {}
+    ~LoopInvariantCodeMotion() noexcept override = default;
+
+    bool Run() override;
+    const char *GetName() const override { return "LICM"; }
+    AnalysisSet GetRequiredAnalyses() const override {
+        return {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE};
+    }
+    // preheaders are created keeping both trees valid
+    AnalysisSet GetPreservedAnalyses() const override {
+        return {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE};
+    }
+
+    size_t GetHoistedCount() const { return hoistedCount_; }
+
+  private:
+    void HoistFromLoop(Loop *loop);
+    bool IsHoistable(Loop *loop, SingleInstruction *instr) const;
+    bool IsInvariant(Loop *loop, SingleInstruction *instr) const;
+    bool IsNonNullBefore(Loop *loop, SingleInstruction *ref) const;
+    void Hoist(BB *preHeader, SingleInstruction *instr);
+
+  private:
+    size_t hoistedCount_ = 0;
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_LICM_H_
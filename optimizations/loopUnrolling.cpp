@@ -0,0 +1,476 @@
+#include "loopUnrolling.h"
+#include "graph.h"
+#include "irGen/instructions.h"
+#include "remarks.h"
+
+namespace ir {
+namespace {
+size_t GetSourceIdx(PhiInstr *phi, BB *source) {
+    auto &sources = phi->GetSourceBBs();
+    auto it = std::find(sources.begin(), sources.end(), source);
+    assert(it != sources.end());
+    return static_cast<size_t>(it - sources.begin());
+}
+
+void RemovePhiInputsFrom(BB *bblock, BB *source) {
+    for (auto *instr : *bblock) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        auto &inputs = phi->GetInputs();
+        auto &sources = phi->GetSourceBBs();
+        for (size_t i = 0; i < sources.size();) {
+            if (sources[i] != source) {
+                ++i;
+                continue;
+            }
+            inputs.erase(inputs.begin() + static_cast<ptrdiff_t>(i));
+            sources.erase(sources.begin() + static_cast<ptrdiff_t>(i));
+        }
+    }
+}
+
+// Use of a value of the loop after the loop
+struct OutsideUse {
+    InputsInstr *user;
+    size_t idx;
+    SingleInstruction *value;
+};
+} // namespace
+
+bool LoopUnrolling::Run() {
+    unrolledCount_ = 0;
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    auto *loops = graph_->GetLoopTree()->GetLoopsOuterFirst(allocator);
+
+    auto *candidates = allocator->template NewVector<UnrollCandidate>();
+    auto graphInstrsCount = graph_->CountInstructions();
+    for (auto *loop : *loops) {
+        // innermost loops do not overlap, so they are unrolled independently
+        if (loop->IsRoot() || !loop->GetInnerLoops().empty()) {
+            continue;
+        }
+        CountedLoop counted;
+        UnrollCandidate candidate;
+        if (!ComputeTripCount(loop, &counted) ||
+            !ChooseUnrolling(loop, counted, &graphInstrsCount, &candidate)) {
+            continue;
+        }
+        // the peeled iterations are entered from it
+        loop->GetOrCreatePreHeader();
+        candidate.loop = loop;
+        candidates->push_back(candidate);
+    }
+    // the preheaders created later could have split the exit edges
+    for (auto &candidate : *candidates) {
+        auto *loop = candidate.loop;
+        [[maybe_unused]] bool isCounted =
+            ComputeTripCount(loop, &candidate.counted);
+        assert(isCounted);
+        const auto &bblocks = loop->GetBasicBlocks();
+        candidate.bblocks = allocator->template NewVector<BB *>(
+            bblocks.begin(), bblocks.end());
+        candidate.preHeader = loop->GetPreHeader();
+        candidate.header = loop->GetHeader();
+        candidate.latch = loop->GetBackEdges()[0];
+        candidate.loop = nullptr;
+    }
+
+    // the trees are not updated by the cloning
+    graph_->InvalidateAnalyses();
+    for (auto &candidate : *candidates) {
+        Unroll(&candidate);
+    }
+    return unrolledCount_ != 0;
+}
+
+bool LoopUnrolling::ChooseUnrolling(Loop *loop, const CountedLoop &counted,
+                                    size_t *graphInstrsCount,
+                                    UnrollCandidate *candidate) {
+    assert((loop) && (graphInstrsCount) && (candidate));
+    size_t loopInstrsCount = 0;
+    for (auto *bblock : loop->GetBasicBlocks()) {
+        loopInstrsCount += bblock->GetSize();
+    }
+    auto id = counted.induction->GetInstID();
+    if (loopInstrsCount >= maxLoopInstrs) {
+        EmitRemark({RemarkKind::UNROLL_SKIPPED, GetName(),
+                    "loop has too many instructions", id, loopInstrsCount,
+                    maxLoopInstrs});
+        return false;
+    }
+    // the compare and the jump are there at least
+    assert(loopInstrsCount != 0);
+    size_t maxCopiesCount = 0;
+    if (*graphInstrsCount < maxInstrsAfterUnrolling) {
+        maxCopiesCount = (maxInstrsAfterUnrolling - *graphInstrsCount - 1) /
+                         loopInstrsCount;
+    }
+
+    auto tripCount = counted.tripCount;
+    assert(tripCount != 0);
+    if (tripCount - 1 <= maxCopiesCount) {
+        candidate->peeledCount = tripCount - 1;
+        candidate->unrollFactor = 0;
+        *graphInstrsCount += candidate->peeledCount * loopInstrsCount;
+        return true;
+    }
+    for (size_t factor : {UNROLL_FACTOR, size_t{2}}) {
+        if (tripCount < factor) {
+            continue;
+        }
+        // the iterations left over by the factor are peeled
+        auto peeledCount = tripCount % factor;
+        auto copiesCount = factor - 1 + peeledCount;
+        if (copiesCount <= maxCopiesCount) {
+            candidate->peeledCount = peeledCount;
+            candidate->unrollFactor = factor;
+            *graphInstrsCount += copiesCount * loopInstrsCount;
+            return true;
+        }
+    }
+    EmitRemark({RemarkKind::UNROLL_SKIPPED, GetName(),
+                "too many instructions after unrolling", id,
+                *graphInstrsCount + loopInstrsCount,
+                maxInstrsAfterUnrolling});
+    return false;
+}
+
+void LoopUnrolling::Unroll(UnrollCandidate *candidate) {
+    assert(candidate);
+    memory::ArenaScope scope(graph_->GetScratchAllocator());
+    auto id = candidate->counted.induction->GetInstID();
+    if (candidate->peeledCount != 0) {
+        PeelIterations(candidate, candidate->peeledCount);
+    }
+    if (candidate->unrollFactor == 0) {
+        LeaveSingleIteration(candidate);
+        EmitRemark({RemarkKind::LOOP_UNROLLED, GetName(),
+                    "loop unrolled fully, iterations", id,
+                    candidate->counted.tripCount});
+    } else {
+        RepeatBody(candidate, candidate->unrollFactor);
+        EmitRemark({RemarkKind::LOOP_UNROLLED, GetName(),
+                    "loop unrolled by factor", id, candidate->unrollFactor});
+    }
+    ++unrolledCount_;
+    instrsTranslation_ = nullptr;
+    blocksTranslation_ = nullptr;
+}
+
+void LoopUnrolling::PeelIterations(UnrollCandidate *candidate,
+                                   size_t count) {
+    assert((candidate) && count != 0);
+    auto *allocator = graph_->GetScratchAllocator();
+    auto *header = candidate->header;
+    auto *entryValues = allocator->template NewVector<SingleInstruction *>();
+    for (auto *instr : *header) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        auto idx = GetSourceIdx(phi, candidate->preHeader);
+        entryValues->push_back(phi->GetInput(idx).GetInstruction());
+    }
+
+    // every copy is entered from the previous one
+    auto *entry = candidate->preHeader;
+    for (size_t i = 0; i < count; ++i) {
+        CloneIteration(candidate, *entryValues, false);
+        RetargetEdge(entry, header,
+                     blocksTranslation_->at(header->GetId()));
+        entry = blocksTranslation_->at(candidate->latch->GetId());
+        AdvanceEntryValues(candidate, entryValues);
+    }
+    size_t valueIdx = 0;
+    for (auto *instr : *header) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        auto idx = GetSourceIdx(phi, candidate->preHeader);
+        phi->SetInput((*entryValues)[valueIdx++], idx);
+        phi->SetSourceBB(entry, idx);
+    }
+    candidate->preHeader = entry;
+}
+
+void LoopUnrolling::RepeatBody(UnrollCandidate *candidate, size_t factor) {
+    assert((candidate) && factor > 1);
+    auto *allocator = graph_->GetScratchAllocator();
+    auto *header = candidate->header;
+    auto *latch = candidate->latch;
+    auto *exiting = candidate->counted.exiting;
+    auto *exit = candidate->counted.exit;
+
+    // the loop is left from the last copy, so the values after the loop are
+    // taken from it
+    auto *inLoop = allocator->template NewUnorderedMap<size_t, BB *>();
+    for (auto *bblock : *candidate->bblocks) {
+        inLoop->insert({bblock->GetId(), bblock});
+    }
+    auto *outsideUses = allocator->template NewVector<OutsideUse>();
+    for (auto *bblock : *candidate->bblocks) {
+        for (auto *instr : *bblock) {
+            auto users = instr->GetUsers();
+            for (auto it = users.begin(); it != users.end(); ++it) {
+                auto *user = static_cast<InputsInstr *>(*it);
+                auto *userBBlock = user->GetInstBB();
+                if (userBBlock == nullptr ||
+                    inLoop->contains(userBBlock->GetId())) {
+                    continue;
+                }
+                size_t idx = 0;
+                while (&user->GetInput(idx) != it.GetUse()) {
+                    ++idx;
+                }
+                // inputs of the exit phis are added with the exit edge
+                if (!user->IsPhi() ||
+                    static_cast<PhiInstr *>(user)->GetSourceBB(idx) !=
+                        exiting) {
+                    outsideUses->push_back({user, idx, instr});
+                }
+            }
+        }
+    }
+
+    auto *entryValues = allocator->template NewVector<SingleInstruction *>();
+    for (auto *instr : *header) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        entryValues->push_back(
+            phi->GetInput(GetSourceIdx(phi, latch)).GetInstruction());
+    }
+    // the original back edge is moved once all the copies are made, they
+    // copy the edges of the original blocks
+    BB *firstHeader = nullptr;
+    BB *prevLatch = nullptr;
+    for (size_t i = 1; i < factor; ++i) {
+        CloneIteration(candidate, *entryValues, i + 1 == factor);
+        auto *headerCopy = blocksTranslation_->at(header->GetId());
+        if (prevLatch == nullptr) {
+            firstHeader = headerCopy;
+        } else {
+            RetargetEdge(prevLatch, header, headerCopy);
+        }
+        prevLatch = blocksTranslation_->at(latch->GetId());
+        AdvanceEntryValues(candidate, entryValues);
+    }
+    RetargetEdge(latch, header, firstHeader);
+    graph_->DisconnectBBs(exiting, exit);
+    RemovePhiInputsFrom(exit, exiting);
+    DropExitTest(exiting);
+
+    size_t valueIdx = 0;
+    for (auto *instr : *header) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        auto idx = GetSourceIdx(phi, latch);
+        phi->SetInput((*entryValues)[valueIdx++], idx);
+        phi->SetSourceBB(prevLatch, idx);
+    }
+    for (auto &use : *outsideUses) {
+        use.user->SetInput(Translate(use.value), use.idx);
+    }
+}
+
+void LoopUnrolling::LeaveSingleIteration(UnrollCandidate *candidate) {
+    assert(candidate);
+    auto *allocator = graph_->GetScratchAllocator();
+    auto *header = candidate->header;
+    auto *exiting = candidate->counted.exiting;
+    auto &successors = exiting->GetSuccessors();
+    auto *inLoopSucc =
+        successors[0] == candidate->counted.exit ? successors[1]
+                                                  : successors[0];
+    graph_->DisconnectBBs(exiting, inLoopSucc);
+    DropExitTest(exiting);
+
+    SingleInstruction *instr = header->GetFirstPhiBB();
+    while (instr != nullptr && instr->IsPhi()) {
+        auto *next = instr->GetNextInst();
+        auto *phi = static_cast<PhiInstr *>(instr);
+        auto idx = GetSourceIdx(phi, candidate->preHeader);
+        phi->ReplaceInputInUsers(phi->GetInput(idx).GetInstruction());
+        phi->GetInstBB()->KillInstruction(phi);
+        instr = next;
+    }
+
+    // blocks after the exiting one are not executed anymore
+    auto *inLoop = allocator->template NewUnorderedMap<size_t, BB *>();
+    for (auto *bblock : *candidate->bblocks) {
+        inLoop->insert({bblock->GetId(), bblock});
+    }
+    auto *reached = allocator->template NewUnorderedMap<size_t, BB *>();
+    auto *worklist = allocator->template NewVector<BB *>(1, header);
+    reached->insert({header->GetId(), header});
+    while (!worklist->empty()) {
+        auto *bblock = worklist->back();
+        worklist->pop_back();
+        for (auto *succ : bblock->GetSuccessors()) {
+            if (inLoop->contains(succ->GetId()) &&
+                reached->insert({succ->GetId(), succ}).second) {
+                worklist->push_back(succ);
+            }
+        }
+    }
+    for (auto *bblock : *candidate->bblocks) {
+        if (reached->contains(bblock->GetId())) {
+            continue;
+        }
+        auto *dead = bblock->IsEmpty() ? nullptr : *bblock->begin();
+        while (dead != nullptr) {
+            auto *next = dead->GetNextInst();
+            dead->GetInstBB()->KillInstruction(dead);
+            dead = next;
+        }
+        graph_->SetBBAsDead(bblock);
+    }
+}
+
+void LoopUnrolling::CloneIteration(
+    UnrollCandidate *candidate,
+    const ArenaVector<SingleInstruction *> &entryValues, bool keepExit) {
+    assert(candidate);
+    auto *allocator = graph_->GetScratchAllocator();
+    auto *header = candidate->header;
+    auto &bblocks = *candidate->bblocks;
+    instrsTranslation_ =
+        allocator->template NewUnorderedMap<size_t, SingleInstruction *>();
+    blocksTranslation_ = allocator->template NewUnorderedMap<size_t, BB *>();
+    for (auto *bblock : bblocks) {
+        blocksTranslation_->insert(
+            {bblock->GetId(), bblock->Copy(graph_, instrsTranslation_)});
+    }
+
+    // the header phis are replaced by their values on the entry
+    auto entryIt = entryValues.begin();
+    for (auto *instr : *header) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        assert(entryIt != entryValues.end());
+        auto &copy = instrsTranslation_->at(instr->GetInstID());
+        copy->GetInstBB()->KillInstruction(copy);
+        copy = *entryIt++;
+    }
+
+    // copies are made with the inputs of the originals
+    for (auto *bblock : bblocks) {
+        for (auto *instr : *bblock) {
+            if (!instr->HasInputs() || (bblock == header && instr->IsPhi())) {
+                continue;
+            }
+            auto *orig = static_cast<InputsInstr *>(instr);
+            auto *copy = static_cast<InputsInstr *>(
+                instrsTranslation_->at(instr->GetInstID()));
+            for (size_t i = 0, end = orig->GetInputsCount(); i < end; ++i) {
+                copy->SetInput(Translate(orig->GetInput(i).GetInstruction()),
+                               i);
+            }
+            if (instr->IsPhi()) {
+                auto *phi = static_cast<PhiInstr *>(instr);
+                for (size_t i = 0, end = phi->GetInputsCount(); i < end; ++i) {
+                    static_cast<PhiInstr *>(copy)->SetSourceBB(
+                        blocksTranslation_->at(phi->GetSourceBB(i)->GetId()),
+                        i);
+                }
+            }
+        }
+    }
+
+    // edges are added in the original order, the true branch goes first
+    auto *exiting = candidate->counted.exiting;
+    auto *exit = candidate->counted.exit;
+    auto *exitingCopy = blocksTranslation_->at(exiting->GetId());
+    for (auto *bblock : bblocks) {
+        auto *copy = blocksTranslation_->at(bblock->GetId());
+        for (auto *succ : bblock->GetSuccessors()) {
+            if (succ == header) {
+                // the back edge is retargeted by the caller when the loop is
+                // not entered after the copy
+                graph_->ConnectBBs(copy, header);
+                continue;
+            }
+            auto it = blocksTranslation_->find(succ->GetId());
+            if (it != blocksTranslation_->end()) {
+                graph_->ConnectBBs(copy, it->second);
+                continue;
+            }
+            assert(bblock == exiting && succ == exit);
+            if (keepExit) {
+                graph_->ConnectBBs(copy, exit);
+                AddExitPhiInputs(exit, exiting, exitingCopy);
+            }
+        }
+    }
+    if (!keepExit) {
+        DropExitTest(exitingCopy);
+    }
+}
+
+void LoopUnrolling::AddExitPhiInputs(BB *exit, BB *exiting,
+                                     BB *exitingCopy) {
+    for (auto *instr : *exit) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        for (size_t i = 0, end = phi->GetInputsCount(); i < end; ++i) {
+            if (phi->GetSourceBB(i) == exiting) {
+                phi->AddPhiInput(Translate(phi->GetInput(i).GetInstruction()),
+                                 exitingCopy);
+            }
+        }
+    }
+}
+
+void LoopUnrolling::AdvanceEntryValues(
+    UnrollCandidate *candidate, ArenaVector<SingleInstruction *> *entryValues) {
+    size_t valueIdx = 0;
+    for (auto *instr : *candidate->header) {
+        if (!instr->IsPhi()) {
+            break;
+        }
+        auto *phi = static_cast<PhiInstr *>(instr);
+        auto idx = GetSourceIdx(phi, candidate->latch);
+        (*entryValues)[valueIdx++] =
+            Translate(phi->GetInput(idx).GetInstruction());
+    }
+}
+
+SingleInstruction *LoopUnrolling::Translate(SingleInstruction *instr) const {
+    if (instrsTranslation_ == nullptr || instr == nullptr) {
+        return instr;
+    }
+    // values defined before the loop are shared by the copies
+    auto it = instrsTranslation_->find(instr->GetInstID());
+    return it != instrsTranslation_->end() ? it->second : instr;
+}
+
+void LoopUnrolling::DropExitTest(BB *exiting) {
+    assert(exiting);
+    auto *jump = exiting->GetLastInstBB();
+    assert((jump) && jump->IsBranch());
+    auto *compare = jump->GetPrevInst();
+    jump->GetInstBB()->KillInstruction(jump);
+    // the flags were read only by the jump
+    if (compare != nullptr && compare->GetOpcode() == Opcode::CMP &&
+        compare->UsersCount() == 0) {
+        compare->GetInstBB()->KillInstruction(compare);
+    }
+}
+
+void LoopUnrolling::RetargetEdge(BB *from, BB *oldTarget, BB *newTarget) {
+    assert((from) && (oldTarget) && (newTarget));
+    from->ReplaceSuccessor(oldTarget, newTarget);
+    oldTarget->DeletePredecessors(from);
+    newTarget->AddPredecessors(from);
+}
+} // namespace ir
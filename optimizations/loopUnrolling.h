@@ -0,0 +1,79 @@
+#ifndef JIT_AOT_COURSE_LOOP_UNROLLING_H_
+#define JIT_AOT_COURSE_LOOP_UNROLLING_H_
+
+#include "domTree/tripCount.h"
+#include "pass.h"
+
+namespace ir {
+// Unrolls innermost counted loops with compile-time trip counts. A loop
+// fitting the budget is unrolled fully: all iterations but the last are
+// peeled off in front of it and the last one is left without the back edge.
+// Otherwise the body is repeated UNROLL_FACTOR times in the loop, and the
+// iterations not divisible by the factor are peeled off first. The tests of
+// the exit known to fail are dropped from the copies.
+class LoopUnrolling : public OptimizationPassBase {
+  public:
+    static constexpr size_t UNROLL_FACTOR = 4;
+
+    LoopUnrolling(Graph *graph, size_t maxLoopInstrs,
+                  size_t maxInstrsAfterUnrolling)
+        : OptimizationPassBase(graph), maxLoopInstrs(maxLoopInstrs),
+          maxInstrsAfterUnrolling(maxInstrsAfterUnrolling) {
+        assert(maxLoopInstrs < maxInstrsAfterUnrolling);
+    }
+
+    bool Run() override;
+    const char *GetName() const override { return "LoopUnrolling"; }
+    AnalysisSet GetRequiredAnalyses() const override {
+        return {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE};
+    }
+
+    size_t GetUnrolledCount() const { return unrolledCount_; }
+
+  private:
+    using InstrsTranslation = ArenaUnorderedMap<size_t, SingleInstruction *>;
+    using BlocksTranslation = ArenaUnorderedMap<size_t, BB *>;
+
+    // Loop chosen for unrolling. Its blocks are saved, as the loop tree is
+    // invalidated by the edits of the other loops.
+    struct UnrollCandidate {
+        Loop *loop = nullptr;
+        ArenaVector<BB *> *bblocks = nullptr;
+        BB *preHeader = nullptr;
+        BB *header = nullptr;
+        BB *latch = nullptr;
+        CountedLoop counted;
+        size_t peeledCount = 0;
+        // 0 for the full unrolling
+        size_t unrollFactor = 0;
+    };
+
+    bool ChooseUnrolling(Loop *loop, const CountedLoop &counted,
+                         size_t *graphInstrsCount,
+                         UnrollCandidate *candidate);
+    void Unroll(UnrollCandidate *candidate);
+    void PeelIterations(UnrollCandidate *candidate, size_t count);
+    void RepeatBody(UnrollCandidate *candidate, size_t factor);
+    void LeaveSingleIteration(UnrollCandidate *candidate);
+    void CloneIteration(UnrollCandidate *candidate,
+                        const ArenaVector<SingleInstruction *> &entryValues,
+                        bool keepExit);
+    void AddExitPhiInputs(BB *exit, BB *exiting, BB *exitingCopy);
+    void AdvanceEntryValues(UnrollCandidate *candidate,
+                            ArenaVector<SingleInstruction *> *entryValues);
+    SingleInstruction *Translate(SingleInstruction *instr) const;
+    void DropExitTest(BB *exiting);
+    void RetargetEdge(BB *from, BB *oldTarget, BB *newTarget);
+
+  private:
+    size_t maxLoopInstrs;
+    size_t maxInstrsAfterUnrolling;
+    size_t unrolledCount_ = 0;
+
+    // translations of the original loop to its last copy
+    InstrsTranslation *instrsTranslation_ = nullptr;
+    BlocksTranslation *blocksTranslation_ = nullptr;
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_LOOP_UNROLLING_H_
@@ -15,7 +15,27 @@ class OptimizationPassBase {
     OptimizationPassBase &operator=(OptimizationPassBase &&) = delete;
     virtual ~OptimizationPassBase() noexcept = default;
 
-    virtual void Run() = 0;
+    // Returns true if the pass changed the IR, including the changes keeping
+    // the instructions and blocks counts, e.g. moves and input rewrites
+    virtual bool Run() = 0;
+    virtual const char *GetName() const = 0;
+
+    // Analyses computed before the pass is run
+    virtual AnalysisSet GetRequiredAnalyses() const { return AnalysisSet(); }
+    // Analyses left valid by the pass, the others are dropped after it even
+    // if the pass changed nothing
+    virtual AnalysisSet GetPreservedAnalyses() const { return AnalysisSet(); }
+
+    // The nodes killed by the previous passes are recycled first, so a pass
+    // never keeps pointers to them
+    bool Apply() {
+        graph_->RecycleDeadNodes();
+        auto &analyses = graph_->GetAnalyses();
+        analyses.Require(GetRequiredAnalyses());
+        auto changed = Run();
+        analyses.Invalidate(~GetPreservedAnalyses());
+        return changed;
+    }
 
   protected:
     Graph *graph_;
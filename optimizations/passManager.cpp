@@ -0,0 +1,61 @@
+#include "passManager.h"
+#include "irGen/helperBuilderFunctions.h"
+#include <chrono>
+#include <iomanip>
+
+namespace ir {
+
+size_t PassManager::Run() {
+    iterationsCount_ = 0;
+    bool changed = true;
+    while (changed && iterationsCount_ < maxIterations_) {
+        changed = false;
+        for (size_t i = 0; i < passes_.size(); ++i) {
+            changed |= runPass(i);
+        }
+        ++iterationsCount_;
+    }
+    return iterationsCount_;
+}
+
+bool PassManager::runPass(size_t idx) {
+    auto *instrBuilder = graph_->GetInstructionBuilder();
+    auto builtBefore = instrBuilder->GetBuiltInstructionsCount();
+    auto killedBefore = graph_->GetKilledInstructionsCount();
+    auto bblocksBefore = graph_->GetAddedBBsCount() + graph_->GetDeadBBsCount();
+
+    auto start = std::chrono::steady_clock::now();
+    auto changed = passes_[idx]->Apply();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    auto created = instrBuilder->GetBuiltInstructionsCount() - builtBefore;
+    auto removed = graph_->GetKilledInstructionsCount() - killedBefore;
+    auto bblocksChanged = graph_->GetAddedBBsCount() +
+                          graph_->GetDeadBBsCount() - bblocksBefore;
+    auto &stats = stats_[idx];
+    ++stats.runs;
+    stats.timeMs += elapsed.count();
+    stats.instrsCreated += created;
+    stats.instrsRemoved += removed;
+    stats.bblocksChanged += bblocksChanged;
+    return changed;
+}
+
+void PassManager::DumpStats(std::ostream &out) const {
+    out << "Pipeline of " << passes_.size() << " passes, " << iterationsCount_
+        << " iterations" << std::endl;
+    out << std::left << std::setw(20) << "pass" << std::right << std::setw(6)
+        << "runs" << std::setw(12) << "time, ms" << std::setw(10) << "created"
+        << std::setw(10) << "removed" << std::setw(10) << "blocks"
+        << std::endl;
+    for (const auto &stats : stats_) {
+        out << std::left << std::setw(20) << stats.name << std::right
+            << std::setw(6) << stats.runs << std::setw(12) << std::fixed
+            << std::setprecision(3) << stats.timeMs << std::setw(10)
+            << stats.instrsCreated << std::setw(10) << stats.instrsRemoved
+            << std::setw(10) << stats.bblocksChanged << std::endl;
+    }
+}
+
+} // namespace ir
@@ -0,0 +1,69 @@
+#ifndef JIT_AOT_COURSE_PASS_MANAGER_H_
+#define JIT_AOT_COURSE_PASS_MANAGER_H_
+
+#include "pass.h"
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ir {
+// Accumulated over all the runs of a pass in a pipeline
+struct PassStats {
+    const char *name = nullptr;
+    size_t runs = 0;
+    double timeMs = 0;
+    size_t instrsCreated = 0;
+    size_t instrsRemoved = 0;
+    // blocks created and removed
+    size_t bblocksChanged = 0;
+};
+
+// Runs the passes in the order they were added. The pipeline is repeated
+// while its passes change the IR, but at most the given number of times.
+class PassManager {
+  public:
+    static constexpr size_t DEFAULT_MAX_ITERATIONS = 4;
+
+    explicit PassManager(Graph *graph,
+                         size_t maxIterations = DEFAULT_MAX_ITERATIONS)
+        : graph_(graph), maxIterations_(maxIterations) {
+        assert(graph_);
+        assert(maxIterations_ > 0);
+    }
+    PassManager(const PassManager &) = delete;
+    PassManager &operator=(const PassManager &) = delete;
+    PassManager(PassManager &&) = delete;
+    PassManager &operator=(PassManager &&) = delete;
+    ~PassManager() noexcept = default;
+
+    template <typename PassT, typename... ArgsT>
+    PassManager &AddPass(ArgsT &&...args) {
+        static_assert(std::is_base_of_v<OptimizationPassBase, PassT>);
+        passes_.push_back(
+            std::make_unique<PassT>(graph_, std::forward<ArgsT>(args)...));
+        stats_.push_back(PassStats{passes_.back()->GetName()});
+        return *this;
+    }
+
+    // Returns the number of pipeline iterations done
+    size_t Run();
+
+    const std::vector<PassStats> &GetStats() const { return stats_; }
+    size_t GetIterationsCount() const { return iterationsCount_; }
+    void DumpStats(std::ostream &out) const;
+
+  private:
+    // Returns true if the pass changed the IR
+    bool runPass(size_t idx);
+
+  private:
+    Graph *graph_;
+    size_t maxIterations_;
+    size_t iterationsCount_ = 0;
+    std::vector<std::unique_ptr<OptimizationPassBase>> passes_;
+    std::vector<PassStats> stats_;
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_PASS_MANAGER_H_
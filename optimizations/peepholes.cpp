@@ -1,15 +1,25 @@
 #include "peepholes.h"
-#include "domTree/dfo_rpo.h"
 #include "irGen/helperBuilderFunctions.h"
+#include "remarks.h"
 #include <cassert>
 #include <limits>
 
 namespace ir {
 
-void Peepholes::Run() {
-    for (auto &bblock : RPO(graph_)) {
+static void remark(RemarkKind kind, const char *message,
+                   SingleInstruction *instr) {
+    EmitRemark({kind, "Peepholes", message, instr->GetInstID()});
+}
+
+bool Peepholes::Run() {
+    // every applied peephole removes the visited instruction
+    auto killedBefore = graph_->GetKilledInstructionsCount();
+    for (auto *bblock : graph_->GetAnalyses().GetRPO()) {
+        // a visited instruction may be killed, which unlinks it
+        SingleInstruction *next = nullptr;
         for (auto *instr = bblock->GetFirstInstBB(); instr != nullptr;
-             instr = instr->GetNextInst()) {
+             instr = next) {
+            next = instr->GetNextInst();
             switch (instr->GetOpcode()) {
             case Opcode::MUL:
                 VisitMul(instr);
@@ -25,6 +35,7 @@ void Peepholes::Run() {
             }
         }
     }
+    return graph_->GetKilledInstructionsCount() != killedBefore;
 }
 
 void Peepholes::VisitMul(SingleInstruction *inst) {
@@ -32,7 +43,7 @@ void Peepholes::VisitMul(SingleInstruction *inst) {
     BinaryRegInstr *typed = static_cast<BinaryRegInstr *>(inst);
 
     if (constFolding_.ProcessMUL(typed)) {
-        std::cout << "Folded MUL" << std::endl;
+        remark(RemarkKind::CONSTANT_FOLDED, "MUL folded", inst);
         return;
     }
     if (TryOptimizeMul(typed)) {
@@ -45,7 +56,7 @@ void Peepholes::VisitShr(SingleInstruction *inst) {
     BinaryRegInstr *typed = static_cast<BinaryRegInstr *>(inst);
 
     if (constFolding_.ProcessSHR(typed)) {
-        std::cout << "Folded SHR" << std::endl;
+        remark(RemarkKind::CONSTANT_FOLDED, "SHR folded", inst);
         return;
     }
 
@@ -73,7 +84,7 @@ bool Peepholes::TryOptimizeMul(BinaryRegInstr *inst) {
         auto *typed = static_cast<ConstInstr *>(input1.GetInstruction());
         if (typed->GetValue() == 1) {
             ReplaceWithoutNewInstr(inst, input2.GetInstruction());
-            std::cout << "Applied MUL: '0 * v' peephole" << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'1 * v' => v", inst);
             return true;
         }
     }
@@ -81,7 +92,7 @@ bool Peepholes::TryOptimizeMul(BinaryRegInstr *inst) {
         auto *typed = static_cast<ConstInstr *>(input2.GetInstruction());
         if (typed->GetValue() == 1) {
             ReplaceWithoutNewInstr(inst, input1.GetInstruction());
-            std::cout << "Applied MUL: 'v * 0' peephole" << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'v * 1' => v", inst);
             return true;
         }
     }
@@ -92,8 +103,7 @@ bool Peepholes::TryOptimizeMul(BinaryRegInstr *inst) {
         auto *typed = static_cast<ConstInstr *>(input1.GetInstruction());
         if (typed->GetValue() == 0) {
             ReplaceWithoutNewInstr(inst, input1.GetInstruction());
-            std::cout << "Applied MUL: case: v1 = 0 * v1 -> v1 = 0 peephole"
-                      << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'0 * v' => 0", inst);
         }
         return true;
     }
@@ -102,8 +112,7 @@ bool Peepholes::TryOptimizeMul(BinaryRegInstr *inst) {
         auto *typed = static_cast<ConstInstr *>(input2.GetInstruction());
         if (typed->GetValue() == 0) {
             ReplaceWithoutNewInstr(inst, input2.GetInstruction());
-            std::cout << "Applied MUL: case: v1 = v0 * 0 -> v1 = 0 peephole"
-                      << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'v * 0' => 0", inst);
         }
         return true;
     }
@@ -119,7 +128,7 @@ bool Peepholes::TryOptimizeShr(BinaryRegInstr *inst) {
         auto *typed = static_cast<ConstInstr *>(input1.GetInstruction());
         if (typed->GetValue() == 0) {
             ReplaceWithoutNewInstr(inst, typed);
-            std::cout << "Applied '0 >> v' peephole" << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'0 >> v' => 0", inst);
             return true;
         }
     }
@@ -127,7 +136,7 @@ bool Peepholes::TryOptimizeShr(BinaryRegInstr *inst) {
         auto *typed = static_cast<ConstInstr *>(input2.GetInstruction());
         if (typed->GetValue() == 0) {
             ReplaceWithoutNewInstr(inst, input1.GetInstruction());
-            std::cout << "Applied 'v >> 0' peephole" << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'v >> 0' => v", inst);
             return true;
         }
     }
@@ -139,9 +148,8 @@ bool Peepholes::TryOptimizeShr(BinaryRegInstr *inst) {
             auto *constZero =
                 graph_->GetInstructionBuilder()->BuildConst(inst->GetType(), 0);
             ReplaceWithoutNewInstr(inst, constZero);
-            std::cout << "Applied SHR: case: a >> n where n >= bit-width of a "
-                         "=> 0 peephole"
-                      << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED,
+                   "'v >> n' => 0, n is not less than the bit width", inst);
             return true;
         }
     }
@@ -158,7 +166,7 @@ bool Peepholes::TryOptimizeXor(BinaryRegInstr *inst) {
         auto *inputInstr = static_cast<ConstInstr *>(input0.GetInstruction());
         if (inputInstr->GetValue() == 0) {
             ReplaceWithoutNewInstr(inst, input1.GetInstruction());
-            std::cout << "Applied XOR: '0 ^ v' => v" << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'0 ^ v' => v", inst);
             return true;
         }
     }
@@ -166,7 +174,7 @@ bool Peepholes::TryOptimizeXor(BinaryRegInstr *inst) {
         auto *inputInstr = static_cast<ConstInstr *>(input1.GetInstruction());
         if (inputInstr->GetValue() == 0) {
             ReplaceWithoutNewInstr(inst, input0.GetInstruction());
-            std::cout << "Applied XOR: 'v ^ 0' => v" << std::endl;
+            remark(RemarkKind::PEEPHOLE_APPLIED, "'v ^ 0' => v", inst);
             return true;
         }
     }
@@ -180,8 +188,7 @@ void Peepholes::ReplaceWithoutNewInstr(BinaryRegInstr *instr,
     instr->GetInstBB()->SetInstructionAsDead(instr);
 
     // these instructions may be deleted later by DCE
-    instr->GetInput(0)->RemoveUser(instr);
-    instr->GetInput(1)->RemoveUser(instr);
+    instr->ClearInputs();
 }
 
 } // namespace ir
@@ -21,7 +21,14 @@ class Peepholes : public OptimizationPassBase {
     void VisitShr(SingleInstruction *instr);
     void VisitXor(SingleInstruction *instr);
 
-    void Run() override;
+    bool Run() override;
+    const char *GetName() const override { return "Peepholes"; }
+    AnalysisSet GetRequiredAnalyses() const override {
+        return {AnalysisKind::RPO};
+    }
+    AnalysisSet GetPreservedAnalyses() const override {
+        return AnalysisSet::All();
+    }
 
   private:
     void ReplaceWithoutNewInstr(BinaryRegInstr *instr,
@@ -0,0 +1,47 @@
+#include "remarks.h"
+#include <iomanip>
+
+namespace ir {
+
+const char *GetRemarkKindName(RemarkKind kind) {
+    static constexpr std::array<const char *,
+                                static_cast<size_t>(RemarkKind::COUNT)>
+        names{"constant folded", "peephole applied", "check removed",
+              "inlined", "inline skipped", "instr hoisted",
+              "loop unrolled", "unroll skipped", "strength reduced"};
+    assert(kind < RemarkKind::COUNT);
+    return names[static_cast<size_t>(kind)];
+}
+
+void RemarkSink::DumpCounts(std::ostream &out) const {
+    out << std::left << std::setw(20) << "remark" << std::right
+        << std::setw(10) << "count" << '\n';
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        out << std::left << std::setw(20)
+            << GetRemarkKindName(static_cast<RemarkKind>(i)) << std::right
+            << std::setw(10) << counts_[i] << '\n';
+    }
+}
+
+void StreamRemarkSink::Consume(const Remark &remark) {
+    out_ << '[' << remark.pass << "] " << GetRemarkKindName(remark.kind)
+         << ": " << remark.message;
+    if (remark.id != Remark::NO_ID) {
+        out_ << ", id = " << remark.id;
+    }
+    if (remark.value != 0 || remark.limit != 0) {
+        out_ << ", " << remark.value;
+    }
+    if (remark.limit != 0) {
+        out_ << " when limit is " << remark.limit;
+    }
+    out_ << '\n';
+}
+
+static thread_local RemarkSink *currentSink = nullptr;
+
+RemarkSink *GetRemarkSink() { return currentSink; }
+
+void SetRemarkSink(RemarkSink *sink) { currentSink = sink; }
+
+} // namespace ir
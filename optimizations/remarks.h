@@ -0,0 +1,119 @@
+#ifndef JIT_AOT_COURSE_REMARKS_H_
+#define JIT_AOT_COURSE_REMARKS_H_
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+namespace ir {
+// Transformations and decisions reported by the passes
+enum class RemarkKind : uint8_t {
+    CONSTANT_FOLDED,
+    PEEPHOLE_APPLIED,
+    CHECK_REMOVED,
+    INLINED,
+    INLINE_SKIPPED,
+    INSTR_HOISTED,
+    LOOP_UNROLLED,
+    UNROLL_SKIPPED,
+    STRENGTH_REDUCED,
+    COUNT
+};
+
+const char *GetRemarkKindName(RemarkKind kind);
+
+// Remarks are plain data, so emitting one does no formatting. The message is
+// a string literal, the numbers are described by it.
+struct Remark {
+    static constexpr size_t NO_ID = static_cast<size_t>(-1);
+
+    RemarkKind kind;
+    const char *pass;
+    const char *message;
+    // id of the instruction or the function the remark is about
+    size_t id = NO_ID;
+    size_t value = 0;
+    size_t limit = 0;
+};
+
+// Receives the remarks of the passes run on the current thread, counting
+// them by kind
+class RemarkSink {
+  public:
+    RemarkSink() = default;
+    RemarkSink(const RemarkSink &) = delete;
+    RemarkSink &operator=(const RemarkSink &) = delete;
+    RemarkSink(RemarkSink &&) = delete;
+    RemarkSink &operator=(RemarkSink &&) = delete;
+    virtual ~RemarkSink() = default;
+
+    void Emit(const Remark &remark) {
+        assert(remark.kind < RemarkKind::COUNT);
+        ++counts_[static_cast<size_t>(remark.kind)];
+        Consume(remark);
+    }
+    size_t GetCount(RemarkKind kind) const {
+        return counts_[static_cast<size_t>(kind)];
+    }
+    void DumpCounts(std::ostream &out) const;
+
+  protected:
+    // Counting sinks need not keep the remarks themselves
+    virtual void Consume([[maybe_unused]] const Remark &remark) {}
+
+  private:
+    std::array<size_t, static_cast<size_t>(RemarkKind::COUNT)> counts_{};
+};
+
+// Prints every remark as a line, without flushing the stream
+class StreamRemarkSink : public RemarkSink {
+  public:
+    explicit StreamRemarkSink(std::ostream &out) : out_(out) {}
+
+  protected:
+    void Consume(const Remark &remark) override;
+
+  private:
+    std::ostream &out_;
+};
+
+// Sink of the current thread, nullptr when remarks are not collected
+RemarkSink *GetRemarkSink();
+void SetRemarkSink(RemarkSink *sink);
+
+// Installs a sink for the current thread until the end of the scope
+class RemarkSinkScope final {
+  public:
+    explicit RemarkSinkScope(RemarkSink *sink) : previous_(GetRemarkSink()) {
+        SetRemarkSink(sink);
+    }
+    RemarkSinkScope(const RemarkSinkScope &) = delete;
+    RemarkSinkScope &operator=(const RemarkSinkScope &) = delete;
+    RemarkSinkScope(RemarkSinkScope &&) = delete;
+    RemarkSinkScope &operator=(RemarkSinkScope &&) = delete;
+    ~RemarkSinkScope() { SetRemarkSink(previous_); }
+
+  private:
+    RemarkSink *previous_;
+};
+
+// Remarks are compiled in only with OPTIMIZATION_REMARKS defined, otherwise
+// EmitRemark is empty and the passes do no work for them at all
+#ifdef OPTIMIZATION_REMARKS
+inline constexpr bool REMARKS_ENABLED = true;
+#else
+inline constexpr bool REMARKS_ENABLED = false;
+#endif
+
+inline void EmitRemark([[maybe_unused]] const Remark &remark) {
+    if constexpr (REMARKS_ENABLED) {
+        if (auto *sink = GetRemarkSink()) {
+            sink->Emit(remark);
+        }
+    }
+}
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_REMARKS_H_
@@ -1,18 +1,25 @@
 #include "staticInline.h"
-#include "domTree/dfo_rpo.h"
+#include "domTree/domTreeUpdater.h"
 #include "helperBuilderFunctions.h"
 #include "irGen/base.h"
-#include <iostream>
+#include "remarks.h"
 
 namespace ir {
-void StaticInline::Run() {
-    auto rpoBBlocks = RPO(graph_);
+bool StaticInline::Run() {
+    memory::ArenaScope scope(graph_->GetScratchAllocator());
+    // inlining splits blocks, so the cached order is copied
+    const auto &cachedRPO = graph_->GetAnalyses().GetRPO();
+    ArenaVector<BB *> rpoBBlocks(
+        cachedRPO.begin(), cachedRPO.end(),
+        graph_->GetScratchAllocator()->ToSTL(ArenaTag::BB_ORDERS));
     auto instructions_count = graph_->CountInstructions();
     if (instructions_count >= maxInstrsAfterInlining) {
-        std::cout << "Skip function due to too much instructions: "
-                  << instructions_count << std::endl;
+        EmitRemark({RemarkKind::INLINE_SKIPPED, GetName(),
+                    "caller has too many instructions", graph_->GetId(),
+                    instructions_count, maxInstrsAfterInlining});
     }
 
+    bool inlined = false;
     for (auto *bblock : rpoBBlocks) {
         for (auto *instr : *bblock) {
             if (!instr->IsCall()) {
@@ -28,15 +35,17 @@ void StaticInline::Run() {
             auto *copyGraph = graph_->GetCompiler()->CopyGraph(
                 calleeGraph, graph_->GetInstructionBuilder());
             DoInlining(call, copyGraph);
+            inlined = true;
         }
     }
+    return inlined;
 }
 
 Graph *StaticInline::PossibleToInlineFunction(CallInstr *call,
                                               size_t callerInstrsCount) {
     if (call->IsInlined()) {
-        std::cout << "Already inlined, skipping. id = " << call->GetCallTarget()
-                  << std::endl;
+        EmitRemark({RemarkKind::INLINE_SKIPPED, GetName(), "already inlined",
+                    call->GetCallTarget()});
         return nullptr;
     }
 
@@ -44,8 +53,8 @@ Graph *StaticInline::PossibleToInlineFunction(CallInstr *call,
     // already having a Graph for the callee function
     auto *callee = graph_->GetCompiler()->GetFunction(call->GetCallTarget());
     if (callee == nullptr) {
-        std::cout << "No IR graph found, skipping. id = "
-                  << call->GetCallTarget() << std::endl;
+        EmitRemark({RemarkKind::INLINE_SKIPPED, GetName(),
+                    "no IR graph found", call->GetCallTarget()});
         return nullptr;
     }
     if (callee == graph_) {
@@ -54,15 +63,16 @@ Graph *StaticInline::PossibleToInlineFunction(CallInstr *call,
 
     auto size_ = callee->CountInstructions();
     if (size_ >= maxCalleeInstrs) {
-        std::cout << "Too many instructions: " << size_ << " when limit is "
-                  << maxCalleeInstrs << ". id = " << call->GetCallTarget()
-                  << std::endl;
+        EmitRemark({RemarkKind::INLINE_SKIPPED, GetName(),
+                    "callee has too many instructions", call->GetCallTarget(),
+                    size_, maxCalleeInstrs});
         return nullptr;
     }
     if (callerInstrsCount + size_ >= maxInstrsAfterInlining) {
-        std::cout << "Too many instructions after inlining: "
-                  << callerInstrsCount + size_ << " when limit is "
-                  << maxInstrsAfterInlining << std::endl;
+        EmitRemark({RemarkKind::INLINE_SKIPPED, GetName(),
+                    "too many instructions after inlining",
+                    call->GetCallTarget(), callerInstrsCount + size_,
+                    maxInstrsAfterInlining});
         return nullptr;
     }
 
@@ -72,13 +82,22 @@ Graph *StaticInline::PossibleToInlineFunction(CallInstr *call,
 void StaticInline::DoInlining(CallInstr *call, Graph *callee) {
     assert((call) && (callee));
 
+    // the callee is spliced into the dominator tree instead of rebuilding it
+    bool isDomTreeValid =
+        graph_->GetAnalyses().IsValid(AnalysisKind::DOM_TREE);
+    auto *calleeEntry = callee->GetFirstBB();
     auto blocks = call->GetInstBB()->SplitAfterInstruction(call, false);
     PropagateArgs(call, callee);
     PropagateReturnValue(call, callee, blocks.second);
     call->GetInstBB()->SetInstructionAsDead(call);
 
     InlineReadyGraph(callee, blocks.first, blocks.second);
-    std::cout << "Inlined function #" << callee->GetId() << std::endl;
+    if (isDomTreeValid) {
+        DomTreeUpdater(graph_).SpliceSubgraph(blocks.first, calleeEntry,
+                                              blocks.second);
+    }
+    EmitRemark({RemarkKind::INLINED, GetName(), "function inlined",
+                callee->GetId()});
 }
 
 void StaticInline::PropagateArgs(CallInstr *call, Graph *callee) {
@@ -117,7 +136,7 @@ void StaticInline::PropagateReturnValue(CallInstr *call, Graph *callee,
             auto *retInstr = static_cast<RetInstr *>(instr);
             auto phiInput = retInstr->GetInput(0);
             phiReturnValue->AddPhiInput(phiInput, phiInput->GetInstBB());
-            phiInput->ReplaceUser(retInstr, phiReturnValue);
+            retInstr->ClearInputs();
             pred->SetInstructionAsDead(retInstr);
         }
         postCallBlock->PushInstForward(phiReturnValue);
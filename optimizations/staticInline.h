@@ -14,7 +14,15 @@ class StaticInline : public OptimizationPassBase {
         assert(maxCalleeInstrs < maxInstrsAfterInlining);
     }
 
-    void Run() override;
+    bool Run() override;
+    const char *GetName() const override { return "StaticInline"; }
+    AnalysisSet GetRequiredAnalyses() const override {
+        return {AnalysisKind::RPO};
+    }
+    // a valid dominator tree is updated by the inlining
+    AnalysisSet GetPreservedAnalyses() const override {
+        return {AnalysisKind::DOM_TREE};
+    }
 
   private:
     Graph *PossibleToInlineFunction(CallInstr *call, size_t callerInstrsCount);
@@ -0,0 +1,200 @@
+#include "strengthReduction.h"
+#include "domTree/loop.h"
+#include "graph.h"
+#include "irGen/helperBuilderFunctions.h"
+#include "remarks.h"
+
+namespace ir {
+namespace {
+uint64_t GetConstValue(SingleInstruction *instr) {
+    assert((instr) && instr->IsConst());
+    return static_cast<ConstInstr *>(instr)->GetValue();
+}
+
+bool IsMultiplication(const SingleInstruction *instr) {
+    return instr->GetOpcode() == Opcode::MUL ||
+           instr->GetOpcode() == Opcode::MULI;
+}
+} // namespace
+
+bool LoopStrengthReduction::Run() {
+    reducedCount_ = 0;
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    auto *loops = graph_->GetLoopTree()->GetLoopsOuterFirst(allocator);
+    // inner loops are visited first
+    for (auto it = loops->rbegin(); it != loops->rend(); ++it) {
+        ReduceInLoop(*it);
+    }
+    return reducedCount_ != 0;
+}
+
+void LoopStrengthReduction::ReduceInLoop(Loop *loop) {
+    assert(loop);
+    auto *allocator = graph_->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    InductionVariables variables(loop, allocator);
+    preHeader_ = nullptr;
+    latch_ = nullptr;
+    initialValues_ = allocator->template NewUnorderedMap<size_t,
+                                                         SingleInstruction *>();
+    increments_ = allocator->template NewUnorderedMap<size_t,
+                                                      SingleInstruction *>();
+    auto *phis = allocator->template NewVector<PhiInstr *>();
+    // the values derived from a reduced multiplication are visited after it
+    for (const auto &variable : variables.GetVariables()) {
+        if (variable.IsBasic() || !IsMultiplication(variable.instr)) {
+            continue;
+        }
+        if (preHeader_ == nullptr) {
+            preHeader_ = loop->GetOrCreatePreHeader();
+            latch_ = loop->GetBackEdges()[0];
+        }
+        phis->push_back(Reduce(variables, variable));
+    }
+    if (!phis->empty()) {
+        RemoveDeadValues(variables, *phis);
+    }
+    initialValues_ = nullptr;
+    increments_ = nullptr;
+}
+
+PhiInstr *
+LoopStrengthReduction::Reduce(const InductionVariables &variables,
+                              const InductionVariable &variable) {
+    auto *instr = variable.instr;
+    auto type = instr->GetType();
+    auto *initial = GetInitialValue(variables, variable);
+    auto *increment = GetIncrement(variables, variable);
+
+    auto *builder = graph_->GetInstructionBuilder();
+    auto *phi = builder->BuildPhi(type);
+    variables.GetLoop()->GetHeader()->PushInstForward(phi);
+    auto *next = increment->IsConst()
+                     ? builder->BuildAddi(type, phi, GetConstValue(increment))
+                     : builder->BuildAdd(type, phi, increment);
+    InsertBeforeTerminator(latch_, next);
+    phi->AddPhiInput(initial, preHeader_);
+    phi->AddPhiInput(next, latch_);
+
+    auto id = instr->GetInstID();
+    instr->ReplaceInputInUsers(phi);
+    instr->GetInstBB()->KillInstruction(instr);
+    ++reducedCount_;
+    EmitRemark({RemarkKind::STRENGTH_REDUCED, GetName(),
+                "multiplication replaced with a recurrence", id});
+    return phi;
+}
+
+SingleInstruction *
+LoopStrengthReduction::GetInitialValue(const InductionVariables &variables,
+                                       const InductionVariable &variable) {
+    if (variable.IsBasic()) {
+        // the other input of the phi comes from the preheader
+        auto *phi = variable.basis;
+        return phi->GetInput(1 - variable.baseIdx).GetInstruction();
+    }
+    auto id = variable.instr->GetInstID();
+    auto it = initialValues_->find(id);
+    if (it != initialValues_->end()) {
+        return it->second;
+    }
+    const auto *base = variables.Find(variable.base);
+    assert(base);
+    auto *baseValue = GetInitialValue(variables, *base);
+    // the same operation applied to the initial value of the base
+    auto *copy = static_cast<InputsInstr *>(variable.instr->Copy(preHeader_));
+    copy->SetInput(baseValue, variable.baseIdx);
+    InsertBeforeTerminator(preHeader_, copy);
+    initialValues_->insert({id, copy});
+    return copy;
+}
+
+SingleInstruction *
+LoopStrengthReduction::GetIncrement(const InductionVariables &variables,
+                                    const InductionVariable &variable) {
+    if (variable.IsBasic()) {
+        return variable.invariant;
+    }
+    auto id = variable.instr->GetInstID();
+    auto it = increments_->find(id);
+    if (it != increments_->end()) {
+        return it->second;
+    }
+    const auto *base = variables.Find(variable.base);
+    assert(base);
+    auto *increment = GetIncrement(variables, *base);
+    // adding an invariant keeps the step of the base, multiplying scales it
+    if (IsMultiplication(variable.instr)) {
+        increment = Multiply(increment, variable.invariant,
+                             variable.instr->GetType());
+    }
+    increments_->insert({id, increment});
+    return increment;
+}
+
+SingleInstruction *LoopStrengthReduction::Multiply(SingleInstruction *lhs,
+                                                   SingleInstruction *rhs,
+                                                   InstType type) {
+    assert((lhs) && (rhs));
+    // steps of 1 are common, multiplying by them is skipped
+    if (lhs->IsConst() && GetConstValue(lhs) == 1) {
+        return rhs;
+    }
+    if (rhs->IsConst() && GetConstValue(rhs) == 1) {
+        return lhs;
+    }
+    auto *builder = graph_->GetInstructionBuilder();
+    SingleInstruction *product = nullptr;
+    if (lhs->IsConst() && rhs->IsConst()) {
+        product =
+            builder->BuildConst(type, GetConstValue(lhs) * GetConstValue(rhs));
+    } else if (lhs->IsConst() || rhs->IsConst()) {
+        auto *constant = lhs->IsConst() ? lhs : rhs;
+        auto *other = lhs->IsConst() ? rhs : lhs;
+        product = builder->BuildMuli(type, other, GetConstValue(constant));
+    } else {
+        product = builder->BuildMul(type, lhs, rhs);
+    }
+    InsertBeforeTerminator(preHeader_, product);
+    return product;
+}
+
+void LoopStrengthReduction::RemoveDeadValues(
+    const InductionVariables &variables, const ArenaVector<PhiInstr *> &phis) {
+    // a recurrence used only by its own update was replaced by the ones
+    // derived from it
+    for (auto *phi : phis) {
+        auto *next = phi->GetInput(1).GetInstruction();
+        if (phi->UsersCount() == 1 && next->UsersCount() == 1) {
+            phi->GetInstBB()->KillInstruction(phi);
+            next->GetInstBB()->KillInstruction(next);
+        }
+    }
+    // users are visited before the values they are derived from
+    const auto &all = variables.GetVariables();
+    for (auto it = all.rbegin(); it != all.rend(); ++it) {
+        auto *instr = it->instr;
+        if (!it->IsBasic() && instr->GetInstBB() != nullptr &&
+            instr->UsersCount() == 0) {
+            instr->GetInstBB()->KillInstruction(instr);
+        }
+    }
+}
+
+void LoopStrengthReduction::InsertBeforeTerminator(BB *bblock,
+                                                   SingleInstruction *instr) {
+    assert((bblock) && (instr));
+    auto *last = bblock->GetLastInstBB();
+    if (last == nullptr || !last->SatisfiesProperty(InstrProp::JUMP)) {
+        bblock->PushInstBackward(instr);
+        return;
+    }
+    // conditional jumps read the flags set by the compare right before them
+    auto *prev = last->GetPrevInst();
+    if (prev != nullptr && prev->GetOpcode() == Opcode::CMP) {
+        last = prev;
+    }
+    bblock->InsertSingleInstrBefore(last, instr);
+}
+} // namespace ir
@@ -0,0 +1,61 @@
+#ifndef JIT_AOT_COURSE_STRENGTH_REDUCTION_H_
+#define JIT_AOT_COURSE_STRENGTH_REDUCTION_H_
+
+#include "domTree/inductionVariables.h"
+#include "pass.h"
+
+namespace ir {
+// Replaces multiplications of induction variables by loop invariants with
+// additive recurrences: a new header phi starts from the product computed in
+// the preheader and is increased by the product of the steps on the back
+// edge. Array indices scaled by a stride are reduced the same way, so the
+// loads and stores index with the recurrence.
+class LoopStrengthReduction : public OptimizationPassBase {
+  public:
+    explicit LoopStrengthReduction(Graph *graph)
+        : OptimizationPassBase(graph) {}
+    ~LoopStrengthReduction() noexcept override = default;
+
+    bool Run() override;
+    const char *GetName() const override { return "StrengthReduction"; }
+    AnalysisSet GetRequiredAnalyses() const override {
+        return {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE};
+    }
+    // only instructions are added besides the preheaders, which are created
+    // keeping both trees valid
+    AnalysisSet GetPreservedAnalyses() const override {
+        return {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE};
+    }
+
+    size_t GetReducedCount() const { return reducedCount_; }
+
+  private:
+    using Values = ArenaUnorderedMap<size_t, SingleInstruction *>;
+
+    void ReduceInLoop(Loop *loop);
+    PhiInstr *Reduce(const InductionVariables &variables,
+                     const InductionVariable &variable);
+    SingleInstruction *GetInitialValue(const InductionVariables &variables,
+                                       const InductionVariable &variable);
+    SingleInstruction *GetIncrement(const InductionVariables &variables,
+                                    const InductionVariable &variable);
+    SingleInstruction *Multiply(SingleInstruction *lhs,
+                                SingleInstruction *rhs, InstType type);
+    void RemoveDeadValues(const InductionVariables &variables,
+                          const ArenaVector<PhiInstr *> &phis);
+    void InsertBeforeTerminator(BB *bblock, SingleInstruction *instr);
+
+  private:
+    size_t reducedCount_ = 0;
+
+    // state of the loop being reduced
+    BB *preHeader_ = nullptr;
+    BB *latch_ = nullptr;
+    // values of the derived variables on the first iteration and their
+    // increments, computed in the preheader
+    Values *initialValues_ = nullptr;
+    Values *increments_ = nullptr;
+};
+} // namespace ir
+
+#endif // JIT_AOT_COURSE_STRENGTH_REDUCTION_H_
@@ -0,0 +1,141 @@
+#include "analysisManager.h"
+#include "loop.h"
+#include "optimizations/checkElimination.h"
+#include "optimizations/peepholes.h"
+#include "testBase.h"
+
+namespace ir::tests {
+class AnalysisManagerTest : public TestBase {
+  public:
+    // 0 -> 1 -> {2, 3} -> 4, with a back edge 4 -> 1
+    std::vector<BB *> BuildLoopGraph() {
+        std::vector<BB *> bblocks(5);
+        auto *graph = GetGraph();
+        for (auto &it : bblocks) {
+            it = graph->CreateEmptyBB();
+        }
+        graph->SetFirstBB(bblocks[0]);
+        graph->ConnectBBs(bblocks[0], bblocks[1]);
+        graph->ConnectBBs(bblocks[1], bblocks[2]);
+        graph->ConnectBBs(bblocks[1], bblocks[3]);
+        graph->ConnectBBs(bblocks[2], bblocks[4]);
+        graph->ConnectBBs(bblocks[3], bblocks[4]);
+        graph->ConnectBBs(bblocks[4], bblocks[1]);
+        return bblocks;
+    }
+};
+
+TEST_F(AnalysisManagerTest, TestCaching) {
+    auto bblocks = BuildLoopGraph();
+    auto &analyses = GetGraph()->GetAnalyses();
+    ASSERT_TRUE(analyses.GetValid().IsEmpty());
+
+    const auto &rpo = analyses.GetRPO();
+    ASSERT_EQ(rpo.size(), bblocks.size());
+    ASSERT_EQ(rpo.front(), bblocks[0]);
+    ASSERT_EQ(&analyses.GetRPO(), &rpo);
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::RPO), 1);
+
+    // the loop tree pulls the dominator tree, which is then reused
+    auto *rootLoop = analyses.GetLoopTree();
+    ASSERT_NE(rootLoop, nullptr);
+    analyses.RequireDomTree();
+    ASSERT_EQ(analyses.GetLoopTree(), rootLoop);
+    ASSERT_EQ(analyses.GetValid(), ~AnalysisSet{AnalysisKind::POST_DOM_TREE});
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 1);
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::LOOP_TREE), 1);
+    ASSERT_EQ(bblocks[4]->GetDominator(), bblocks[1]);
+    ASSERT_EQ(bblocks[4]->GetLoop()->GetHeader(), bblocks[1]);
+
+    // the post-dominator tree is independent of the dominator tree
+    GetGraph()->SetLastBB(bblocks[4]);
+    analyses.RequirePostDomTree();
+    analyses.RequirePostDomTree();
+    ASSERT_EQ(analyses.GetValid(), AnalysisSet::All());
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::POST_DOM_TREE), 1);
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 1);
+    ASSERT_EQ(bblocks[1]->GetPostDominator(), bblocks[4]);
+}
+
+TEST_F(AnalysisManagerTest, TestInvalidation) {
+    auto bblocks = BuildLoopGraph();
+    auto *graph = GetGraph();
+    auto &analyses = graph->GetAnalyses();
+    analyses.Require(AnalysisSet::All());
+
+    // dominator edits keep the CFG based results
+    bblocks[4]->SetDominator(bblocks[1]);
+    ASSERT_EQ(analyses.GetValid(),
+              (AnalysisSet{AnalysisKind::RPO, AnalysisKind::POST_DOM_TREE,
+                           AnalysisKind::LOOP_TREE}));
+    analyses.RequireDomTree();
+
+    // a new edge makes 2 a loop header, it is found once the loop tree is
+    // recomputed, while the dominator tree is updated in place
+    graph->ConnectBBs(bblocks[3], bblocks[2]);
+    ASSERT_EQ(analyses.GetValid(), AnalysisSet{AnalysisKind::DOM_TREE});
+    ASSERT_FALSE(graph->IsDomTreeNumbered());
+    auto *rootLoop = analyses.GetLoopTree();
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 2);
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::LOOP_TREE), 2);
+    ASSERT_EQ(rootLoop->GetInnerLoops().size(), 1);
+    ASSERT_EQ(bblocks[4]->GetDominator(), bblocks[1]);
+    ASSERT_EQ(bblocks[2]->GetDominator(), bblocks[1]);
+    analyses.RequireDomTree();
+    ASSERT_TRUE(graph->IsDomTreeNumbered());
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 2);
+
+    analyses.Require(AnalysisSet::All());
+    auto *newBBlock = graph->CreateEmptyBB();
+    ASSERT_EQ(analyses.GetValid(), AnalysisSet{AnalysisKind::DOM_TREE});
+    ASSERT_EQ(newBBlock->GetDominator(), nullptr);
+    graph->ConnectBBs(bblocks[0], newBBlock);
+    graph->ConnectBBs(newBBlock, bblocks[1]);
+    ASSERT_EQ(newBBlock->GetDominator(), bblocks[0]);
+    ASSERT_EQ(bblocks[1]->GetDominator(), bblocks[0]);
+    ASSERT_EQ(analyses.GetRPO().size(), bblocks.size() + 1);
+
+    analyses.Require(AnalysisSet::All());
+    graph->SetBBAsDead(newBBlock);
+    ASSERT_TRUE(analyses.GetValid().IsEmpty());
+    ASSERT_EQ(analyses.GetRPO().size(), bblocks.size());
+}
+
+TEST_F(AnalysisManagerTest, TestSplitInvalidates) {
+    auto bblocks = BuildLoopGraph();
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *arg = instrBuilder->BuildArg(InstType::i32);
+    auto *add = instrBuilder->BuildAdd(InstType::i32, arg, arg);
+    instrBuilder->PushBackInst(bblocks[0], arg);
+    instrBuilder->PushBackInst(bblocks[0], add);
+
+    auto &analyses = graph->GetAnalyses();
+    analyses.Require(AnalysisSet::All());
+    auto [first, second] = bblocks[0]->SplitAfterInstruction(arg, false);
+    ASSERT_TRUE(analyses.GetValid().IsEmpty());
+    graph->ConnectBBs(first, second);
+    analyses.RequireDomTree();
+    ASSERT_EQ(second->GetDominator(), first);
+    ASSERT_EQ(bblocks[1]->GetDominator(), second);
+}
+
+TEST_F(AnalysisManagerTest, TestPassesShareAnalyses) {
+    auto bblocks = BuildLoopGraph();
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *arg = instrBuilder->BuildArg(InstType::i32);
+    auto *mul = instrBuilder->BuildMul(InstType::i32, arg, arg);
+    instrBuilder->PushBackInst(bblocks[0], arg);
+    instrBuilder->PushBackInst(bblocks[2], mul);
+
+    for (size_t i = 0; i < 10; ++i) {
+        Peepholes(graph).Apply();
+        CheckElimination(graph).Apply();
+    }
+    auto &analyses = graph->GetAnalyses();
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::RPO), 1);
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 1);
+}
+
+} // namespace ir::tests
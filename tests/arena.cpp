@@ -0,0 +1,366 @@
+#include "domTree/arena.h"
+#include "domTree/dfo_rpo.h"
+#include "domTree/domTree.h"
+#include "optimizations/checkElimination.h"
+#include "optimizations/peepholes.h"
+#include "testBase.h"
+#include <sstream>
+#include <thread>
+
+namespace ir::tests {
+class ArenaTest : public TestBase {};
+
+TEST_F(ArenaTest, TestRollbackInSingleArena) {
+    memory::ArenaAllocator allocator;
+    auto freeSize = allocator.GetFreeSize();
+    auto checkpoint = allocator.GetCheckpoint();
+
+    auto *array = allocator.AllocateArray<uint64_t>(32);
+    ASSERT_NE(array, nullptr);
+    ASSERT_LT(allocator.GetFreeSize(), freeSize);
+
+    allocator.Rollback(checkpoint);
+    ASSERT_EQ(allocator.GetFreeSize(), freeSize);
+    // released memory is reused by the next allocation
+    ASSERT_EQ(allocator.AllocateArray<uint64_t>(32), array);
+}
+
+TEST_F(ArenaTest, TestRollbackReleasesArenas) {
+    memory::ArenaAllocator allocator;
+    auto *persistent = allocator.New<uint64_t>(42);
+    auto freeSize = allocator.GetFreeSize();
+    auto arenasCount = allocator.GetArenasCount();
+
+    auto checkpoint = allocator.GetCheckpoint();
+    for (size_t i = 0; i < 16; ++i) {
+        ASSERT_NE(allocator.AllocateArray<uint8_t>(
+                      memory::ArenaAllocator::DEFAULT_ARENA_SIZE / 2),
+                  nullptr);
+    }
+    ASSERT_GT(allocator.GetArenasCount(), arenasCount);
+
+    allocator.Rollback(checkpoint);
+    ASSERT_EQ(allocator.GetArenasCount(), arenasCount);
+    ASSERT_EQ(allocator.GetFreeSize(), freeSize);
+    ASSERT_EQ(*persistent, 42);
+}
+
+TEST_F(ArenaTest, TestNestedScopes) {
+    memory::ArenaAllocator allocator;
+    auto freeSize = allocator.GetFreeSize();
+    {
+        memory::ArenaScope outer(&allocator);
+        auto *outerVector = allocator.NewVector<size_t>();
+        outerVector->reserve(8);
+        auto outerFreeSize = allocator.GetFreeSize();
+        {
+            memory::ArenaScope inner(&allocator);
+            auto *innerVector = allocator.NewVector<size_t>();
+            innerVector->resize(4096, 0);
+            ASSERT_GT(allocator.GetArenasCount(), 1);
+        }
+        ASSERT_EQ(allocator.GetArenasCount(), 1);
+        ASSERT_EQ(allocator.GetFreeSize(), outerFreeSize);
+    }
+    ASSERT_EQ(allocator.GetFreeSize(), freeSize);
+}
+
+TEST_F(ArenaTest, TestGeometricGrowth) {
+    constexpr size_t PAGE = memory::ArenaAllocator::PAGE_SIZE;
+    memory::ArenaAllocator allocator(
+        memory::ArenaGrowthPolicy{PAGE, 4 * PAGE, 2, false});
+    ASSERT_EQ(allocator.GetFreeSize(), PAGE);
+
+    // exhaust the current arena and check the size of the next one
+    auto expectNextArenaSize = [&allocator](size_t expected) {
+        ASSERT_NE(allocator.AllocateArray<uint8_t>(allocator.GetFreeSize()),
+                  nullptr);
+        ASSERT_NE(allocator.New<uint64_t>(0), nullptr);
+        ASSERT_EQ(allocator.GetFreeSize(), expected - sizeof(uint64_t));
+    };
+    expectNextArenaSize(2 * PAGE);
+    expectNextArenaSize(4 * PAGE);
+    // capped by the policy
+    expectNextArenaSize(4 * PAGE);
+    ASSERT_EQ(allocator.GetStats().mmapCalls, 4);
+}
+
+TEST_F(ArenaTest, TestOversizedAllocation) {
+    constexpr size_t PAGE = memory::ArenaAllocator::PAGE_SIZE;
+    memory::ArenaAllocator allocator(
+        memory::ArenaGrowthPolicy{PAGE, 2 * PAGE, 2, false});
+    auto *huge = allocator.AllocateArray<uint8_t>(64 * PAGE);
+    ASSERT_NE(huge, nullptr);
+    ASSERT_EQ(allocator.GetArenasCount(), 2);
+
+    // the following regular arenas keep the policy's sizes
+    ASSERT_NE(allocator.AllocateArray<uint8_t>(allocator.GetFreeSize() + 1),
+              nullptr);
+    ASSERT_EQ(allocator.GetArenasCount(), 3);
+    ASSERT_LT(allocator.GetFreeSize(), 2 * PAGE);
+}
+
+TEST_F(ArenaTest, TestHugePagesArena) {
+    constexpr size_t HUGE_PAGE = memory::ArenaAllocator::HUGE_PAGE_SIZE;
+    memory::ArenaAllocator allocator(
+        memory::ArenaGrowthPolicy{HUGE_PAGE, HUGE_PAGE, 1, true});
+    auto *data = allocator.AllocateArray<uint8_t>(HUGE_PAGE / 2);
+    ASSERT_NE(data, nullptr);
+    // backing memory must be aligned to be eligible for huge pages
+    ASSERT_EQ(memory::UintptrT(data) % HUGE_PAGE, 0);
+    ASSERT_EQ(allocator.GetStats().madviseCalls, 1);
+    data[HUGE_PAGE / 2 - 1] = 1;
+}
+
+TEST_F(ArenaTest, TestRepeatedRPODoesNotLeakScratch) {
+    auto *graph = GetGraph();
+    std::vector<BB *> bblocks(64);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    for (size_t i = 0; i + 1 < bblocks.size(); ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+    }
+
+    auto *allocator = graph->GetScratchAllocator();
+    for (size_t i = 0; i < 100; ++i) {
+        memory::ArenaScope scope(allocator);
+        // start from a fresh arena to make the layout predictable
+        ASSERT_NE(allocator->AllocateArray<uint8_t>(allocator->GetFreeSize()),
+                  nullptr);
+        auto rpo = RPO(graph);
+        ASSERT_EQ(rpo.size(), bblocks.size());
+        // the traversal's scratch memory must have been released, so the next
+        // allocation directly follows the result
+        auto *next = allocator->AllocateArray<BB *>(1);
+        ASSERT_EQ(next, rpo.data() + rpo.capacity());
+    }
+}
+
+TEST_F(ArenaTest, TestRepeatedPassesKeepGraphArenaBounded) {
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    std::vector<BB *> bblocks(4);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[0], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+    auto *arg = instrBuilder->BuildArg(InstType::i32);
+    auto *add = instrBuilder->BuildAdd(InstType::i32, arg, arg);
+    instrBuilder->PushBackInst(bblocks[0], arg);
+    instrBuilder->PushBackInst(bblocks[3], add);
+
+    auto *allocator = graph->GetAllocator();
+    auto *scratch = graph->GetScratchAllocator();
+    // the first run allocates the cached analyses in the graph's arena
+    DomTreeBuilder().Construct(graph);
+    Peepholes(graph).Run();
+    auto freeSize = allocator->GetFreeSize();
+    auto arenasCount = allocator->GetArenasCount();
+    auto scratchFreeSize = scratch->GetFreeSize();
+
+    for (size_t i = 0; i < 100; ++i) {
+        DomTreeBuilder().Construct(graph);
+        Peepholes(graph).Run();
+        CheckElimination(graph).Eliminate(graph);
+    }
+    ASSERT_EQ(allocator->GetFreeSize(), freeSize);
+    ASSERT_EQ(allocator->GetArenasCount(), arenasCount);
+    ASSERT_EQ(scratch->GetFreeSize(), scratchFreeSize);
+    ASSERT_EQ(bblocks[3]->GetDominator(), bblocks[0]);
+    ASSERT_EQ(bblocks[0]->GetDominatedBBs().size(), 3);
+}
+
+TEST_F(ArenaTest, TestScratchReset) {
+    auto *scratch = GetGraph()->GetScratchAllocator();
+    auto freeSize = scratch->GetFreeSize();
+    for (size_t i = 0; i < 64; ++i) {
+        ASSERT_NE(scratch->AllocateArray<uint64_t>(1024), nullptr);
+    }
+    ASSERT_GT(scratch->GetArenasCount(), 1);
+    GetGraph()->ResetScratchAllocator();
+    ASSERT_EQ(scratch->GetArenasCount(), 1);
+    ASSERT_EQ(scratch->GetFreeSize(), freeSize);
+}
+
+TEST_F(ArenaTest, TestTypeAlignment) {
+    struct alignas(memory::ArenaAllocator::CACHE_LINE_SIZE) Aligned {
+        uint64_t value;
+    };
+    memory::ArenaAllocator allocator;
+    // misalign the bump pointer
+    ASSERT_NE(allocator.New<uint8_t>(1), nullptr);
+
+    auto *object = allocator.New<Aligned>(Aligned{42});
+    ASSERT_EQ(memory::UintptrT(object) % alignof(Aligned), 0);
+    ASSERT_EQ(object->value, 42);
+    ASSERT_NE(allocator.New<uint8_t>(1), nullptr);
+    auto *array = allocator.AllocateArray<Aligned>(3);
+    ASSERT_EQ(memory::UintptrT(array) % alignof(Aligned), 0);
+
+    // containers get properly aligned storage too
+    auto *vector = allocator.NewVector<Aligned>();
+    vector->resize(5);
+    ASSERT_EQ(memory::UintptrT(vector->data()) % alignof(Aligned), 0);
+}
+
+TEST_F(ArenaTest, TestAlignedAllocation) {
+    constexpr size_t CACHE_LINE = memory::ArenaAllocator::CACHE_LINE_SIZE;
+    constexpr size_t PAGE = memory::ArenaAllocator::PAGE_SIZE;
+    memory::ArenaAllocator allocator;
+    ASSERT_NE(allocator.New<uint8_t>(1), nullptr);
+
+    auto *table = allocator.AllocateAlignedArray<uint64_t>(16, CACHE_LINE);
+    ASSERT_EQ(memory::UintptrT(table) % CACHE_LINE, 0);
+    ASSERT_NE(allocator.New<uint8_t>(1), nullptr);
+    auto *row = allocator.AllocateAligned(3, CACHE_LINE);
+    ASSERT_EQ(memory::UintptrT(row) % CACHE_LINE, 0);
+    // padding is reserved when the alignment does not fit into the arena
+    auto *page = allocator.AllocateAligned(PAGE, PAGE);
+    ASSERT_EQ(memory::UintptrT(page) % PAGE, 0);
+    auto *hugeAligned = allocator.AllocateAligned(8, 4 * PAGE);
+    ASSERT_EQ(memory::UintptrT(hugeAligned) % (4 * PAGE), 0);
+}
+
+TEST_F(ArenaTest, TestChunkCacheReuse) {
+    auto *released = new memory::ArenaAllocator();
+    ASSERT_NE(released->AllocateArray<uint8_t>(released->GetFreeSize() + 1),
+              nullptr);
+    ASSERT_EQ(released->GetArenasCount(), 2);
+    delete released;
+
+    // the released chunks are taken from the cache instead of mmap
+    memory::ArenaAllocator allocator;
+    ASSERT_NE(allocator.AllocateArray<uint8_t>(allocator.GetFreeSize() + 1),
+              nullptr);
+    ASSERT_EQ(allocator.GetStats().mmapCalls, 0);
+    ASSERT_EQ(allocator.GetStats().chunkCacheHits, 2);
+    ASSERT_EQ(allocator.GetStats().chunkCacheMisses, 0);
+
+    // explicit policies opt in
+    constexpr size_t PAGE = memory::ArenaAllocator::PAGE_SIZE;
+    memory::ArenaAllocator uncached(
+        memory::ArenaGrowthPolicy{PAGE, PAGE, 1, false});
+    ASSERT_EQ(uncached.GetStats().mmapCalls, 1);
+    ASSERT_EQ(uncached.GetStats().chunkCacheHits, 0);
+}
+
+TEST_F(ArenaTest, TestConcurrentArenas) {
+    constexpr size_t THREADS_COUNT = 8;
+    constexpr size_t ITERATIONS_COUNT = 200;
+    constexpr size_t ARRAYS_COUNT = 8;
+    constexpr size_t ARRAY_SIZE = 1024;
+    auto &cache = memory::ChunkCache::Get();
+    auto misses = cache.GetMisses();
+
+    std::vector<std::thread> threads;
+    std::vector<uint8_t> corrupted(THREADS_COUNT, 0);
+    for (size_t id = 0; id < THREADS_COUNT; ++id) {
+        threads.emplace_back([id, &corrupted]() {
+            auto *threadAllocator = memory::GetThreadLocalAllocator();
+            for (size_t i = 0; i < ITERATIONS_COUNT; ++i) {
+                memory::ArenaScope scope(threadAllocator);
+                memory::ArenaAllocator allocator;
+                std::vector<uint64_t *> arrays;
+                for (size_t j = 0; j < ARRAYS_COUNT; ++j) {
+                    auto *target = j % 2 ? &allocator : threadAllocator;
+                    auto *array = target->AllocateArray<uint64_t>(ARRAY_SIZE);
+                    std::fill_n(array, ARRAY_SIZE, id * ARRAYS_COUNT + j);
+                    arrays.push_back(array);
+                }
+                for (size_t j = 0; j < ARRAYS_COUNT; ++j) {
+                    if (std::ranges::count(std::span(arrays[j], ARRAY_SIZE),
+                                           id * ARRAYS_COUNT + j) !=
+                        ARRAY_SIZE) {
+                        corrupted[id] = 1;
+                    }
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(std::ranges::count(corrupted, 1), 0);
+    // chunks are mapped only while the cache is warming up
+    ASSERT_LT(cache.GetMisses() - misses,
+              THREADS_COUNT * ITERATIONS_COUNT / 10);
+}
+
+#ifdef ARENA_ALLOCATION_TAGS
+TEST_F(ArenaTest, TestAllocationTags) {
+    memory::ArenaAllocator allocator;
+    ASSERT_NE(allocator.New<uint64_t>(1), nullptr);
+    ASSERT_NE(allocator.NewWithTag<uint64_t>(memory::ArenaTag::LOOP_INFO, 2),
+              nullptr);
+    {
+        memory::ArenaTagScope scope(&allocator, memory::ArenaTag::COPY_MAPS);
+        ASSERT_NE(allocator.AllocateArray<uint32_t>(4), nullptr);
+        // explicit tags take precedence over the scope's one
+        memory::ArenaVector<uint8_t> vector(
+            allocator.ToSTL(memory::ArenaTag::BB_ORDERS));
+        vector.resize(16);
+    }
+    ASSERT_NE(allocator.New<uint64_t>(3), nullptr);
+
+    const auto &untagged = allocator.GetTagStats(memory::ArenaTag::UNTAGGED);
+    ASSERT_EQ(untagged.objects, 2);
+    ASSERT_EQ(untagged.bytes, 2 * sizeof(uint64_t));
+    const auto &loops = allocator.GetTagStats(memory::ArenaTag::LOOP_INFO);
+    ASSERT_EQ(loops.objects, 1);
+    ASSERT_EQ(loops.bytes, sizeof(uint64_t));
+    ASSERT_EQ(allocator.GetTagStats(memory::ArenaTag::COPY_MAPS).bytes,
+              4 * sizeof(uint32_t));
+    ASSERT_EQ(allocator.GetTagStats(memory::ArenaTag::BB_ORDERS).bytes, 16);
+
+    std::stringstream dump;
+    allocator.DumpTagStats(dump);
+    ASSERT_NE(dump.str().find("loop info"), std::string::npos);
+    ASSERT_EQ(dump.str().find("phi sources"), std::string::npos);
+
+    allocator.Reset();
+    ASSERT_EQ(allocator.GetTagStats(memory::ArenaTag::LOOP_INFO).objects, 0);
+}
+
+TEST_F(ArenaTest, TestGraphAllocationTags) {
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *allocator = graph->GetAllocator();
+    auto instrsBytes =
+        allocator->GetTagStats(memory::ArenaTag::INSTRUCTIONS).bytes;
+    auto bblocksCount =
+        allocator->GetTagStats(memory::ArenaTag::BASIC_BLOCKS).objects;
+
+    std::vector<BB *> bblocks(3);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[0], bblocks[2]);
+    auto *arg = instrBuilder->BuildArg(InstType::i32);
+    auto *add = instrBuilder->BuildAdd(InstType::i32, arg, arg);
+    instrBuilder->PushBackInst(bblocks[0], arg);
+    instrBuilder->PushBackInst(bblocks[1], add);
+    DomTreeBuilder().Construct(graph);
+
+    ASSERT_EQ(allocator->GetTagStats(memory::ArenaTag::BASIC_BLOCKS).objects,
+              bblocksCount + bblocks.size());
+    ASSERT_GE(allocator->GetTagStats(memory::ArenaTag::INSTRUCTIONS).bytes,
+              instrsBytes + sizeof(InputArgInstr) + sizeof(BinaryRegInstr));
+    ASSERT_GT(allocator->GetTagStats(memory::ArenaTag::CFG_EDGES).bytes, 0);
+    ASSERT_GT(allocator->GetTagStats(memory::ArenaTag::DOMINATED_BBS).bytes,
+              0);
+    ASSERT_GT(graph->GetScratchAllocator()
+                  ->GetTagStats(memory::ArenaTag::DOMINATOR_TABLES)
+                  .bytes,
+              0);
+}
+#endif // ARENA_ALLOCATION_TAGS
+
+} // namespace ir::tests
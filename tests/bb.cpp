@@ -169,4 +169,37 @@ TEST_F(BBTest, TestSplitAfterInstruction) {
     ASSERT_EQ(newBlock->GetLastInstBB(), jcmp);
 }
 
+TEST_F(BBTest, TestInstructionsOrder) {
+    auto *bb = GetGraph()->CreateEmptyBB();
+    auto instType = InstType::i32;
+    auto *builder = GetInstructionBuilder();
+    auto *first = builder->BuildArg(instType);
+    auto *last = builder->BuildArg(instType);
+    bb->PushInstBackward(first);
+    bb->PushInstBackward(last);
+
+    // every insertion halves the gap before the last instruction
+    std::vector<SingleInstruction *> inserted;
+    for (size_t i = 0; i < 64; ++i) {
+        auto *instr = builder->BuildArg(instType);
+        bb->InsertSingleInstrBefore(last, instr);
+        inserted.push_back(instr);
+    }
+    ASSERT_FALSE(bb->IsInstructionsOrderValid());
+    auto *phi = builder->BuildPhi(instType);
+    bb->PushInstForward(phi);
+
+    ASSERT_TRUE(phi->IsEarlierInBasicBlock(first));
+    ASSERT_TRUE(bb->IsInstructionsOrderValid());
+    std::vector<SingleInstruction *> instrs(bb->begin(), bb->end());
+    ASSERT_EQ(instrs.size(), inserted.size() + 3);
+    for (size_t i = 0; i + 1 < instrs.size(); ++i) {
+        ASSERT_TRUE(instrs[i]->IsEarlierInBasicBlock(instrs[i + 1]));
+        ASSERT_FALSE(instrs[i + 1]->IsEarlierInBasicBlock(instrs[i]));
+        ASSERT_TRUE(instrs[i]->Dominates(instrs[i + 1]));
+    }
+    ASSERT_TRUE(inserted.back()->IsEarlierInBasicBlock(last));
+    ASSERT_TRUE(inserted.front()->IsEarlierInBasicBlock(inserted.back()));
+}
+
 } // namespace ir::tests
@@ -0,0 +1,86 @@
+#include "optimizations/checkElimination.h"
+#include "testBase.h"
+
+namespace ir::tests {
+class CheckEliminationTest : public TestBase {
+  public:
+    // 0 -> 1 -> 3, 0 -> 2 -> 3, the checks are pushed by the test
+    std::vector<BB *> BuildDiamond(SingleInstruction *cond) {
+        auto *graph = GetGraph();
+        auto bblocks = CreateBlocks(4);
+        graph->ConnectBBs(bblocks[0], bblocks[1]);
+        graph->ConnectBBs(bblocks[0], bblocks[2]);
+        graph->ConnectBBs(bblocks[1], bblocks[3]);
+        graph->ConnectBBs(bblocks[2], bblocks[3]);
+
+        auto *instrBuilder = GetInstructionBuilder();
+        auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+        instrBuilder->PushBackInst(bblocks[0], zero);
+        instrBuilder->PushBackInst(
+            bblocks[0],
+            instrBuilder->BuildCmp(OPS_TYPE, Conditions::EQ, cond, zero));
+        instrBuilder->PushBackInst(bblocks[0], instrBuilder->BuildJcmp());
+        instrBuilder->PushBackInst(bblocks[3], instrBuilder->BuildRetVoid());
+        return bblocks;
+    }
+
+  public:
+    static constexpr auto OPS_TYPE = InstType::i32;
+};
+
+TEST_F(CheckEliminationTest, TestNullChecksInDiamond) {
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *cond = instrBuilder->BuildArg(OPS_TYPE);
+    auto *obj = instrBuilder->BuildArg(InstType::REF);
+    auto bblocks = BuildDiamond(cond);
+    instrBuilder->PushForwardInst(bblocks[0], obj);
+    instrBuilder->PushForwardInst(bblocks[0], cond);
+
+    // each branch removes its second check, the one visited later must not
+    // see the check removed in the other branch. The removed checks are
+    // recycled, so only the kept ones are referenced after the pass
+    auto *first = instrBuilder->BuildNullCheck(obj);
+    auto *otherFirst = instrBuilder->BuildNullCheck(obj);
+    instrBuilder->PushBackInst(bblocks[1], first);
+    instrBuilder->PushBackInst(bblocks[1], instrBuilder->BuildNullCheck(obj));
+    instrBuilder->PushBackInst(bblocks[2], otherFirst);
+    instrBuilder->PushBackInst(bblocks[2], instrBuilder->BuildNullCheck(obj));
+
+    CheckElimination(GetGraph()).Apply();
+    VerifyControlAndDataFlowGraphs(GetGraph());
+    CompareInstructions({first}, bblocks[1]);
+    CompareInstructions({otherFirst}, bblocks[2]);
+    // the removed checks are not left among the users
+    ASSERT_EQ(obj->UsersCount(), 2);
+}
+
+TEST_F(CheckEliminationTest, TestBoundsChecksInDiamond) {
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *cond = instrBuilder->BuildArg(OPS_TYPE);
+    auto *array = instrBuilder->BuildArg(InstType::REF);
+    auto *idx = instrBuilder->BuildArg(OPS_TYPE);
+    auto bblocks = BuildDiamond(cond);
+    instrBuilder->PushForwardInst(bblocks[0], idx);
+    instrBuilder->PushForwardInst(bblocks[0], array);
+    instrBuilder->PushForwardInst(bblocks[0], cond);
+
+    // each branch removes its second check, the one visited later must not
+    // see the check removed in the other branch
+    auto *first = instrBuilder->BuildBoundsCheck(array, idx);
+    auto *otherFirst = instrBuilder->BuildBoundsCheck(array, idx);
+    instrBuilder->PushBackInst(bblocks[1], first);
+    instrBuilder->PushBackInst(bblocks[1],
+                               instrBuilder->BuildBoundsCheck(array, idx));
+    instrBuilder->PushBackInst(bblocks[2], otherFirst);
+    instrBuilder->PushBackInst(bblocks[2],
+                               instrBuilder->BuildBoundsCheck(array, idx));
+
+    // the default pipeline runs the elimination
+    compiler_.Optimize(GetGraph());
+    VerifyControlAndDataFlowGraphs(GetGraph());
+    CompareInstructions({first}, bblocks[1]);
+    CompareInstructions({otherFirst}, bblocks[2]);
+    ASSERT_EQ(array->UsersCount(), 2);
+    ASSERT_EQ(idx->UsersCount(), 2);
+}
+} // namespace ir::tests
@@ -0,0 +1,72 @@
+#include "testBase.h"
+
+namespace ir::tests {
+class CompilerTest : public TestBase {
+  public:
+    // Builds a small function: a diamond with an arithmetic sequence
+    static void BuildFunction(Graph *graph) {
+        auto *instrBuilder = graph->GetInstructionBuilder();
+        std::vector<BB *> bblocks(4);
+        for (auto &it : bblocks) {
+            it = graph->CreateEmptyBB();
+        }
+        graph->SetFirstBB(bblocks[0]);
+        graph->ConnectBBs(bblocks[0], bblocks[1]);
+        graph->ConnectBBs(bblocks[0], bblocks[2]);
+        graph->ConnectBBs(bblocks[1], bblocks[3]);
+        graph->ConnectBBs(bblocks[2], bblocks[3]);
+
+        auto *arg = instrBuilder->BuildArg(InstType::i32);
+        auto *add = instrBuilder->BuildAddi(InstType::i32, arg, 5);
+        auto *mul = instrBuilder->BuildMul(InstType::i32, add, arg);
+        auto *ret = instrBuilder->BuildRet(InstType::i32, mul);
+        instrBuilder->PushBackInst(bblocks[0], arg);
+        instrBuilder->PushBackInst(bblocks[1], add);
+        instrBuilder->PushBackInst(bblocks[3], mul);
+        instrBuilder->PushBackInst(bblocks[3], ret);
+    }
+};
+
+TEST_F(CompilerTest, TestDeleteKeepsFunctionIds) {
+    auto *first = compiler_.CreateNewGraph();
+    auto *second = compiler_.CreateNewGraph();
+    // the deleted graph is destroyed, its id is kept aside
+    auto firstId = first->GetId();
+    ASSERT_EQ(second->GetId(), firstId + 1);
+
+    ASSERT_TRUE(compiler_.DeleteFunctionGraph(firstId));
+    ASSERT_EQ(compiler_.GetFunction(firstId), nullptr);
+    ASSERT_EQ(compiler_.GetFunction(second->GetId()), second);
+    // already deleted
+    ASSERT_FALSE(compiler_.DeleteFunctionGraph(firstId));
+}
+
+TEST_F(CompilerTest, TestDeletedArenaIsReused) {
+    auto *first = compiler_.CreateNewGraph();
+    auto *allocator = first->GetAllocator();
+    ASSERT_NE(allocator, GetGraph()->GetAllocator());
+    auto pooledCount = compiler_.GetPooledArenasCount();
+
+    compiler_.DeleteFunctionGraph(first->GetId());
+    ASSERT_EQ(compiler_.GetPooledArenasCount(), pooledCount + 1);
+    auto *second = compiler_.CreateNewGraph();
+    ASSERT_EQ(second->GetAllocator(), allocator);
+    ASSERT_EQ(compiler_.GetPooledArenasCount(), pooledCount);
+}
+
+TEST_F(CompilerTest, TestDeleteRemovesCopies) {
+    auto *callee = compiler_.CreateNewGraph();
+    BuildFunction(callee);
+    auto *copy = compiler_.CopyGraph(callee, GetInstructionBuilder());
+    auto copyId = copy->GetId();
+    ASSERT_EQ(copy->GetAllocator(), GetGraph()->GetAllocator());
+    ASSERT_EQ(compiler_.GetFunction(copyId), copy);
+
+    // the copy lives in the caller's arena
+    ASSERT_TRUE(compiler_.DeleteFunctionGraph(callee->GetId()));
+    ASSERT_EQ(compiler_.GetFunction(copyId), copy);
+    ASSERT_TRUE(compiler_.DeleteFunctionGraph(GetGraph()->GetId()));
+    ASSERT_EQ(compiler_.GetFunction(copyId), nullptr);
+    graph_ = compiler_.CreateNewGraph();
+}
+} // namespace ir::tests
@@ -57,4 +57,24 @@ TEST_F(dfoRpoTest, TestRPO) {
     }
 }
 
+TEST_F(dfoRpoTest, TestDeepChainRPO) {
+    // a chain deeper than a recursive traversal could afford
+    constexpr size_t BLOCKS_COUNT = 200000;
+    auto *graph = GetGraph();
+    std::vector<BB *> chain;
+    chain.reserve(BLOCKS_COUNT);
+    chain.push_back(graph->CreateEmptyBB());
+    graph->SetFirstBB(chain.front());
+    for (size_t i = 1; i < BLOCKS_COUNT; ++i) {
+        chain.push_back(graph->CreateEmptyBB());
+        graph->ConnectBBs(chain[i - 1], chain[i]);
+        graph->ConnectBBs(chain[i], chain.front());
+    }
+    auto bblocks = RPO(graph);
+    ASSERT_EQ(bblocks.size(), BLOCKS_COUNT);
+    for (size_t i = 0; i < BLOCKS_COUNT; ++i) {
+        ASSERT_EQ(bblocks[i], chain[i]);
+    }
+}
+
 } // namespace ir::tests
\ No newline at end of file
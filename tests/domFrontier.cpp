@@ -0,0 +1,166 @@
+#include "domFrontier.h"
+#include "domTree.h"
+#include "testBase.h"
+#include <random>
+#include <set>
+
+namespace ir::tests {
+class DomFrontierTest : public TestBase {
+  public:
+    static std::set<BB *> GetFrontier(const DominanceFrontiers &frontiers,
+                                      BB *bblock) {
+        auto frontier = frontiers.GetFrontier(bblock);
+        std::set<BB *> result(frontier.begin(), frontier.end());
+        // every block is stored once
+        EXPECT_EQ(result.size(), frontier.size());
+        return result;
+    }
+
+    static std::set<BB *> ToSet(const memory::ArenaVector<BB *> &blocks) {
+        std::set<BB *> result(blocks.begin(), blocks.end());
+        EXPECT_EQ(result.size(), blocks.size());
+        return result;
+    }
+};
+
+static bool isInTree(Graph *graph, BB *bblock) {
+    return bblock == graph->GetFirstBB() || bblock->GetDominator() != nullptr;
+}
+
+static bool dominates(BB *dominator, BB *bblock) {
+    for (; bblock != nullptr; bblock = bblock->GetDominator()) {
+        if (bblock == dominator) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The frontier by its definition: blocks not strictly dominated by the block
+// with a predecessor dominated by it
+static std::set<BB *> naiveFrontier(Graph *graph, BB *bblock) {
+    std::set<BB *> result;
+    if (!isInTree(graph, bblock)) {
+        return result;
+    }
+    graph->ForEachBB([graph, bblock, &result](BB *join) {
+        if (!isInTree(graph, join) ||
+            (join != bblock && dominates(bblock, join))) {
+            return;
+        }
+        for (auto *pred : join->GetPredecessors()) {
+            if (isInTree(graph, pred) && dominates(bblock, pred)) {
+                result.insert(join);
+            }
+        }
+    });
+    return result;
+}
+
+static std::set<BB *> naiveIteratedFrontier(Graph *graph,
+                                            const std::vector<BB *> &defs) {
+    std::set<BB *> result;
+    std::set<BB *> current(defs.begin(), defs.end());
+    while (true) {
+        std::set<BB *> next;
+        for (auto *bblock : current) {
+            auto frontier = naiveFrontier(graph, bblock);
+            next.insert(frontier.begin(), frontier.end());
+        }
+        if (next == result) {
+            return result;
+        }
+        result = next;
+        current.insert(next.begin(), next.end());
+    }
+}
+
+TEST_F(DomFrontierTest, TestFrontiers) {
+    // the graph of DomTreeTest.TestBuilding2
+    auto bblocks = CreateBlocks(11);
+    auto *graph = GetGraph();
+    for (size_t i = 0; i < 7; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+    }
+    graph->ConnectBBs(bblocks[3], bblocks[2]);
+    graph->ConnectBBs(bblocks[5], bblocks[4]);
+    graph->ConnectBBs(bblocks[7], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[9]);
+    graph->ConnectBBs(bblocks[9], bblocks[2]);
+    graph->ConnectBBs(bblocks[6], bblocks[8]);
+    graph->ConnectBBs(bblocks[8], bblocks[10]);
+    graph->GetAnalyses().RequireDomTree();
+
+    DominanceFrontiers frontiers(graph, graph->GetAllocator());
+    std::vector<std::set<BB *>> expected(bblocks.size());
+    expected[1] = {bblocks[1]};
+    expected[2] = {bblocks[1], bblocks[2]};
+    expected[3] = {bblocks[1], bblocks[2]};
+    expected[4] = {bblocks[1], bblocks[4]};
+    expected[5] = {bblocks[1], bblocks[4]};
+    expected[6] = {bblocks[1]};
+    expected[7] = {bblocks[1]};
+    expected[9] = {bblocks[2]};
+    for (size_t i = 0; i < bblocks.size(); ++i) {
+        ASSERT_EQ(GetFrontier(frontiers, bblocks[i]), expected[i])
+            << "block " << i;
+    }
+    ASSERT_EQ(frontiers.GetTotalSize(), 12);
+
+    auto checkIteratedFrontier = [&](const std::vector<BB *> &defs,
+                                     const std::set<BB *> &expectedIDF) {
+        memory::ArenaVector<BB *> result(graph->GetAllocator()->ToSTL());
+        frontiers.ComputeIteratedFrontier(defs, &result);
+        ASSERT_EQ(ToSet(result), expectedIDF);
+        result.clear();
+        ComputeIteratedDomFrontier(graph, defs, &result);
+        ASSERT_EQ(ToSet(result), expectedIDF);
+    };
+    checkIteratedFrontier({bblocks[9]}, {bblocks[1], bblocks[2]});
+    checkIteratedFrontier({bblocks[5]}, {bblocks[1], bblocks[4]});
+    checkIteratedFrontier({bblocks[8]}, {});
+    checkIteratedFrontier({bblocks[8], bblocks[9], bblocks[9]},
+                          {bblocks[1], bblocks[2]});
+}
+
+TEST_F(DomFrontierTest, TestRandomGraphs) {
+    constexpr size_t GRAPHS_COUNT = 30;
+    constexpr size_t BLOCKS_COUNT = 40;
+    constexpr size_t QUERIES_COUNT = 10;
+    std::mt19937_64 gen(7);
+    for (size_t graphIdx = 0; graphIdx < GRAPHS_COUNT; ++graphIdx) {
+        auto *graph = GetGraph();
+        auto bblocks = CreateBlocks(BLOCKS_COUNT);
+        std::uniform_int_distribution<size_t> dist(0, BLOCKS_COUNT - 1);
+        // the last block stays unreachable
+        for (size_t i = 0; i + 2 < BLOCKS_COUNT; ++i) {
+            auto next = std::min(i + 1 + dist(gen) % 2, BLOCKS_COUNT - 2);
+            graph->ConnectBBs(bblocks[i], bblocks[next]);
+            graph->ConnectBBs(bblocks[i], bblocks[dist(gen) % (i + 1)]);
+        }
+        graph->ConnectBBs(bblocks.back(), bblocks[1]);
+        graph->GetAnalyses().RequireDomTree();
+
+        DominanceFrontiers frontiers(graph, graph->GetAllocator());
+        for (auto *bblock : bblocks) {
+            ASSERT_EQ(GetFrontier(frontiers, bblock),
+                      naiveFrontier(graph, bblock));
+        }
+        for (size_t i = 0; i < QUERIES_COUNT; ++i) {
+            std::vector<BB *> defs(1 + dist(gen) % 4);
+            for (auto &def : defs) {
+                def = bblocks[dist(gen)];
+            }
+            auto expected = naiveIteratedFrontier(graph, defs);
+            memory::ArenaVector<BB *> result(graph->GetAllocator()->ToSTL());
+            frontiers.ComputeIteratedFrontier(defs, &result);
+            ASSERT_EQ(ToSet(result), expected);
+            result.clear();
+            ComputeIteratedDomFrontier(graph, defs, &result);
+            ASSERT_EQ(ToSet(result), expected);
+        }
+        TearDown();
+        SetUp();
+    }
+}
+} // namespace ir::tests
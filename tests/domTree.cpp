@@ -1,6 +1,7 @@
 #include "domTree.h"
 #include "testBase.h"
 #include <iostream>
+#include <random>
 
 namespace ir::tests {
 class DomTreeTest : public TestBase {};
@@ -132,4 +133,400 @@ TEST_F(DomTreeTest, TestBuilding3) {
         checkDominatedBBs(bblocks[i], expectedDominatedBlocks[i]);
     }
 }
+
+TEST_F(DomTreeTest, TestDominanceIntervals) {
+    std::vector<BB *> bblocks(7);
+    for (auto &it : bblocks) {
+        it = GetGraph()->CreateEmptyBB();
+    }
+    auto *graph = GetGraph();
+    graph->SetFirstBB(bblocks[0]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[5]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+    graph->ConnectBBs(bblocks[4], bblocks[3]);
+    graph->ConnectBBs(bblocks[5], bblocks[4]);
+    graph->ConnectBBs(bblocks[5], bblocks[6]);
+    graph->ConnectBBs(bblocks[6], bblocks[3]);
+    ASSERT_FALSE(graph->IsDomTreeNumbered());
+    DomTreeBuilder().Construct(graph);
+    ASSERT_TRUE(graph->IsDomTreeNumbered());
+
+    auto dominatesByChain = [](BB *dominator, BB *bblock) {
+        for (; bblock != nullptr; bblock = bblock->GetDominator()) {
+            if (bblock == dominator) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (auto *lhs : bblocks) {
+        for (auto *rhs : bblocks) {
+            ASSERT_EQ(lhs->Domites(rhs), dominatesByChain(lhs, rhs));
+        }
+    }
+    ASSERT_TRUE(bblocks[5]->Domites(bblocks[6]));
+    ASSERT_FALSE(bblocks[2]->Domites(bblocks[3]));
+
+    // the numbering gets stale after CFG edits
+    graph->ConnectBBs(bblocks[0], bblocks[6]);
+    ASSERT_FALSE(graph->IsDomTreeNumbered());
+    DomTreeBuilder().Construct(graph);
+    ASSERT_TRUE(graph->IsDomTreeNumbered());
+    ASSERT_FALSE(bblocks[5]->Domites(bblocks[6]));
+    ASSERT_TRUE(bblocks[0]->Domites(bblocks[6]));
+}
+
+TEST_F(DomTreeTest, TestUnreachableDominance) {
+    // 0 -> 1, 2 -> 3 is not reachable from the first block
+    std::vector<BB *> bblocks(4);
+    for (auto &it : bblocks) {
+        it = GetGraph()->CreateEmptyBB();
+    }
+    auto *graph = GetGraph();
+    graph->SetFirstBB(bblocks[0]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+    DomTreeBuilder().Construct(graph);
+    ASSERT_TRUE(graph->IsDomTreeNumbered());
+
+    // both unreachable blocks have an empty interval
+    ASSERT_FALSE(bblocks[2]->Domites(bblocks[3]));
+    ASSERT_FALSE(bblocks[3]->Domites(bblocks[2]));
+    ASSERT_TRUE(bblocks[2]->Domites(bblocks[2]));
+    for (auto *reachable : {bblocks[0], bblocks[1]}) {
+        for (auto *unreachable : {bblocks[2], bblocks[3]}) {
+            ASSERT_FALSE(reachable->Domites(unreachable));
+            ASSERT_FALSE(unreachable->Domites(reachable));
+        }
+    }
+    ASSERT_TRUE(bblocks[0]->Domites(bblocks[1]));
+}
+
+// Builds a chain of blocks, every block also branches to the exit
+static std::vector<BB *> buildLadder(Graph *graph, size_t length) {
+    std::vector<BB *> chain(length);
+    for (auto &it : chain) {
+        it = graph->CreateEmptyBB();
+    }
+    auto *exit = graph->CreateEmptyBB();
+    graph->SetFirstBB(chain[0]);
+    for (size_t i = 1; i < length; ++i) {
+        graph->ConnectBBs(chain[i - 1], chain[i]);
+        graph->ConnectBBs(chain[i - 1], exit);
+    }
+    graph->ConnectBBs(chain.back(), exit);
+    chain.push_back(exit);
+    return chain;
+}
+
+TEST_F(DomTreeTest, TestDeepChain) {
+    // deeper than a recursive construction could afford
+    constexpr size_t BLOCKS_COUNT = 200000;
+    auto chain = buildLadder(GetGraph(), BLOCKS_COUNT);
+    auto *exit = chain.back();
+    DomTreeBuilder().Construct(GetGraph());
+
+    ASSERT_EQ(chain[0]->GetDominator(), nullptr);
+    for (size_t i = 1; i < BLOCKS_COUNT; ++i) {
+        ASSERT_EQ(chain[i]->GetDominator(), chain[i - 1]);
+    }
+    ASSERT_EQ(exit->GetDominator(), chain[0]);
+    ASSERT_TRUE(chain[1]->Domites(chain[BLOCKS_COUNT - 1]));
+    ASSERT_FALSE(chain[1]->Domites(exit));
+}
+
+TEST_F(DomTreeTest, TestStorageReuse) {
+    memory::ArenaAllocator storage;
+    DomTreeBuilder builder(&storage);
+    auto *largeGraph = compiler_.CreateNewGraph();
+    auto largeChain = buildLadder(largeGraph, 1000);
+    builder.Construct(largeGraph);
+    ASSERT_EQ(largeChain.back()->GetDominator(), largeChain[0]);
+    auto usedSize = storage.GetUsedSize();
+
+    // smaller graphs take the tables of the larger one
+    for (size_t length = 1; length < 100; length += 10) {
+        auto *graph = compiler_.CreateNewGraph();
+        auto chain = buildLadder(graph, length);
+        builder.Construct(graph);
+        ASSERT_EQ(chain.back()->GetDominator(), chain[0]);
+        ASSERT_EQ(chain[length - 1]->GetDominator(),
+                  length > 1 ? chain[length - 2] : nullptr);
+        ASSERT_EQ(storage.GetUsedSize(), usedSize);
+        compiler_.DeleteFunctionGraph(graph->GetId());
+    }
+    compiler_.DeleteFunctionGraph(largeGraph->GetId());
+}
+
+TEST_F(DomTreeTest, TestSemiNCAMatchesLengauerTarjan) {
+    std::mt19937_64 gen(42);
+    for (size_t count : {1, 2, 5, 17, 64, 300}) {
+        auto *graph = compiler_.CreateNewGraph();
+        std::vector<BB *> bblocks(count);
+        for (auto &it : bblocks) {
+            it = graph->CreateEmptyBB();
+        }
+        graph->SetFirstBB(bblocks[0]);
+        // a chain with random branches gives loops, joins and irreducible
+        // regions
+        std::uniform_int_distribution<size_t> dist(0, count - 1);
+        for (size_t i = 0; i + 1 < count; ++i) {
+            graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+            graph->ConnectBBs(bblocks[i], bblocks[dist(gen)]);
+        }
+
+        DomTreeBuilder(DomTreeAlgorithm::LENGAUER_TARJAN).Construct(graph);
+        std::vector<BB *> expectedDominators;
+        for (auto *bblock : bblocks) {
+            expectedDominators.push_back(bblock->GetDominator());
+        }
+        DomTreeBuilder(DomTreeAlgorithm::SEMI_NCA).Construct(graph);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(bblocks[i]->GetDominator(), expectedDominators[i]);
+        }
+        compiler_.DeleteFunctionGraph(graph->GetId());
+    }
+
+    // the analysis manager builds with the selected algorithm
+    auto &analyses = GetGraph()->GetAnalyses();
+    ASSERT_EQ(analyses.GetDomTreeAlgorithm(), DEFAULT_DOM_TREE_ALGORITHM);
+    analyses.SetDomTreeAlgorithm(DomTreeAlgorithm::SEMI_NCA);
+    ASSERT_EQ(analyses.GetDomTreeAlgorithm(), DomTreeAlgorithm::SEMI_NCA);
+    auto bblocks = buildLadder(GetGraph(), 10);
+    analyses.RequireDomTree();
+    for (size_t i = 1; i < 10; ++i) {
+        ASSERT_EQ(bblocks[i]->GetDominator(), bblocks[i - 1]);
+    }
+    ASSERT_EQ(bblocks.back()->GetDominator(), bblocks[0]);
+}
+
+TEST_F(DomTreeTest, TestIncrementalEdgeUpdates) {
+    std::mt19937_64 gen(42);
+    constexpr size_t BLOCKS_COUNT = 60;
+    constexpr size_t EDITS_COUNT = 300;
+    auto *graph = GetGraph();
+    std::vector<BB *> bblocks(BLOCKS_COUNT);
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    for (size_t i = 0; i + 1 < BLOCKS_COUNT; ++i) {
+        graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+    }
+    auto &analyses = graph->GetAnalyses();
+    analyses.RequireDomTree();
+    // each verification rebuilds the tree as well
+    size_t rebuildsCount = 1;
+
+    std::uniform_int_distribution<size_t> dist(0, BLOCKS_COUNT - 1);
+    for (size_t i = 0; i < EDITS_COUNT; ++i) {
+        auto *from = bblocks[dist(gen)];
+        auto *to = bblocks[dist(gen)];
+        auto &succs = from->GetSuccessors();
+        if (succs.size() < 2 && to != bblocks[0] &&
+            std::find(succs.begin(), succs.end(), to) == succs.end()) {
+            graph->ConnectBBs(from, to);
+        } else if (!succs.empty()) {
+            // the edge is restored when its target becomes unreachable
+            to = succs[dist(gen) % succs.size()];
+            graph->DisconnectBBs(from, to);
+            if (!analyses.IsValid(AnalysisKind::DOM_TREE)) {
+                graph->ConnectBBs(from, to);
+                analyses.RequireDomTree();
+                ++rebuildsCount;
+                continue;
+            }
+        }
+        ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE),
+                  rebuildsCount);
+        VerifyDomTree(graph);
+        ++rebuildsCount;
+    }
+}
+
+TEST_F(DomTreeTest, TestIncrementalNewBlocks) {
+    auto *graph = GetGraph();
+    auto bblocks = buildLadder(graph, 8);
+    auto &analyses = graph->GetAnalyses();
+    analyses.RequireDomTree();
+
+    // a chain of new blocks is linked into the tree once it gets reachable
+    auto *first = graph->CreateEmptyBB();
+    auto *second = graph->CreateEmptyBB();
+    graph->ConnectBBs(first, second);
+    graph->ConnectBBs(second, bblocks[6]);
+    ASSERT_EQ(first->GetDominator(), nullptr);
+    auto *exit = bblocks.back();
+    graph->ConnectBBs(exit, first);
+    ASSERT_EQ(first->GetDominator(), exit);
+    ASSERT_EQ(second->GetDominator(), first);
+    ASSERT_EQ(bblocks[6]->GetDominator(), bblocks[0]);
+    VerifyDomTree(graph);
+
+    // splitting keeps the tree as well
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *arg = instrBuilder->BuildArg(InstType::i32);
+    auto *add = instrBuilder->BuildAdd(InstType::i32, arg, arg);
+    instrBuilder->PushBackInst(bblocks[1], arg);
+    instrBuilder->PushBackInst(bblocks[1], add);
+    auto [head, tail] = bblocks[1]->SplitAfterInstruction(arg, true);
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::DOM_TREE));
+    ASSERT_EQ(tail->GetDominator(), head);
+    ASSERT_EQ(bblocks[2]->GetDominator(), tail);
+    // the only rebuild after the first one was done by the verification
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 2);
+    VerifyDomTree(graph);
+}
+
+TEST_F(DomTreeTest, TestPostDomTree) {
+    // 0 -> 1 -> {2, 3}, 2 -> {4, 5}, 3 -> 5, 4 -> 6, 5 -> 6, 6 -> {1, 7},
+    // with the infinite loop 8 <-> 9 entered from 3 and never reaching 7
+    std::vector<BB *> bblocks(10);
+    auto *graph = GetGraph();
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    graph->SetLastBB(bblocks[7]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[4]);
+    graph->ConnectBBs(bblocks[2], bblocks[5]);
+    graph->ConnectBBs(bblocks[3], bblocks[5]);
+    graph->ConnectBBs(bblocks[3], bblocks[8]);
+    graph->ConnectBBs(bblocks[4], bblocks[6]);
+    graph->ConnectBBs(bblocks[5], bblocks[6]);
+    graph->ConnectBBs(bblocks[6], bblocks[1]);
+    graph->ConnectBBs(bblocks[6], bblocks[7]);
+    graph->ConnectBBs(bblocks[8], bblocks[9]);
+    graph->ConnectBBs(bblocks[9], bblocks[8]);
+
+    for (auto algorithm :
+         {DomTreeAlgorithm::LENGAUER_TARJAN, DomTreeAlgorithm::SEMI_NCA}) {
+        PostDomTreeBuilder(algorithm).Construct(graph);
+        ASSERT_TRUE(graph->GetAnalyses().IsValid(AnalysisKind::POST_DOM_TREE));
+        std::vector<BB *> expected{bblocks[1], bblocks[6], bblocks[6],
+                                   bblocks[5], bblocks[6], bblocks[6],
+                                   bblocks[7], nullptr,    nullptr,
+                                   nullptr};
+        for (size_t i = 0; i < bblocks.size(); ++i) {
+            ASSERT_EQ(bblocks[i]->GetPostDominator(), expected[i])
+                << "block " << i;
+        }
+        ASSERT_EQ(bblocks[6]->GetPostDomTreeDepth(), 1);
+        ASSERT_TRUE(bblocks[6]->PostDominates(bblocks[0]));
+        ASSERT_TRUE(bblocks[5]->PostDominates(bblocks[3]));
+        ASSERT_FALSE(bblocks[5]->PostDominates(bblocks[2]));
+        ASSERT_FALSE(bblocks[7]->PostDominates(bblocks[8]));
+        ASSERT_FALSE(bblocks[8]->PostDominates(bblocks[9]));
+    }
+    // the forward tree is not touched
+    ASSERT_FALSE(graph->GetAnalyses().IsValid(AnalysisKind::DOM_TREE));
+    ASSERT_EQ(bblocks[5]->GetDominator(), nullptr);
+}
+
+// Immediate post-dominators by the iterative data-flow over sets of
+// post-dominators, null for the exit and blocks not reaching it
+static std::vector<BB *> naivePostDominators(const std::vector<BB *> &bblocks,
+                                             BB *exit) {
+    auto count = bblocks.size();
+    std::vector<bool> reachesExit(count, false);
+    reachesExit[exit->GetId()] = true;
+    std::vector<std::vector<bool>> postDoms(count,
+                                            std::vector<bool>(count, true));
+    postDoms[exit->GetId()].assign(count, false);
+    postDoms[exit->GetId()][exit->GetId()] = true;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto *bblock : bblocks) {
+            auto id = bblock->GetId();
+            if (bblock == exit) {
+                continue;
+            }
+            std::vector<bool> meet(count, true);
+            bool reaches = false;
+            for (auto *succ : bblock->GetSuccessors()) {
+                if (!reachesExit[succ->GetId()]) {
+                    continue;
+                }
+                reaches = true;
+                for (size_t i = 0; i < count; ++i) {
+                    meet[i] = meet[i] && postDoms[succ->GetId()][i];
+                }
+            }
+            if (!reaches) {
+                continue;
+            }
+            meet[id] = true;
+            if (!reachesExit[id] || meet != postDoms[id]) {
+                reachesExit[id] = true;
+                postDoms[id] = meet;
+                changed = true;
+            }
+        }
+    }
+
+    std::vector<BB *> result(count, nullptr);
+    for (auto *bblock : bblocks) {
+        auto id = bblock->GetId();
+        if (bblock == exit || !reachesExit[id]) {
+            continue;
+        }
+        // the nearest strict post-dominator has the most post-dominators
+        size_t bestCount = 0;
+        for (auto *candidate : bblocks) {
+            auto candidateId = candidate->GetId();
+            if (candidateId == id || !postDoms[id][candidateId]) {
+                continue;
+            }
+            auto candidateCount = static_cast<size_t>(std::count(
+                postDoms[candidateId].begin(), postDoms[candidateId].end(),
+                true));
+            if (candidateCount > bestCount) {
+                bestCount = candidateCount;
+                result[id] = candidate;
+            }
+        }
+    }
+    return result;
+}
+
+TEST_F(DomTreeTest, TestPostDomTreeRandomGraphs) {
+    constexpr size_t GRAPHS_COUNT = 20;
+    constexpr size_t BLOCKS_COUNT = 50;
+    std::mt19937_64 gen(11);
+    std::uniform_int_distribution<size_t> dist(0, BLOCKS_COUNT - 1);
+    for (size_t graphIdx = 0; graphIdx < GRAPHS_COUNT; ++graphIdx) {
+        auto *graph = GetGraph();
+        std::vector<BB *> bblocks(BLOCKS_COUNT);
+        for (auto &it : bblocks) {
+            it = graph->CreateEmptyBB();
+        }
+        graph->SetFirstBB(bblocks[0]);
+        graph->SetLastBB(bblocks.back());
+        // some of the blocks branch only backwards and may not reach the exit
+        for (size_t i = 0; i + 1 < BLOCKS_COUNT; ++i) {
+            if (dist(gen) % 8 != 0) {
+                graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+            }
+            graph->ConnectBBs(bblocks[i], bblocks[dist(gen) % (i + 1)]);
+        }
+
+        auto expected = naivePostDominators(bblocks, bblocks.back());
+        for (auto algorithm :
+             {DomTreeAlgorithm::LENGAUER_TARJAN, DomTreeAlgorithm::SEMI_NCA}) {
+            PostDomTreeBuilder(algorithm).Construct(graph);
+            for (size_t i = 0; i < BLOCKS_COUNT; ++i) {
+                ASSERT_EQ(bblocks[i]->GetPostDominator(), expected[i])
+                    << "block " << i;
+            }
+        }
+        TearDown();
+        SetUp();
+    }
+}
+
 } // namespace ir::tests
\ No newline at end of file
@@ -173,4 +173,103 @@ TEST_F(GraphTest, TestGraphCopy) {
     }
 }
 
+TEST_F(GraphTest, TestDeadInstructionRecycling) {
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto opType = InstType::i32;
+    auto *bblock = graph->CreateEmptyBB();
+    graph->SetFirstBB(bblock);
+    auto *arg = instrBuilder->BuildArg(opType);
+    auto *add = instrBuilder->BuildAdd(opType, arg, arg);
+    auto *mul = instrBuilder->BuildMul(opType, arg, arg);
+    instrBuilder->PushBackInst(bblock, arg);
+    instrBuilder->PushBackInst(bblock, add);
+    instrBuilder->PushBackInst(bblock, mul);
+
+    bblock->SetInstructionAsDead(add);
+    // dead nodes are reclaimed only on request
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 0);
+    graph->RecycleDeadNodes();
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 1);
+    ASSERT_EQ(arg->UsersCount(), 2);
+    ASSERT_EQ(std::ranges::count(arg->GetUsers(), mul), 2);
+
+    auto *xorInstr = instrBuilder->BuildXor(opType, arg, mul);
+    ASSERT_EQ(static_cast<SingleInstruction *>(xorInstr), add);
+    ASSERT_EQ(xorInstr->GetOpcode(), Opcode::XOR);
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 0);
+    ASSERT_EQ(mul->UsersCount(), 1);
+}
+
+TEST_F(GraphTest, TestUsedDeadInstructionIsKept) {
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto opType = InstType::i32;
+    auto *bblock = graph->CreateEmptyBB();
+    graph->SetFirstBB(bblock);
+    auto *arg = instrBuilder->BuildArg(opType);
+    auto *add = instrBuilder->BuildAdd(opType, arg, arg);
+    auto *mul = instrBuilder->BuildMul(opType, add, arg);
+    instrBuilder->PushBackInst(bblock, arg);
+    instrBuilder->PushBackInst(bblock, add);
+    instrBuilder->PushBackInst(bblock, mul);
+
+    bblock->SetInstructionAsDead(add);
+    graph->RecycleDeadNodes();
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 0);
+    ASSERT_EQ(mul->GetInput(0), add);
+
+    // reclaimed as soon as the user is dead too
+    bblock->SetInstructionAsDead(mul);
+    graph->RecycleDeadNodes();
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 2);
+    ASSERT_EQ(arg->UsersCount(), 0);
+}
+
+TEST_F(GraphTest, TestRecyclingKeepsFootprintFlat) {
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto opType = InstType::i32;
+    auto *bblock = graph->CreateEmptyBB();
+    graph->SetFirstBB(bblock);
+    auto *arg = instrBuilder->BuildArg(opType);
+    instrBuilder->PushBackInst(bblock, arg);
+
+    auto *allocator = graph->GetAllocator();
+    size_t usedSize = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        auto *add = instrBuilder->BuildAdd(opType, arg, arg);
+        // the reused memory gets a fresh id
+        ASSERT_EQ(add->GetInstID(), i + 2);
+        instrBuilder->PushBackInst(bblock, add);
+        bblock->KillInstruction(add);
+        graph->RecycleDeadNodes();
+        if (i == 1) {
+            usedSize = allocator->GetUsedSize();
+        } else if (i > 1) {
+            ASSERT_EQ(allocator->GetUsedSize(), usedSize);
+        }
+    }
+    ASSERT_EQ(instrBuilder->GetBuiltInstructionsCount(), 101);
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 1);
+}
+
+TEST_F(GraphTest, TestDeadBlockRecycling) {
+    auto *graph = GetGraph();
+    auto *first = graph->CreateEmptyBB();
+    auto *second = graph->CreateEmptyBB();
+    graph->SetFirstBB(first);
+    graph->ConnectBBs(first, second);
+    auto *isolated = graph->CreateEmptyBB();
+
+    graph->SetBBAsDead(isolated);
+    graph->RecycleDeadNodes();
+    auto *newBBlock = graph->CreateEmptyBB();
+    ASSERT_EQ(newBBlock, isolated);
+    ASSERT_EQ(newBBlock->GetGraph(), graph);
+    ASSERT_TRUE(newBBlock->IsEmpty());
+    ASSERT_TRUE(newBBlock->HasNoPredecessors());
+    ASSERT_EQ(graph->GetBBCount(), 3);
+}
+
 } // namespace ir::tests
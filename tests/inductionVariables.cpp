@@ -0,0 +1,126 @@
+#include "domTree/inductionVariables.h"
+#include "testBase.h"
+
+namespace ir::tests {
+class InductionVariablesTest : public TestBase {
+  public:
+    // 0 -> 1 <-> 2, 1 -> 3
+    std::vector<BB *> BuildLoopBlocks() {
+        auto *graph = GetGraph();
+        auto bblocks = CreateBlocks(4);
+        graph->ConnectBBs(bblocks[0], bblocks[1]);
+        graph->ConnectBBs(bblocks[1], bblocks[2]);
+        graph->ConnectBBs(bblocks[1], bblocks[3]);
+        graph->ConnectBBs(bblocks[2], bblocks[1]);
+        return bblocks;
+    }
+
+    InductionVariables Analyze(BB *header) {
+        GetGraph()->GetAnalyses().Require(
+            {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE});
+        return InductionVariables(header->GetLoop(),
+                                  GetGraph()->GetAllocator());
+    }
+
+  public:
+    static constexpr auto OPS_TYPE = InstType::i32;
+};
+
+TEST_F(InductionVariablesTest, TestBasicAndDerived) {
+    auto bblocks = BuildLoopBlocks();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+    auto *bound = instrBuilder->BuildConst(OPS_TYPE, 10);
+    instrBuilder->PushBackInst(bblocks[0], a);
+    instrBuilder->PushBackInst(bblocks[0], zero);
+    instrBuilder->PushBackInst(bblocks[0], bound);
+
+    auto *i = instrBuilder->BuildPhi(OPS_TYPE);
+    auto *j = instrBuilder->BuildPhi(OPS_TYPE);
+    auto *k = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[1], i);
+    instrBuilder->PushForwardInst(bblocks[1], j);
+    instrBuilder->PushForwardInst(bblocks[1], k);
+    instrBuilder->PushBackInst(
+        bblocks[1],
+        instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, i, bound));
+    instrBuilder->PushBackInst(bblocks[1], instrBuilder->BuildJcmp());
+
+    auto *scaled = instrBuilder->BuildMuli(OPS_TYPE, i, 4);
+    auto *shifted = instrBuilder->BuildAdd(OPS_TYPE, a, scaled);
+    auto *product = instrBuilder->BuildMul(OPS_TYPE, j, i);
+    auto *invariant = instrBuilder->BuildMul(OPS_TYPE, a, a);
+    auto *kNext = instrBuilder->BuildAdd(OPS_TYPE, k, product);
+    auto *iNext = instrBuilder->BuildAddi(OPS_TYPE, i, 1);
+    auto *jNext = instrBuilder->BuildAdd(OPS_TYPE, j, a);
+    for (auto *instr : std::initializer_list<SingleInstruction *>{
+             scaled, shifted, product, invariant, kNext, iNext, jNext}) {
+        instrBuilder->PushBackInst(bblocks[2], instr);
+    }
+    i->AddPhiInput(zero, bblocks[0]);
+    i->AddPhiInput(iNext, bblocks[2]);
+    j->AddPhiInput(a, bblocks[0]);
+    j->AddPhiInput(jNext, bblocks[2]);
+    k->AddPhiInput(zero, bblocks[0]);
+    k->AddPhiInput(kNext, bblocks[2]);
+    instrBuilder->PushBackInst(bblocks[3], instrBuilder->BuildRet(OPS_TYPE, k));
+
+    auto variables = Analyze(bblocks[1]);
+    auto *iVariable = variables.Find(i);
+    ASSERT_NE(iVariable, nullptr);
+    ASSERT_TRUE(iVariable->IsBasic());
+    ASSERT_EQ(iVariable->baseIdx, 1);
+    ASSERT_TRUE(iVariable->invariant->IsConst());
+    auto *jVariable = variables.Find(j);
+    ASSERT_NE(jVariable, nullptr);
+    ASSERT_EQ(jVariable->invariant, a);
+    // increased by a variable
+    ASSERT_EQ(variables.Find(k), nullptr);
+
+    auto *scaledVariable = variables.Find(scaled);
+    ASSERT_NE(scaledVariable, nullptr);
+    ASSERT_FALSE(scaledVariable->IsBasic());
+    ASSERT_EQ(scaledVariable->basis, i);
+    ASSERT_EQ(scaledVariable->base, i);
+    ASSERT_EQ(scaledVariable->baseIdx, 0);
+    auto *shiftedVariable = variables.Find(shifted);
+    ASSERT_NE(shiftedVariable, nullptr);
+    ASSERT_EQ(shiftedVariable->basis, i);
+    ASSERT_EQ(shiftedVariable->base, scaled);
+    ASSERT_EQ(shiftedVariable->baseIdx, 1);
+    ASSERT_EQ(shiftedVariable->invariant, a);
+    ASSERT_EQ(variables.Find(jNext)->basis, j);
+    ASSERT_EQ(variables.Find(product), nullptr);
+    ASSERT_EQ(variables.Find(invariant), nullptr);
+    ASSERT_EQ(variables.Find(kNext), nullptr);
+    ASSERT_EQ(variables.GetVariables().size(), 6);
+    ASSERT_TRUE(variables.IsInvariant(a));
+    ASSERT_FALSE(variables.IsInvariant(invariant));
+}
+
+TEST_F(InductionVariablesTest, TestNoVariables) {
+    auto bblocks = BuildLoopBlocks();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    instrBuilder->PushBackInst(bblocks[0], a);
+    auto *i = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[1], i);
+    instrBuilder->PushBackInst(
+        bblocks[1], instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, i, a));
+    instrBuilder->PushBackInst(bblocks[1], instrBuilder->BuildJcmp());
+    // the step changes on every iteration
+    auto *iNext = instrBuilder->BuildAdd(OPS_TYPE, i, i);
+    instrBuilder->PushBackInst(bblocks[2], iNext);
+    i->AddPhiInput(a, bblocks[0]);
+    i->AddPhiInput(iNext, bblocks[2]);
+    instrBuilder->PushBackInst(bblocks[3], instrBuilder->BuildRet(OPS_TYPE, i));
+
+    auto variables = Analyze(bblocks[1]);
+    ASSERT_TRUE(variables.GetVariables().empty());
+    // the root loop has no variables of its own
+    InductionVariables rootVariables(GetGraph()->GetLoopTree(),
+                                     GetGraph()->GetAllocator());
+    ASSERT_TRUE(rootVariables.GetVariables().empty());
+}
+} // namespace ir::tests
@@ -246,4 +246,22 @@ TEST_F(InliningTest, TestInlineVoidReturn) {
     ASSERT_EQ(callerGraph->GetBBCount(), callerBlocksCount + calleeBlocksCount);
     VerifyControlAndDataFlowGraphs(callerGraph);
 }
+
+TEST_F(InliningTest, TestInlineKeepsDomTree) {
+    SetUp(DEFAULT_MAX_CALLEE_SIZE, DEFAULT_MAX_TOTAL_SIZE);
+    auto *call = BuildCallerGraph(false);
+    auto *callerGraph = GetGraph();
+    auto *calleeGraph = BuildMultipleReturnsCallee();
+    call->SetCallTarget(calleeGraph->GetId());
+
+    // the callee is spliced into the tree instead of rebuilding it
+    auto &analyses = callerGraph->GetAnalyses();
+    analyses.RequireDomTree();
+    pass->Apply();
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::DOM_TREE));
+    ASSERT_FALSE(callerGraph->IsDomTreeNumbered());
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 1);
+    ASSERT_EQ(callerGraph->GetBBCount(), 10);
+    VerifyDomTree(callerGraph);
+}
 } // namespace ir::tests
\ No newline at end of file
@@ -291,4 +291,60 @@ TEST_F(InstructionsTest, TestBoundsCheck) {
     ASSERT_EQ(instr->GetInput(1), idx);
 }
 
+TEST_F(InstructionsTest, TestUsersList) {
+    auto instType = InstType::i32;
+    auto *builder = GetInstructionBuilder();
+    auto *arg1 = builder->BuildArg(instType);
+    auto *arg2 = builder->BuildArg(instType);
+    auto *mul = builder->BuildMul(instType, arg1, arg1);
+    auto *add = builder->BuildAdd(instType, arg1, arg2);
+    ASSERT_EQ(arg1->UsersCount(), 3);
+    ASSERT_EQ(std::ranges::count(arg1->GetUsers(), mul), 2);
+    ASSERT_EQ(std::ranges::count(arg1->GetUsers(), add), 1);
+
+    mul->SetInput(arg2, 1);
+    ASSERT_EQ(arg1->UsersCount(), 2);
+    ASSERT_EQ(arg2->UsersCount(), 2);
+    ASSERT_EQ(std::ranges::count(arg2->GetUsers(), mul), 1);
+
+    add->ClearInputs();
+    ASSERT_EQ(arg1->UsersCount(), 1);
+    ASSERT_EQ(arg2->UsersCount(), 1);
+    ASSERT_EQ(add->GetInput(0).GetInstruction(), nullptr);
+
+    // copies of inputs are not uses
+    Input copy = mul->GetInput(0);
+    ASSERT_EQ(copy.GetUser(), nullptr);
+    ASSERT_EQ(arg1->UsersCount(), 1);
+}
+
+TEST_F(InstructionsTest, TestReplaceInputInUsers) {
+    constexpr size_t USERS_COUNT = 1000;
+    auto instType = InstType::i32;
+    auto *builder = GetInstructionBuilder();
+    auto *value = builder->BuildConst(instType, 1);
+    auto *replacement = builder->BuildConst(instType, 2);
+    auto *phi = builder->BuildPhi(instType);
+    auto *source = GetGraph()->CreateEmptyBB();
+    std::vector<BinaryRegInstr *> adds;
+    for (size_t i = 0; i < USERS_COUNT; ++i) {
+        adds.push_back(builder->BuildAdd(instType, value, replacement));
+        // reallocations of the inputs must keep them linked
+        phi->AddPhiInput(value, source);
+    }
+    ASSERT_EQ(value->UsersCount(), 2 * USERS_COUNT);
+    ASSERT_EQ(std::ranges::count(value->GetUsers(), phi), USERS_COUNT);
+
+    value->ReplaceInputInUsers(replacement);
+    ASSERT_EQ(value->UsersCount(), 0);
+    ASSERT_TRUE(value->GetUsers().empty());
+    ASSERT_EQ(replacement->UsersCount(), 3 * USERS_COUNT);
+    for (auto *add : adds) {
+        ASSERT_EQ(add->GetInput(0), replacement);
+    }
+    for (size_t i = 0; i < USERS_COUNT; ++i) {
+        ASSERT_EQ(phi->GetInput(i), replacement);
+    }
+}
+
 } // namespace ir::tests
@@ -0,0 +1,167 @@
+#include "domTree/loop.h"
+#include "optimizations/licm.h"
+#include "testBase.h"
+
+namespace ir::tests {
+class LICMTest : public TestBase {
+  public:
+    static constexpr auto OPS_TYPE = InstType::i32;
+};
+
+TEST_F(LICMTest, TestHoistingFromLoop) {
+    // 0 -> 1 <-> 2, 1 -> 3
+    auto bblocks = CreateBlocks(4);
+    auto *graph = GetGraph();
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[1]);
+
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *b = instrBuilder->BuildArg(OPS_TYPE);
+    auto *arr = instrBuilder->BuildArg(InstType::REF);
+    auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+    auto *nullCheck = instrBuilder->BuildNullCheck(arr);
+    for (auto *instr : std::initializer_list<SingleInstruction *>{
+             a, b, arr, zero, nullCheck}) {
+        instrBuilder->PushBackInst(bblocks[0], instr);
+    }
+
+    auto *phi = instrBuilder->BuildPhi(OPS_TYPE);
+    auto *mul = instrBuilder->BuildMul(OPS_TYPE, a, b);
+    auto *len = instrBuilder->BuildLen(arr);
+    // compares are kept together with the jumps reading their flags
+    auto *cmp = instrBuilder->BuildCmp(OPS_TYPE, Conditions::GRTHAN, a, b);
+    auto *jcmp = instrBuilder->BuildJcmp();
+    instrBuilder->PushForwardInst(bblocks[1], phi);
+    for (auto *instr :
+         std::initializer_list<SingleInstruction *>{mul, len, cmp, jcmp}) {
+        instrBuilder->PushBackInst(bblocks[1], instr);
+    }
+
+    auto *cast = instrBuilder->BuildCast(OPS_TYPE, InstType::i64, mul);
+    auto *shift = instrBuilder->BuildShr(OPS_TYPE, len, mul);
+    auto *load = instrBuilder->BuildLoadArray(OPS_TYPE, arr, zero);
+    auto *add = instrBuilder->BuildAdd(OPS_TYPE, phi, shift);
+    for (auto *instr :
+         std::initializer_list<SingleInstruction *>{cast, shift, load, add}) {
+        instrBuilder->PushBackInst(bblocks[2], instr);
+    }
+    phi->AddPhiInput(zero, bblocks[0]);
+    phi->AddPhiInput(add, bblocks[2]);
+    instrBuilder->PushBackInst(bblocks[3],
+                               instrBuilder->BuildRet(OPS_TYPE, phi));
+
+    auto blocksCount = graph->GetBBCount();
+    LoopInvariantCodeMotion licm(graph);
+    licm.Apply();
+    ASSERT_EQ(licm.GetHoistedCount(), 4);
+    // the single entry is the preheader already
+    ASSERT_EQ(graph->GetBBCount(), blocksCount);
+    CompareInstructions({a, b, arr, zero, nullCheck, mul, len, cast, shift},
+                        bblocks[0]);
+    CompareInstructions({phi, cmp, jcmp}, bblocks[1]);
+    // loads may be changed by the stores of the loop
+    CompareInstructions({load, add}, bblocks[2]);
+
+    auto &analyses = graph->GetAnalyses();
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::DOM_TREE));
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::LOOP_TREE));
+    VerifyControlAndDataFlowGraphs(graph);
+
+    // nothing is left to hoist
+    licm.Apply();
+    ASSERT_EQ(licm.GetHoistedCount(), 0);
+}
+
+TEST_F(LICMTest, TestNestedLoops) {
+    // outer loop 1 -> 2 -> 5 -> 1 with inner loop 2 <-> 3, both exit to 4
+    auto bblocks = CreateBlocks(6);
+    auto *graph = GetGraph();
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[0], bblocks[4]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[5]);
+    graph->ConnectBBs(bblocks[3], bblocks[2]);
+    graph->ConnectBBs(bblocks[5], bblocks[1]);
+    graph->ConnectBBs(bblocks[5], bblocks[4]);
+
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *b = instrBuilder->BuildArg(OPS_TYPE);
+    auto *arr = instrBuilder->BuildArg(InstType::REF);
+    instrBuilder->PushBackInst(bblocks[0], a);
+    instrBuilder->PushBackInst(bblocks[0], b);
+    instrBuilder->PushBackInst(bblocks[0], arr);
+
+    auto *phi = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[1], phi);
+    auto *next = instrBuilder->BuildAddi(OPS_TYPE, phi, 1);
+    instrBuilder->PushBackInst(bblocks[5], next);
+    phi->AddPhiInput(a, bblocks[0]);
+    phi->AddPhiInput(next, bblocks[5]);
+
+    auto *xorInstr = instrBuilder->BuildXor(OPS_TYPE, a, b);
+    auto *innerInvariant = instrBuilder->BuildAdd(OPS_TYPE, phi, xorInstr);
+    // the array may be null, so its length is read only in the loop
+    auto *len = instrBuilder->BuildLen(arr);
+    for (auto *instr : std::initializer_list<SingleInstruction *>{
+             xorInstr, innerInvariant, len}) {
+        instrBuilder->PushBackInst(bblocks[3], instr);
+    }
+
+    auto blocksCount = graph->GetBBCount();
+    LoopInvariantCodeMotion licm(graph);
+    licm.Apply();
+    ASSERT_EQ(licm.GetHoistedCount(), 3);
+
+    // the outer loop has two entries, so its preheader is created
+    auto *outerLoop = bblocks[1]->GetLoop();
+    auto *innerLoop = bblocks[2]->GetLoop();
+    ASSERT_EQ(innerLoop->GetOuterLoop(), outerLoop);
+    ASSERT_EQ(graph->GetBBCount(), blocksCount + 1);
+    auto *preHeader = outerLoop->GetPreHeader();
+    ASSERT_NE(preHeader, nullptr);
+    ASSERT_EQ(innerLoop->GetPreHeader(), bblocks[1]);
+    ASSERT_EQ(phi->GetSourceBB(0), preHeader);
+
+    // the xor is moved out of both loops
+    CompareInstructions({xorInstr}, preHeader);
+    CompareInstructions({phi, innerInvariant}, bblocks[1]);
+    CompareInstructions({len}, bblocks[3]);
+
+    auto &analyses = graph->GetAnalyses();
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::DOM_TREE));
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::LOOP_TREE));
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 1);
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::LOOP_TREE), 1);
+    VerifyDomTree(graph);
+    VerifyControlAndDataFlowGraphs(graph);
+}
+
+TEST_F(LICMTest, TestIrreducibleLoop) {
+    // 1 and 2 are both entries of the loop
+    auto bblocks = CreateBlocks(4);
+    auto *graph = GetGraph();
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[0], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[2], bblocks[1]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    instrBuilder->PushBackInst(bblocks[0], a);
+    auto *mul = instrBuilder->BuildMul(OPS_TYPE, a, a);
+    instrBuilder->PushBackInst(bblocks[2], mul);
+
+    LoopInvariantCodeMotion licm(graph);
+    licm.Apply();
+    ASSERT_TRUE(bblocks[2]->GetLoop()->IsIrreducible());
+    ASSERT_EQ(licm.GetHoistedCount(), 0);
+    ASSERT_EQ(mul->GetInstBB(), bblocks[2]);
+}
+
+} // namespace ir::tests
@@ -1,9 +1,33 @@
 #include "loopChecker.h"
 #include "testBase.h"
 #include <iostream>
+#include <random>
+#include <set>
 
 namespace ir::tests {
 class LoopAnalysisTest : public TestBase {
+  public:
+    // the graph of TestLoops2: loop 1 containing loops 2 and 4
+    std::vector<BB *> BuildNestedLoops() {
+        std::vector<BB *> bblocks(11);
+        auto *graph = GetGraph();
+        for (auto &it : bblocks) {
+            it = graph->CreateEmptyBB();
+        }
+        graph->SetFirstBB(bblocks[0]);
+        for (size_t i = 0; i < 7; ++i) {
+            graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+        }
+        graph->ConnectBBs(bblocks[3], bblocks[2]);
+        graph->ConnectBBs(bblocks[5], bblocks[4]);
+        graph->ConnectBBs(bblocks[7], bblocks[1]);
+        graph->ConnectBBs(bblocks[1], bblocks[9]);
+        graph->ConnectBBs(bblocks[9], bblocks[2]);
+        graph->ConnectBBs(bblocks[6], bblocks[8]);
+        graph->ConnectBBs(bblocks[8], bblocks[10]);
+        return bblocks;
+    }
+
   public:
     LoopChecker loopChecker;
 };
@@ -123,7 +147,10 @@ TEST_F(LoopAnalysisTest, TestLoops3) {
             ASSERT_EQ(loop->GetHeader(), bblocks[2]);
             ASSERT_TRUE(loop->IsIrreducible());
             ASSERT_EQ(loop->GetBackEdges()[0], bblocks[6]);
-            ASSERT_EQ(loop->GetBasicBlocks().size(), 1);
+            // entered at 2 and 3
+            ASSERT_EQ(loop->GetBasicBlocks().size(), 3);
+            ASSERT_EQ(bblocks[3]->GetLoop(), loop);
+            ASSERT_EQ(bblocks[6]->GetLoop(), loop);
         }
     }
 }
@@ -231,4 +258,301 @@ TEST_F(LoopAnalysisTest, TestLoops6) {
     ASSERT_FALSE(loop->IsIrreducible());
 }
 
+TEST_F(LoopAnalysisTest, TestDepthsAndExits) {
+    auto bblocks = BuildNestedLoops();
+    auto *graph = GetGraph();
+    loopChecker.VerifyGraphLoops(graph);
+    auto *rootLoop = graph->GetLoopTree();
+    auto *mainLoop = bblocks[1]->GetLoop();
+    auto *firstLoop = bblocks[2]->GetLoop();
+    auto *secondLoop = bblocks[4]->GetLoop();
+    ASSERT_EQ(rootLoop->GetDepth(), 0);
+    ASSERT_EQ(mainLoop->GetDepth(), 1);
+    ASSERT_EQ(firstLoop->GetDepth(), 2);
+    ASSERT_EQ(secondLoop->GetDepth(), 2);
+
+    ASSERT_TRUE(rootLoop->Contains(secondLoop));
+    ASSERT_TRUE(mainLoop->Contains(firstLoop));
+    ASSERT_TRUE(mainLoop->Contains(bblocks[5]));
+    ASSERT_TRUE(mainLoop->Contains(mainLoop));
+    ASSERT_FALSE(mainLoop->Contains(bblocks[8]));
+    ASSERT_FALSE(firstLoop->Contains(secondLoop));
+    ASSERT_FALSE(firstLoop->Contains(mainLoop));
+
+    using Edges = std::vector<Loop::Edge>;
+    auto getExits = [](const Loop *loop) {
+        return Edges(loop->GetExitEdges().begin(),
+                     loop->GetExitEdges().end());
+    };
+    ASSERT_TRUE(rootLoop->GetExitEdges().empty());
+    ASSERT_EQ(getExits(mainLoop), (Edges{{bblocks[6], bblocks[8]}}));
+    ASSERT_EQ(getExits(firstLoop), (Edges{{bblocks[3], bblocks[4]}}));
+    ASSERT_EQ(getExits(secondLoop), (Edges{{bblocks[5], bblocks[6]}}));
+}
+
+TEST_F(LoopAnalysisTest, TestTraversalOrders) {
+    auto bblocks = BuildNestedLoops();
+    auto *graph = GetGraph();
+    graph->GetAnalyses().Require(
+        {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE});
+    auto *allocator = graph->GetScratchAllocator();
+    memory::ArenaScope scope(allocator);
+    auto *rootLoop = graph->GetLoopTree();
+    auto *mainLoop = bblocks[1]->GetLoop();
+    auto *loops = rootLoop->GetLoopsOuterFirst(allocator);
+    ASSERT_EQ(loops->size(), 4);
+    ASSERT_EQ((*loops)[0], rootLoop);
+    ASSERT_EQ((*loops)[1], mainLoop);
+    for (size_t i = 2; i < loops->size(); ++i) {
+        ASSERT_EQ((*loops)[i]->GetOuterLoop(), mainLoop);
+    }
+
+    auto *order = mainLoop->GetBlocksInDomOrder(allocator);
+    std::set<BB *> visited;
+    for (auto *bblock : *order) {
+        if (bblock != bblocks[1]) {
+            ASSERT_TRUE(visited.contains(bblock->GetDominator()));
+        }
+        visited.insert(bblock);
+    }
+    ASSERT_EQ((*order)[0], bblocks[1]);
+    ASSERT_EQ(visited, (std::set<BB *>{bblocks[1], bblocks[2], bblocks[3],
+                                       bblocks[4], bblocks[5], bblocks[6],
+                                       bblocks[7], bblocks[9]}));
+    ASSERT_EQ(order->size(), visited.size());
+}
+
+TEST_F(LoopAnalysisTest, TestPreHeaders) {
+    auto bblocks = BuildNestedLoops();
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto type = InstType::i32;
+    std::vector<SingleInstruction *> values;
+    for (auto *bblock : {bblocks[1], bblocks[9], bblocks[3]}) {
+        values.push_back(instrBuilder->BuildConst(type, values.size()));
+        bblock->PushInstBackward(values.back());
+    }
+    auto *phi = instrBuilder->BuildPhi(type);
+    phi->AddPhiInput(values[0], bblocks[1]);
+    phi->AddPhiInput(values[1], bblocks[9]);
+    phi->AddPhiInput(values[2], bblocks[3]);
+    bblocks[2]->PushInstForward(phi);
+    auto *innerPhi = instrBuilder->BuildPhi(type);
+    innerPhi->AddPhiInput(values[2], bblocks[3]);
+    innerPhi->AddPhiInput(values[2], bblocks[5]);
+    bblocks[4]->PushInstForward(innerPhi);
+
+    auto &analyses = graph->GetAnalyses();
+    analyses.GetLoopTree();
+    auto *mainLoop = bblocks[1]->GetLoop();
+    auto *firstLoop = bblocks[2]->GetLoop();
+    auto *secondLoop = bblocks[4]->GetLoop();
+    ASSERT_EQ(mainLoop->GetPreHeader(), bblocks[0]);
+    ASSERT_EQ(mainLoop->GetOrCreatePreHeader(), bblocks[0]);
+    ASSERT_EQ(firstLoop->GetPreHeader(), nullptr);
+    ASSERT_EQ(secondLoop->GetPreHeader(), nullptr);
+    auto blocksCount = graph->GetBBCount();
+
+    // two entries, their phi inputs are merged in the preheader
+    auto *preHeader = firstLoop->GetOrCreatePreHeader();
+    ASSERT_EQ(graph->GetBBCount(), blocksCount + 1);
+    ASSERT_EQ(firstLoop->GetPreHeader(), preHeader);
+    ASSERT_EQ(preHeader->GetLoop(), mainLoop);
+    ASSERT_EQ(preHeader->GetSuccessors().size(), 1);
+    ASSERT_EQ(preHeader->GetPredecessors().size(), 2);
+    ASSERT_EQ(bblocks[2]->GetPredecessors().size(), 2);
+    ASSERT_EQ(phi->GetInputsCount(), 2);
+    ASSERT_EQ(phi->GetSourceBB(0), bblocks[3]);
+    ASSERT_EQ(phi->GetInput(0).GetInstruction(), values[2]);
+    ASSERT_EQ(phi->GetSourceBB(1), preHeader);
+    auto *merged = preHeader->GetFirstPhiBB();
+    ASSERT_EQ(phi->GetInput(1).GetInstruction(), merged);
+    ASSERT_EQ(merged->GetInputsCount(), 2);
+    ASSERT_EQ(merged->GetSourceBB(0), bblocks[1]);
+    ASSERT_EQ(merged->GetInput(0).GetInstruction(), values[0]);
+    ASSERT_EQ(merged->GetSourceBB(1), bblocks[9]);
+    ASSERT_EQ(merged->GetInput(1).GetInstruction(), values[1]);
+
+    // the only entry leaves the first loop, so its exit edge is redirected
+    preHeader = secondLoop->GetOrCreatePreHeader();
+    ASSERT_EQ(secondLoop->GetPreHeader(), preHeader);
+    ASSERT_EQ(preHeader->GetLoop(), mainLoop);
+    ASSERT_EQ(preHeader->GetSize(), 0);
+    ASSERT_EQ(innerPhi->GetSourceBB(0), preHeader);
+    ASSERT_EQ(innerPhi->GetSourceBB(1), bblocks[5]);
+    ASSERT_EQ(firstLoop->GetExitEdges().size(), 1);
+    ASSERT_EQ(firstLoop->GetExitEdges()[0],
+              (Loop::Edge{bblocks[3], preHeader}));
+
+    // the trees are updated in place
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::DOM_TREE));
+    ASSERT_TRUE(analyses.IsValid(AnalysisKind::LOOP_TREE));
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 1);
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::LOOP_TREE), 1);
+    ASSERT_EQ(bblocks[2]->GetDominator()->GetDominator(), bblocks[1]);
+    VerifyDomTree(graph);
+}
+
+TEST_F(LoopAnalysisTest, TestPreHeaderOfFirstBlock) {
+    std::vector<BB *> bblocks(3);
+    auto *graph = GetGraph();
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[0]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->GetAnalyses().GetLoopTree();
+
+    auto *loop = bblocks[0]->GetLoop();
+    ASSERT_EQ(loop->GetPreHeader(), nullptr);
+    auto *preHeader = loop->GetOrCreatePreHeader();
+    ASSERT_EQ(graph->GetFirstBB(), preHeader);
+    ASSERT_EQ(preHeader->GetLoop(), graph->GetLoopTree());
+    ASSERT_TRUE(preHeader->GetPredecessors().empty());
+    ASSERT_EQ(bblocks[0]->GetDominator(), preHeader);
+    ASSERT_EQ(loop->GetPreHeader(), preHeader);
+    VerifyDomTree(graph);
+}
+
+TEST_F(LoopAnalysisTest, TestIrreducibleNesting) {
+    // loop 1 contains the region of 2 and 3 entered at both, which contains
+    // loop 4
+    std::vector<BB *> bblocks(8);
+    auto *graph = GetGraph();
+    for (auto &it : bblocks) {
+        it = graph->CreateEmptyBB();
+    }
+    graph->SetFirstBB(bblocks[0]);
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[6]);
+    graph->ConnectBBs(bblocks[3], bblocks[4]);
+    graph->ConnectBBs(bblocks[4], bblocks[5]);
+    graph->ConnectBBs(bblocks[5], bblocks[4]);
+    graph->ConnectBBs(bblocks[5], bblocks[2]);
+    graph->ConnectBBs(bblocks[6], bblocks[1]);
+    graph->ConnectBBs(bblocks[6], bblocks[7]);
+
+    loopChecker.VerifyGraphLoops(graph);
+    auto *rootLoop = graph->GetLoopTree();
+    ASSERT_EQ(rootLoop->GetBasicBlocks().size(), 2);
+    ASSERT_EQ(rootLoop->GetInnerLoops().size(), 1);
+    auto *outerLoop = rootLoop->GetInnerLoops()[0];
+    ASSERT_EQ(outerLoop->GetHeader(), bblocks[1]);
+    ASSERT_FALSE(outerLoop->IsIrreducible());
+    ASSERT_EQ(outerLoop->GetBasicBlocks().size(), 2);
+    ASSERT_EQ(bblocks[6]->GetLoop(), outerLoop);
+    ASSERT_EQ(outerLoop->GetInnerLoops().size(), 1);
+
+    auto *region = outerLoop->GetInnerLoops()[0];
+    ASSERT_EQ(region->GetHeader(), bblocks[2]);
+    ASSERT_TRUE(region->IsIrreducible());
+    ASSERT_EQ(region->GetDepth(), 2);
+    ASSERT_EQ(region->GetBackEdges().size(), 1);
+    ASSERT_EQ(region->GetBackEdges()[0], bblocks[5]);
+    ASSERT_EQ(region->GetBasicBlocks().size(), 2);
+    ASSERT_EQ(bblocks[3]->GetLoop(), region);
+    ASSERT_EQ(region->GetInnerLoops().size(), 1);
+
+    auto *innerLoop = region->GetInnerLoops()[0];
+    ASSERT_EQ(innerLoop->GetHeader(), bblocks[4]);
+    ASSERT_FALSE(innerLoop->IsIrreducible());
+    ASSERT_EQ(innerLoop->GetDepth(), 3);
+    ASSERT_EQ(innerLoop->GetBasicBlocks().size(), 2);
+    ASSERT_TRUE(outerLoop->Contains(innerLoop));
+
+    using Edges = std::vector<Loop::Edge>;
+    auto getExits = [](const Loop *loop) {
+        return Edges(loop->GetExitEdges().begin(),
+                     loop->GetExitEdges().end());
+    };
+    ASSERT_EQ(getExits(innerLoop), (Edges{{bblocks[5], bblocks[2]}}));
+    ASSERT_EQ(getExits(region), (Edges{{bblocks[2], bblocks[6]}}));
+    ASSERT_EQ(getExits(outerLoop), (Edges{{bblocks[6], bblocks[7]}}));
+}
+
+// Blocks reachable from the block without leaving the loop
+static std::set<BB *> reachInLoop(const Loop *loop, BB *bblock, bool forward) {
+    std::set<BB *> reached = {bblock};
+    std::vector<BB *> worklist = {bblock};
+    while (!worklist.empty()) {
+        auto *current = worklist.back();
+        worklist.pop_back();
+        const auto &next = forward ? current->GetSuccessors()
+                                   : current->GetPredecessors();
+        for (auto *it : next) {
+            if (loop->Contains(it) && reached.insert(it).second) {
+                worklist.push_back(it);
+            }
+        }
+    }
+    return reached;
+}
+
+TEST_F(LoopAnalysisTest, TestRandomGraphs) {
+    constexpr size_t GRAPHS_COUNT = 30;
+    constexpr size_t BLOCKS_COUNT = 40;
+    std::mt19937_64 gen(11);
+    size_t irreducibleCount = 0;
+    for (size_t graphIdx = 0; graphIdx < GRAPHS_COUNT; ++graphIdx) {
+        auto *graph = GetGraph();
+        std::vector<BB *> bblocks(BLOCKS_COUNT);
+        for (auto &it : bblocks) {
+            it = graph->CreateEmptyBB();
+        }
+        graph->SetFirstBB(bblocks[0]);
+        std::uniform_int_distribution<size_t> dist(0, BLOCKS_COUNT - 1);
+        for (size_t i = 0; i + 1 < BLOCKS_COUNT; ++i) {
+            graph->ConnectBBs(bblocks[i], bblocks[i + 1]);
+            if (dist(gen) % 2 == 0) {
+                graph->ConnectBBs(bblocks[i], bblocks[dist(gen)]);
+            }
+        }
+        loopChecker.VerifyGraphLoops(graph);
+
+        std::set<BB *> irreducibleHeaders;
+        for (auto *bblock : bblocks) {
+            auto *loop = bblock->GetLoop();
+            ASSERT_NE(loop, nullptr);
+            // every cycle is in a loop
+            auto reached = reachInLoop(graph->GetLoopTree(), bblock, true);
+            bool isOnCycle = std::ranges::any_of(
+                bblock->GetPredecessors(),
+                [&reached](BB *pred) { return reached.contains(pred); });
+            ASSERT_EQ(isOnCycle, !loop->IsRoot());
+            if (loop->IsRoot()) {
+                continue;
+            }
+            // a loop is strongly connected through its header
+            auto *header = loop->GetHeader();
+            ASSERT_TRUE(reachInLoop(loop, header, true).contains(bblock));
+            ASSERT_TRUE(reachInLoop(loop, header, false).contains(bblock));
+            ASSERT_EQ(loop->GetDepth(), loop->GetOuterLoop()->GetDepth() + 1);
+            ASSERT_TRUE(loop->GetOuterLoop()->Contains(loop));
+            ASSERT_FALSE(loop->Contains(loop->GetOuterLoop()));
+            // a loop entered at the header only is reducible
+            for (; !loop->IsRoot(); loop = loop->GetOuterLoop()) {
+                if (!loop->GetHeader()->Domites(bblock)) {
+                    ASSERT_TRUE(loop->IsIrreducible());
+                    irreducibleHeaders.insert(loop->GetHeader());
+                }
+            }
+        }
+        graph->ForEachBB([&irreducibleHeaders](BB *bblock) {
+            auto *loop = bblock->GetLoop();
+            if (!loop->IsRoot() && loop->GetHeader() == bblock) {
+                ASSERT_EQ(loop->IsIrreducible(),
+                          irreducibleHeaders.contains(bblock));
+            }
+        });
+        irreducibleCount += irreducibleHeaders.size();
+        TearDown();
+        SetUp();
+    }
+    ASSERT_GT(irreducibleCount, 0);
+}
 } // namespace ir::tests
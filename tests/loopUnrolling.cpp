@@ -0,0 +1,299 @@
+#include "domTree/loop.h"
+#include "optimizations/loopUnrolling.h"
+#include "testBase.h"
+
+namespace ir::tests {
+class LoopUnrollingTest : public TestBase {
+  public:
+    // sum of i * a for i < bound, the condition is tested in the header:
+    // 0 -> 1 <-> 2, 1 -> 3
+    std::vector<BB *> BuildSumLoop(int64_t bound) {
+        auto bblocks = CreateBlocks(4);
+        auto *graph = GetGraph();
+        graph->ConnectBBs(bblocks[0], bblocks[1]);
+        graph->ConnectBBs(bblocks[1], bblocks[2]);
+        graph->ConnectBBs(bblocks[1], bblocks[3]);
+        graph->ConnectBBs(bblocks[2], bblocks[1]);
+
+        auto *instrBuilder = GetInstructionBuilder();
+        auto *a = instrBuilder->BuildArg(OPS_TYPE);
+        auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+        auto *boundConst = instrBuilder->BuildConst(OPS_TYPE, bound);
+        for (auto *instr :
+             std::initializer_list<SingleInstruction *>{a, zero, boundConst}) {
+            instrBuilder->PushBackInst(bblocks[0], instr);
+        }
+
+        auto *i = instrBuilder->BuildPhi(OPS_TYPE);
+        auto *sum = instrBuilder->BuildPhi(OPS_TYPE);
+        instrBuilder->PushForwardInst(bblocks[1], i);
+        instrBuilder->PushForwardInst(bblocks[1], sum);
+        instrBuilder->PushBackInst(
+            bblocks[1],
+            instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, i,
+                                   boundConst));
+        instrBuilder->PushBackInst(bblocks[1], instrBuilder->BuildJcmp());
+
+        auto *mul = instrBuilder->BuildMul(OPS_TYPE, i, a);
+        auto *add = instrBuilder->BuildAdd(OPS_TYPE, sum, mul);
+        auto *next = instrBuilder->BuildAddi(OPS_TYPE, i, 1);
+        for (auto *instr :
+             std::initializer_list<SingleInstruction *>{mul, add, next}) {
+            instrBuilder->PushBackInst(bblocks[2], instr);
+        }
+        i->AddPhiInput(zero, bblocks[0]);
+        i->AddPhiInput(next, bblocks[2]);
+        sum->AddPhiInput(zero, bblocks[0]);
+        sum->AddPhiInput(add, bblocks[2]);
+        instrBuilder->PushBackInst(bblocks[3],
+                                   instrBuilder->BuildRet(OPS_TYPE, sum));
+        return bblocks;
+    }
+
+    static size_t CountLoops(Graph *graph) {
+        graph->GetAnalyses().Require(
+            {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE});
+        return graph->GetLoopTree()->GetInnerLoops().size();
+    }
+
+    static size_t CountBranches(Graph *graph) {
+        size_t count = 0;
+        graph->ForEachBB([&count](BB *bblock) {
+            for (auto *instr : *bblock) {
+                count += instr->IsBranch() ? 1 : 0;
+            }
+        });
+        return count;
+    }
+
+  public:
+    static constexpr auto OPS_TYPE = InstType::i32;
+};
+
+TEST_F(LoopUnrollingTest, TestFullUnrolling) {
+    BuildSumLoop(4);
+    auto *graph = GetGraph();
+    ASSERT_EQ(Interpret(graph, {3}), 18);
+
+    LoopUnrolling unrolling(graph, 20, 100);
+    unrolling.Apply();
+    ASSERT_EQ(unrolling.GetUnrolledCount(), 1);
+    VerifyControlAndDataFlowGraphs(graph);
+    ASSERT_EQ(CountLoops(graph), 0);
+    ASSERT_EQ(CountBranches(graph), 0);
+    ASSERT_EQ(Interpret(graph, {3}), 18);
+    ASSERT_EQ(Interpret(graph, {-5}), -30);
+
+    // nothing is left to unroll
+    unrolling.Apply();
+    ASSERT_EQ(unrolling.GetUnrolledCount(), 0);
+}
+
+TEST_F(LoopUnrollingTest, TestPartialUnrolling) {
+    // 11 executions of the header do not fit, so 3 of them are peeled and
+    // the rest are unrolled by 4
+    BuildSumLoop(10);
+    auto *graph = GetGraph();
+    auto instrsCount = graph->CountInstructions();
+    LoopUnrolling unrolling(graph, 20, 60);
+    unrolling.Apply();
+    ASSERT_EQ(unrolling.GetUnrolledCount(), 1);
+    VerifyControlAndDataFlowGraphs(graph);
+    ASSERT_LT(graph->CountInstructions(), 60);
+    ASSERT_GT(graph->CountInstructions(), instrsCount);
+
+    ASSERT_EQ(CountLoops(graph), 1);
+    // one test is left in the loop
+    ASSERT_EQ(CountBranches(graph), 1);
+    ASSERT_EQ(Interpret(graph, {2}), 90);
+    ASSERT_EQ(Interpret(graph, {7}), 315);
+}
+
+TEST_F(LoopUnrollingTest, TestBottomTestedLoop) {
+    // do { sum += i; ++i } while (i < 6): 0 -> 1 <-> 1 -> 2
+    auto bblocks = CreateBlocks(3);
+    auto *graph = GetGraph();
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+    auto *bound = instrBuilder->BuildConst(OPS_TYPE, 6);
+    instrBuilder->PushBackInst(bblocks[0], zero);
+    instrBuilder->PushBackInst(bblocks[0], bound);
+    auto *i = instrBuilder->BuildPhi(OPS_TYPE);
+    auto *sum = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[1], i);
+    instrBuilder->PushForwardInst(bblocks[1], sum);
+    auto *add = instrBuilder->BuildAdd(OPS_TYPE, sum, i);
+    auto *next = instrBuilder->BuildAddi(OPS_TYPE, i, 1);
+    auto *cmp =
+        instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, next, bound);
+    for (auto *instr : std::initializer_list<SingleInstruction *>{
+             add, next, cmp, instrBuilder->BuildJcmp()}) {
+        instrBuilder->PushBackInst(bblocks[1], instr);
+    }
+    i->AddPhiInput(zero, bblocks[0]);
+    i->AddPhiInput(next, bblocks[1]);
+    sum->AddPhiInput(zero, bblocks[0]);
+    sum->AddPhiInput(add, bblocks[1]);
+    // the value of the last iteration is used after the loop
+    auto *ret = instrBuilder->BuildRet(OPS_TYPE, add);
+    instrBuilder->PushBackInst(bblocks[2], ret);
+
+    // only the factor of 2 fits
+    LoopUnrolling unrolling(graph, 10, 20);
+    unrolling.Apply();
+    ASSERT_EQ(unrolling.GetUnrolledCount(), 1);
+    VerifyControlAndDataFlowGraphs(graph);
+    ASSERT_EQ(CountLoops(graph), 1);
+    ASSERT_EQ(graph->GetBBCount(), 4);
+    ASSERT_NE(ret->GetInput(0), add);
+    ASSERT_EQ(Interpret(graph, {}), 15);
+}
+
+TEST_F(LoopUnrollingTest, TestExitPhi) {
+    // the loop is guarded, the exit merges its value with the skipped one:
+    // 0 -> 1 <-> 1 -> 2, 0 -> 2
+    auto bblocks = CreateBlocks(3);
+    auto *graph = GetGraph();
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[0], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+    auto *bound = instrBuilder->BuildConst(OPS_TYPE, 6);
+    for (auto *instr : std::initializer_list<SingleInstruction *>{
+             a, zero, bound,
+             instrBuilder->BuildCmp(OPS_TYPE, Conditions::GRTHAN, a, zero),
+             instrBuilder->BuildJcmp()}) {
+        instrBuilder->PushBackInst(bblocks[0], instr);
+    }
+    auto *i = instrBuilder->BuildPhi(OPS_TYPE);
+    auto *sum = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[1], i);
+    instrBuilder->PushForwardInst(bblocks[1], sum);
+    auto *add = instrBuilder->BuildAdd(OPS_TYPE, sum, i);
+    auto *next = instrBuilder->BuildAddi(OPS_TYPE, i, 1);
+    for (auto *instr : std::initializer_list<SingleInstruction *>{
+             add, next,
+             instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, next, bound),
+             instrBuilder->BuildJcmp()}) {
+        instrBuilder->PushBackInst(bblocks[1], instr);
+    }
+    i->AddPhiInput(zero, bblocks[0]);
+    i->AddPhiInput(next, bblocks[1]);
+    sum->AddPhiInput(zero, bblocks[0]);
+    sum->AddPhiInput(add, bblocks[1]);
+    auto *result = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[2], result);
+    result->AddPhiInput(zero, bblocks[0]);
+    result->AddPhiInput(add, bblocks[1]);
+    instrBuilder->PushBackInst(bblocks[2],
+                               instrBuilder->BuildRet(OPS_TYPE, result));
+
+    LoopUnrolling unrolling(graph, 10, 20);
+    unrolling.Apply();
+    ASSERT_EQ(unrolling.GetUnrolledCount(), 1);
+    VerifyControlAndDataFlowGraphs(graph);
+    // the loop is left from the copy only
+    ASSERT_EQ(result->GetInputsCount(), 2);
+    ASSERT_EQ(std::ranges::count(result->GetSourceBBs(), bblocks[1]), 0);
+    ASSERT_EQ(Interpret(graph, {1}), 15);
+    ASSERT_EQ(Interpret(graph, {-1}), 0);
+}
+
+TEST_F(LoopUnrollingTest, TestConsecutiveLoops) {
+    // the first loop exits to the header of the second one, which gets a
+    // preheader on the exit edge
+    auto bblocks = CreateBlocks(5);
+    auto *graph = GetGraph();
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[2], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[4]);
+    graph->ConnectBBs(bblocks[3], bblocks[2]);
+
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+    auto *three = instrBuilder->BuildConst(OPS_TYPE, 3);
+    for (auto *instr :
+         std::initializer_list<SingleInstruction *>{a, zero, three}) {
+        instrBuilder->PushBackInst(bblocks[0], instr);
+    }
+    // x = a; do { x *= x } while (++i < 3)
+    auto *i = instrBuilder->BuildPhi(OPS_TYPE);
+    auto *x = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[1], i);
+    instrBuilder->PushForwardInst(bblocks[1], x);
+    auto *square = instrBuilder->BuildMul(OPS_TYPE, x, x);
+    auto *nextI = instrBuilder->BuildAddi(OPS_TYPE, i, 1);
+    for (auto *instr : std::initializer_list<SingleInstruction *>{
+             square, nextI,
+             instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, nextI,
+                                    three),
+             instrBuilder->BuildJcmp()}) {
+        instrBuilder->PushBackInst(bblocks[1], instr);
+    }
+    i->AddPhiInput(zero, bblocks[0]);
+    i->AddPhiInput(nextI, bblocks[1]);
+    x->AddPhiInput(a, bblocks[0]);
+    x->AddPhiInput(square, bblocks[1]);
+
+    // for (j = 0; j < 3; ++j) y += x
+    auto *j = instrBuilder->BuildPhi(OPS_TYPE);
+    auto *y = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[2], j);
+    instrBuilder->PushForwardInst(bblocks[2], y);
+    instrBuilder->PushBackInst(
+        bblocks[2],
+        instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, j, three));
+    instrBuilder->PushBackInst(bblocks[2], instrBuilder->BuildJcmp());
+    auto *add = instrBuilder->BuildAdd(OPS_TYPE, y, square);
+    auto *nextJ = instrBuilder->BuildAddi(OPS_TYPE, j, 1);
+    instrBuilder->PushBackInst(bblocks[3], add);
+    instrBuilder->PushBackInst(bblocks[3], nextJ);
+    j->AddPhiInput(zero, bblocks[1]);
+    j->AddPhiInput(nextJ, bblocks[3]);
+    y->AddPhiInput(zero, bblocks[1]);
+    y->AddPhiInput(add, bblocks[3]);
+    instrBuilder->PushBackInst(bblocks[4],
+                               instrBuilder->BuildRet(OPS_TYPE, y));
+    ASSERT_EQ(Interpret(graph, {2}), 768);
+
+    LoopUnrolling unrolling(graph, 20, 100);
+    unrolling.Apply();
+    ASSERT_EQ(unrolling.GetUnrolledCount(), 2);
+    VerifyControlAndDataFlowGraphs(graph);
+    ASSERT_EQ(CountLoops(graph), 0);
+    ASSERT_EQ(Interpret(graph, {2}), 768);
+    ASSERT_EQ(Interpret(graph, {-1}), 3);
+}
+
+TEST_F(LoopUnrollingTest, TestBudgets) {
+    BuildSumLoop(4);
+    auto *graph = GetGraph();
+    auto instrsCount = graph->CountInstructions();
+    auto blocksCount = graph->GetBBCount();
+
+    // the loop itself is too large
+    LoopUnrolling largeLoop(graph, 5, 100);
+    largeLoop.Apply();
+    ASSERT_EQ(largeLoop.GetUnrolledCount(), 0);
+
+    // even a single copy does not fit
+    LoopUnrolling largeGraph(graph, 10, 15);
+    largeGraph.Apply();
+    ASSERT_EQ(largeGraph.GetUnrolledCount(), 0);
+
+    ASSERT_EQ(graph->CountInstructions(), instrsCount);
+    ASSERT_EQ(graph->GetBBCount(), blocksCount);
+    ASSERT_EQ(CountLoops(graph), 1);
+}
+} // namespace ir::tests
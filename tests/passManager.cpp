@@ -0,0 +1,160 @@
+#include "optimizations/checkElimination.h"
+#include "optimizations/licm.h"
+#include "optimizations/passManager.h"
+#include "optimizations/peepholes.h"
+#include "testBase.h"
+#include <sstream>
+
+namespace ir::tests {
+class PassManagerTest : public TestBase {
+  public:
+    // v ^ 0 is folded by peepholes, the second null check is dominated by
+    // the first one
+    void BuildGraph() {
+        auto *graph = GetGraph();
+        auto *instrBuilder = GetInstructionBuilder();
+        auto *first = graph->CreateEmptyBB();
+        auto *second = graph->CreateEmptyBB();
+        graph->SetFirstBB(first);
+        graph->ConnectBBs(first, second);
+
+        auto *arg = instrBuilder->BuildArg(OPS_TYPE);
+        auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+        auto *xorInstr = instrBuilder->BuildXor(OPS_TYPE, arg, zero);
+        auto *obj = instrBuilder->BuildNewObject(42);
+        instrBuilder->PushBackInst(first, arg);
+        instrBuilder->PushBackInst(first, zero);
+        instrBuilder->PushBackInst(first, xorInstr);
+        instrBuilder->PushBackInst(first, obj);
+        instrBuilder->PushBackInst(first, instrBuilder->BuildNullCheck(obj));
+        instrBuilder->PushBackInst(second, instrBuilder->BuildNullCheck(obj));
+        instrBuilder->PushBackInst(second,
+                                   instrBuilder->BuildAdd(OPS_TYPE, xorInstr,
+                                                          arg));
+    }
+
+  public:
+    static constexpr auto OPS_TYPE = InstType::i32;
+};
+
+TEST_F(PassManagerTest, TestFixedPoint) {
+    BuildGraph();
+    PassManager passManager(GetGraph());
+    passManager.AddPass<Peepholes>().AddPass<CheckElimination>();
+    // the second iteration changes nothing
+    ASSERT_EQ(passManager.Run(), 2);
+
+    const auto &stats = passManager.GetStats();
+    ASSERT_EQ(stats.size(), 2);
+    ASSERT_STREQ(stats[0].name, "Peepholes");
+    ASSERT_STREQ(stats[1].name, "CheckElimination");
+    for (const auto &passStats : stats) {
+        ASSERT_EQ(passStats.runs, 2);
+        ASSERT_EQ(passStats.instrsRemoved, 1);
+        ASSERT_EQ(passStats.bblocksChanged, 0);
+        ASSERT_GE(passStats.timeMs, 0);
+    }
+    ASSERT_EQ(GetGraph()->CountInstructions(), 5);
+    // the analyses are preserved by both passes
+    auto &analyses = GetGraph()->GetAnalyses();
+    ASSERT_EQ(analyses.GetComputationsCount(AnalysisKind::DOM_TREE), 1);
+
+    std::stringstream dump;
+    passManager.DumpStats(dump);
+    ASSERT_NE(dump.str().find("CheckElimination"), std::string::npos);
+}
+
+TEST_F(PassManagerTest, TestIterationsBudget) {
+    BuildGraph();
+    PassManager passManager(GetGraph(), 1);
+    passManager.AddPass<Peepholes>().AddPass<CheckElimination>();
+    ASSERT_EQ(passManager.Run(), 1);
+    ASSERT_EQ(passManager.GetIterationsCount(), 1);
+    for (const auto &passStats : passManager.GetStats()) {
+        ASSERT_EQ(passStats.runs, 1);
+    }
+}
+
+TEST_F(PassManagerTest, TestMovesAreChanges) {
+    // 0 -> 1 <-> 2, 1 -> 3, the invariant a * a is hoisted into 0
+    auto bblocks = CreateBlocks(4);
+    auto *graph = GetGraph();
+    graph->ConnectBBs(bblocks[0], bblocks[1]);
+    graph->ConnectBBs(bblocks[1], bblocks[2]);
+    graph->ConnectBBs(bblocks[1], bblocks[3]);
+    graph->ConnectBBs(bblocks[2], bblocks[1]);
+
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+    instrBuilder->PushBackInst(bblocks[0], a);
+    instrBuilder->PushBackInst(bblocks[0], zero);
+    auto *phi = instrBuilder->BuildPhi(OPS_TYPE);
+    instrBuilder->PushForwardInst(bblocks[1], phi);
+    instrBuilder->PushBackInst(
+        bblocks[1],
+        instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN, phi, a));
+    instrBuilder->PushBackInst(bblocks[1], instrBuilder->BuildJcmp());
+    auto *mul = instrBuilder->BuildMul(OPS_TYPE, a, a);
+    auto *add = instrBuilder->BuildAdd(OPS_TYPE, phi, mul);
+    instrBuilder->PushBackInst(bblocks[2], mul);
+    instrBuilder->PushBackInst(bblocks[2], add);
+    phi->AddPhiInput(zero, bblocks[0]);
+    phi->AddPhiInput(add, bblocks[2]);
+    instrBuilder->PushBackInst(bblocks[3],
+                               instrBuilder->BuildRet(OPS_TYPE, phi));
+
+    PassManager passManager(graph);
+    passManager.AddPass<LoopInvariantCodeMotion>();
+    // the hoisting neither creates nor removes anything, but the pipeline is
+    // repeated after it
+    ASSERT_EQ(passManager.Run(), 2);
+    const auto &stats = passManager.GetStats()[0];
+    ASSERT_EQ(stats.instrsCreated, 0);
+    ASSERT_EQ(stats.instrsRemoved, 0);
+    ASSERT_EQ(stats.bblocksChanged, 0);
+    ASSERT_EQ(mul->GetInstBB(), bblocks[0]);
+}
+
+TEST_F(PassManagerTest, TestCompilerPipeline) {
+    auto *calleeGraph = compiler_.CreateNewGraph();
+    auto *calleeBuilder = GetInstructionBuilder(calleeGraph);
+    auto *calleeBlock = calleeGraph->CreateEmptyBB(true);
+    calleeGraph->SetFirstBB(calleeBlock);
+    auto *calleeArg = calleeBuilder->BuildArg(OPS_TYPE);
+    auto *zero = calleeBuilder->BuildConst(OPS_TYPE, 0);
+    auto *xorInstr = calleeBuilder->BuildXor(OPS_TYPE, calleeArg, zero);
+    calleeBuilder->PushBackInst(calleeBlock, calleeArg);
+    calleeBuilder->PushBackInst(calleeBlock, zero);
+    calleeBuilder->PushBackInst(calleeBlock, xorInstr);
+    calleeBuilder->PushBackInst(calleeBlock,
+                                calleeBuilder->BuildRet(OPS_TYPE, xorInstr));
+
+    auto *graph = GetGraph();
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *bblock = graph->CreateEmptyBB(true);
+    graph->SetFirstBB(bblock);
+    auto *arg = instrBuilder->BuildArg(OPS_TYPE);
+    auto *call =
+        instrBuilder->BuildCall(OPS_TYPE, calleeGraph->GetId(), {arg});
+    auto *add = instrBuilder->BuildAdd(OPS_TYPE, call, arg);
+    instrBuilder->PushBackInst(bblock, arg);
+    instrBuilder->PushBackInst(bblock, call);
+    instrBuilder->PushBackInst(bblock, add);
+    instrBuilder->PushBackInst(bblock, instrBuilder->BuildRet(OPS_TYPE, add));
+
+    ASSERT_EQ(compiler_.Optimize(graph), graph);
+    const auto &stats = compiler_.GetOptimizationStats();
+    ASSERT_EQ(stats.size(), 3);
+    ASSERT_STREQ(stats[0].name, "StaticInline");
+    ASSERT_GT(stats[0].instrsCreated, 0);
+    ASSERT_GT(stats[0].instrsRemoved, 0);
+    ASSERT_GT(stats[0].bblocksChanged, 0);
+    // the inlined v ^ 0 is folded
+    ASSERT_STREQ(stats[1].name, "Peepholes");
+    ASSERT_EQ(stats[1].instrsRemoved, 1);
+    ASSERT_EQ(add->GetInput(0).GetInstruction(), arg);
+    VerifyControlAndDataFlowGraphs(graph);
+}
+
+} // namespace ir::tests
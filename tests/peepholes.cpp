@@ -1,5 +1,7 @@
 #include "optimizations/peepholes.h"
+#include "optimizations/remarks.h"
 #include "testBase.h"
+#include <sstream>
 
 namespace ir::tests {
 class PeepholesTest : public TestBase {
@@ -255,4 +257,72 @@ TEST_F(PeepholesTest, TestMUL3) {
     ASSERT_EQ(userInstr->GetInput(0), constZero);
 }
 
+TEST_F(PeepholesTest, TestRepeatedRunsRecycleInstructions) {
+    auto opType = InstType::i32;
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *arg = instrBuilder->BuildArg(opType);
+    auto *zero = instrBuilder->BuildConst(opType, 0);
+    auto *bblock = GetGraph()->CreateEmptyBB();
+    GetGraph()->SetFirstBB(bblock);
+    instrBuilder->PushBackInst(bblock, arg);
+    instrBuilder->PushBackInst(bblock, zero);
+
+    auto *allocator = GetGraph()->GetAllocator();
+    std::vector<SingleInstruction *> xors;
+    size_t usedSize = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        // v ^ 0 is folded by each run, and the killed instruction is recycled
+        // at the beginning of the next one
+        auto *xorInstr = instrBuilder->BuildXor(opType, arg, zero);
+        instrBuilder->PushBackInst(bblock, xorInstr);
+        pass->Apply();
+        ASSERT_EQ(bblock->GetSize(), 2);
+        xors.push_back(xorInstr);
+        if (i == 1) {
+            usedSize = allocator->GetUsedSize();
+        } else if (i > 1) {
+            ASSERT_EQ(xors[i], xors[i - 2]);
+        }
+    }
+    ASSERT_EQ(arg->UsersCount(), 0);
+    // only the bookkeeping grows, the instructions themselves are reused
+    ASSERT_LT(allocator->GetUsedSize() - usedSize,
+              xors.size() * sizeof(BinaryRegInstr) / 4);
+}
+
+TEST_F(PeepholesTest, TestRemarks) {
+    auto opType = InstType::i32;
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *arg = instrBuilder->BuildArg(opType);
+    auto *zero = instrBuilder->BuildConst(opType, 0);
+    auto *xorInstr = instrBuilder->BuildXor(opType, arg, zero);
+    auto *shrInstr = instrBuilder->BuildShr(opType, arg, zero);
+    auto *bblock = GetGraph()->CreateEmptyBB();
+    GetGraph()->SetFirstBB(bblock);
+    instrBuilder->PushBackInst(bblock, arg);
+    instrBuilder->PushBackInst(bblock, zero);
+    instrBuilder->PushBackInst(bblock, xorInstr);
+    instrBuilder->PushBackInst(bblock, shrInstr);
+
+    std::stringstream out;
+    StreamRemarkSink sink(out);
+    {
+        RemarkSinkScope scope(&sink);
+        pass->Run();
+    }
+    ASSERT_EQ(GetRemarkSink(), nullptr);
+    ASSERT_EQ(bblock->GetSize(), 2);
+#ifdef OPTIMIZATION_REMARKS
+    ASSERT_EQ(sink.GetCount(RemarkKind::PEEPHOLE_APPLIED), 2);
+    ASSERT_NE(out.str().find("'v ^ 0' => v, id = " +
+                             std::to_string(xorInstr->GetInstID())),
+              std::string::npos);
+#else
+    // nothing is reported when remarks are compiled out
+    ASSERT_EQ(sink.GetCount(RemarkKind::PEEPHOLE_APPLIED), 0);
+    ASSERT_TRUE(out.str().empty());
+#endif
+    ASSERT_EQ(sink.GetCount(RemarkKind::CHECK_REMOVED), 0);
+}
+
 } // namespace ir::tests
\ No newline at end of file
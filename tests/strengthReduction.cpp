@@ -0,0 +1,227 @@
+#include "domTree/loop.h"
+#include "optimizations/strengthReduction.h"
+#include "testBase.h"
+
+namespace ir::tests {
+class StrengthReductionTest : public TestBase {
+  public:
+    struct SumLoop {
+        std::vector<BB *> bblocks;
+        ConstInstr *zero;
+        PhiInstr *i;
+        PhiInstr *sum;
+    };
+
+    // sum of the values returned by the callback for i < bound, the
+    // condition is tested in the header: 0 -> 1 <-> 2, 1 -> 3
+    template <typename BodyT>
+    SumLoop BuildSumLoop(SingleInstruction *bound, BodyT body) {
+        auto *graph = GetGraph();
+        SumLoop loop;
+        loop.bblocks = CreateBlocks(4);
+        auto &bblocks = loop.bblocks;
+        graph->ConnectBBs(bblocks[0], bblocks[1]);
+        graph->ConnectBBs(bblocks[1], bblocks[2]);
+        graph->ConnectBBs(bblocks[1], bblocks[3]);
+        graph->ConnectBBs(bblocks[2], bblocks[1]);
+
+        auto *instrBuilder = GetInstructionBuilder();
+        loop.zero = instrBuilder->BuildConst(OPS_TYPE, 0);
+        instrBuilder->PushBackInst(bblocks[0], loop.zero);
+        loop.i = instrBuilder->BuildPhi(OPS_TYPE);
+        loop.sum = instrBuilder->BuildPhi(OPS_TYPE);
+        instrBuilder->PushForwardInst(bblocks[1], loop.i);
+        instrBuilder->PushForwardInst(bblocks[1], loop.sum);
+        instrBuilder->PushBackInst(
+            bblocks[1], instrBuilder->BuildCmp(OPS_TYPE, Conditions::LSTHAN,
+                                               loop.i, bound));
+        instrBuilder->PushBackInst(bblocks[1], instrBuilder->BuildJcmp());
+
+        auto *value = body(bblocks[2], loop.i);
+        auto *add = instrBuilder->BuildAdd(OPS_TYPE, loop.sum, value);
+        auto *next = instrBuilder->BuildAddi(OPS_TYPE, loop.i, 1);
+        instrBuilder->PushBackInst(bblocks[2], add);
+        instrBuilder->PushBackInst(bblocks[2], next);
+        loop.i->AddPhiInput(loop.zero, bblocks[0]);
+        loop.i->AddPhiInput(next, bblocks[2]);
+        loop.sum->AddPhiInput(loop.zero, bblocks[0]);
+        loop.sum->AddPhiInput(add, bblocks[2]);
+        instrBuilder->PushBackInst(bblocks[3],
+                                   instrBuilder->BuildRet(OPS_TYPE, loop.sum));
+        return loop;
+    }
+
+    static size_t CountMultiplications(BB *bblock) {
+        size_t count = 0;
+        for (auto *instr : *bblock) {
+            auto opcode = instr->GetOpcode();
+            count += opcode == Opcode::MUL || opcode == Opcode::MULI ? 1 : 0;
+        }
+        return count;
+    }
+
+    static size_t CountPhis(BB *bblock) {
+        size_t count = 0;
+        for (auto *instr : *bblock) {
+            count += instr->IsPhi() ? 1 : 0;
+        }
+        return count;
+    }
+
+  public:
+    static constexpr auto OPS_TYPE = InstType::i32;
+};
+
+TEST_F(StrengthReductionTest, TestMultiplicationByArgument) {
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *bound = instrBuilder->BuildArg(OPS_TYPE);
+    auto loop = BuildSumLoop(bound, [&](BB *body, PhiInstr *i) {
+        auto *mul = instrBuilder->BuildMul(OPS_TYPE, i, a);
+        instrBuilder->PushBackInst(body, mul);
+        return mul;
+    });
+    auto &bblocks = loop.bblocks;
+    instrBuilder->PushForwardInst(bblocks[0], bound);
+    instrBuilder->PushForwardInst(bblocks[0], a);
+    auto *graph = GetGraph();
+    ASSERT_EQ(Interpret(graph, {3, 5}), 30);
+
+    LoopStrengthReduction reduction(graph);
+    reduction.Apply();
+    ASSERT_EQ(reduction.GetReducedCount(), 1);
+    VerifyControlAndDataFlowGraphs(graph);
+    VerifyDomTree(graph);
+    ASSERT_EQ(CountMultiplications(bblocks[2]), 0);
+    ASSERT_EQ(CountPhis(bblocks[1]), 3);
+    // 0 * a is the initial value, a is the step
+    auto *add =
+        static_cast<InputsInstr *>(loop.sum->GetInput(1).GetInstruction());
+    auto *phi = static_cast<PhiInstr *>(add->GetInput(1).GetInstruction());
+    ASSERT_TRUE(phi->IsPhi());
+    ASSERT_EQ(phi->GetInput(0)->GetOpcode(), Opcode::MUL);
+    ASSERT_EQ(phi->GetInput(0)->GetInstBB(), bblocks[0]);
+    auto *next = static_cast<InputsInstr *>(phi->GetInput(1).GetInstruction());
+    ASSERT_EQ(next->GetOpcode(), Opcode::ADD);
+    ASSERT_EQ(next->GetInput(0), phi);
+    ASSERT_EQ(next->GetInput(1), a);
+    ASSERT_EQ(Interpret(graph, {3, 5}), 30);
+    ASSERT_EQ(Interpret(graph, {-7, 4}), -42);
+    ASSERT_EQ(Interpret(graph, {3, 0}), 0);
+
+    // the recurrence is a basic variable, and the killed multiplication is
+    // recycled before the pass runs again
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 0);
+    reduction.Apply();
+    ASSERT_EQ(reduction.GetReducedCount(), 0);
+    ASSERT_EQ(instrBuilder->GetFreeInstructionsCount(), 1);
+}
+
+TEST_F(StrengthReductionTest, TestChainedMultiplications) {
+    // ((i + 2) * 3) * a
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *a = instrBuilder->BuildArg(OPS_TYPE);
+    auto *bound = instrBuilder->BuildConst(OPS_TYPE, 6);
+    SingleInstruction *shifted = nullptr;
+    auto loop = BuildSumLoop(bound, [&](BB *body, PhiInstr *i) {
+        shifted = instrBuilder->BuildAddi(OPS_TYPE, i, 2);
+        auto *scaled = instrBuilder->BuildMuli(OPS_TYPE, shifted, 3);
+        auto *product = instrBuilder->BuildMul(OPS_TYPE, scaled, a);
+        for (auto *instr : std::initializer_list<SingleInstruction *>{
+                 shifted, scaled, product}) {
+            instrBuilder->PushBackInst(body, instr);
+        }
+        return product;
+    });
+    auto &bblocks = loop.bblocks;
+    instrBuilder->PushForwardInst(bblocks[0], bound);
+    instrBuilder->PushForwardInst(bblocks[0], a);
+    auto *graph = GetGraph();
+    ASSERT_EQ(Interpret(graph, {1}), 81);
+
+    LoopStrengthReduction reduction(graph);
+    reduction.Apply();
+    ASSERT_EQ(reduction.GetReducedCount(), 2);
+    VerifyControlAndDataFlowGraphs(graph);
+    ASSERT_EQ(CountMultiplications(bblocks[2]), 0);
+    // the recurrence of the first product is replaced by the second one, and
+    // the addition it was computed from is removed
+    ASSERT_EQ(CountPhis(bblocks[1]), 3);
+    ASSERT_EQ(shifted->GetInstBB(), nullptr);
+    ASSERT_EQ(Interpret(graph, {1}), 81);
+    ASSERT_EQ(Interpret(graph, {-2}), -162);
+}
+
+TEST_F(StrengthReductionTest, TestArrayIndex) {
+    // loads of a[3 * i] and a[3 * i + 1]
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *array = instrBuilder->BuildArg(InstType::REF);
+    auto *bound = instrBuilder->BuildArg(OPS_TYPE);
+    LoadArrayInstr *loads[2] = {nullptr, nullptr};
+    auto loop = BuildSumLoop(bound, [&](BB *body, PhiInstr *i) {
+        auto *index = instrBuilder->BuildMuli(OPS_TYPE, i, 3);
+        auto *nextIndex = instrBuilder->BuildAddi(OPS_TYPE, index, 1);
+        loads[0] = instrBuilder->BuildLoadArray(OPS_TYPE, array, index);
+        loads[1] = instrBuilder->BuildLoadArray(OPS_TYPE, array, nextIndex);
+        auto *add = instrBuilder->BuildAdd(OPS_TYPE, loads[0], loads[1]);
+        for (auto *instr : std::initializer_list<SingleInstruction *>{
+                 index, nextIndex, loads[0], loads[1], add}) {
+            instrBuilder->PushBackInst(body, instr);
+        }
+        return add;
+    });
+    auto &bblocks = loop.bblocks;
+    instrBuilder->PushForwardInst(bblocks[0], bound);
+    instrBuilder->PushForwardInst(bblocks[0], array);
+    auto *graph = GetGraph();
+
+    LoopStrengthReduction reduction(graph);
+    reduction.Apply();
+    ASSERT_EQ(reduction.GetReducedCount(), 1);
+    VerifyControlAndDataFlowGraphs(graph);
+    ASSERT_EQ(CountMultiplications(bblocks[2]), 0);
+
+    // the loads index with the recurrence starting from 0 * 3 and increased
+    // by 3
+    auto *phi = loads[0]->GetInput(1).GetInstruction();
+    ASSERT_TRUE(phi->IsPhi());
+    ASSERT_EQ(phi->GetInstBB(), bblocks[1]);
+    auto *recurrence = static_cast<PhiInstr *>(phi);
+    auto *initial =
+        static_cast<InputsInstr *>(recurrence->GetInput(0).GetInstruction());
+    ASSERT_EQ(initial->GetOpcode(), Opcode::MULI);
+    ASSERT_EQ(initial->GetInput(0), loop.zero);
+    auto *next =
+        static_cast<InputsInstr *>(recurrence->GetInput(1).GetInstruction());
+    ASSERT_EQ(next->GetOpcode(), Opcode::ADDI);
+    ASSERT_EQ(next->GetInput(0), phi);
+    ASSERT_EQ(static_cast<ConstInstr *>(next->GetInput(1).GetInstruction())
+                  ->GetValue(),
+              3);
+    auto *nextIndex =
+        static_cast<InputsInstr *>(loads[1]->GetInput(1).GetInstruction());
+    ASSERT_EQ(nextIndex->GetOpcode(), Opcode::ADDI);
+    ASSERT_EQ(nextIndex->GetInput(0), phi);
+}
+
+TEST_F(StrengthReductionTest, TestNotReduced) {
+    // i * i grows by a variable amount
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *bound = instrBuilder->BuildConst(OPS_TYPE, 5);
+    auto loop = BuildSumLoop(bound, [&](BB *body, PhiInstr *i) {
+        auto *square = instrBuilder->BuildMul(OPS_TYPE, i, i);
+        instrBuilder->PushBackInst(body, square);
+        return square;
+    });
+    instrBuilder->PushForwardInst(loop.bblocks[0], bound);
+    auto *graph = GetGraph();
+
+    LoopStrengthReduction reduction(graph);
+    reduction.Apply();
+    ASSERT_EQ(reduction.GetReducedCount(), 0);
+    VerifyControlAndDataFlowGraphs(graph);
+    ASSERT_EQ(CountMultiplications(loop.bblocks[2]), 1);
+    ASSERT_EQ(CountPhis(loop.bblocks[1]), 2);
+    ASSERT_EQ(Interpret(graph, {}), 30);
+}
+} // namespace ir::tests
@@ -1,5 +1,8 @@
 #include "testBase.h"
 #include "domTree/dfo_rpo.h"
+#include "domTree/domTree.h"
+#include <tuple>
+#include <unordered_map>
 namespace ir::tests {
 
 void TestBase::VerifyControlAndDataFlowGraphs(Graph *graph) {
@@ -17,13 +20,16 @@ void TestBase::VerifyControlAndDataFlowGraphs(BB *bblock) {
     if (!instr) {
         return;
     }
+    // blocks holding only phis end with the last of them
+    SingleInstruction *last = bblock->GetLastInstBB();
+    last = last ? last : bblock->GetLastPhiBB();
     size_t counter = 0;
     while (instr) {
         if (instr != bblock->GetFirstPhiBB() &&
             instr != bblock->GetFirstInstBB()) {
             ASSERT_NE(instr->GetPrevInst(), nullptr);
         }
-        if (instr != bblock->GetLastInstBB()) {
+        if (instr != last) {
             ASSERT_NE(instr->GetNextInst(), nullptr);
         }
 
@@ -58,11 +64,134 @@ void TestBase::VerifyControlAndDataFlowGraphs(BB *bblock) {
         }
 
         if (instr->GetNextInst() == nullptr) {
-            ASSERT_EQ(instr, bblock->GetLastInstBB());
+            ASSERT_EQ(instr, last);
         }
         ++counter;
         instr = instr->GetNextInst();
     }
     ASSERT_EQ(bblock->GetSize(), counter);
 }
-} // namespace ir::tests
\ No newline at end of file
+
+void TestBase::VerifyDomTree(Graph *graph) {
+    ASSERT_TRUE(graph->GetAnalyses().IsValid(AnalysisKind::DOM_TREE));
+    // dominated blocks are compared regardless of their order
+    using DomTreeNode = std::tuple<BB *, BB *, size_t, std::vector<BB *>>;
+    auto collect = [graph]() {
+        std::vector<DomTreeNode> nodes;
+        graph->ForEachBB([&nodes](BB *bblock) {
+            auto &dominated = bblock->GetDominatedBBs();
+            std::vector<BB *> sorted(dominated.begin(), dominated.end());
+            std::sort(sorted.begin(), sorted.end());
+            nodes.emplace_back(bblock, bblock->GetDominator(),
+                               bblock->GetDomTreeDepth(), std::move(sorted));
+        });
+        return nodes;
+    };
+    auto updated = collect();
+    DomTreeBuilder().Construct(graph);
+    auto rebuilt = collect();
+    ASSERT_EQ(updated.size(), rebuilt.size());
+    for (size_t i = 0; i < updated.size(); ++i) {
+        ASSERT_EQ(updated[i], rebuilt[i]) << "block " << i;
+    }
+}
+
+int64_t TestBase::Interpret(Graph *graph, std::vector<int64_t> args) {
+    std::unordered_map<SingleInstruction *, int64_t> values;
+    auto get = [&values](InputsInstr *instr, size_t idx) {
+        auto *input = instr->GetInput(idx).GetInstruction();
+        // immediates are not placed in the blocks
+        if (input->IsConst()) {
+            return static_cast<int64_t>(
+                static_cast<ConstInstr *>(input)->GetValue());
+        }
+        return values.at(input);
+    };
+    size_t argIdx = 0;
+    bool flag = false;
+    BB *prev = nullptr;
+    auto *bblock = graph->GetFirstBB();
+    for (size_t steps = 0; steps < MAX_STEPS; ++steps) {
+        // phis read the values on the edge all at once
+        std::vector<std::pair<SingleInstruction *, int64_t>> phiValues;
+        for (auto *instr : *bblock) {
+            if (!instr->IsPhi()) {
+                break;
+            }
+            auto *phi = static_cast<PhiInstr *>(instr);
+            auto &sources = phi->GetSourceBBs();
+            auto it = std::find(sources.begin(), sources.end(), prev);
+            EXPECT_NE(it, sources.end());
+            phiValues.emplace_back(phi, get(phi, it - sources.begin()));
+        }
+        for (auto &[phi, value] : phiValues) {
+            values[phi] = value;
+        }
+
+        BB *next = bblock->GetSuccessors().empty()
+                       ? nullptr
+                       : bblock->GetSuccessors()[0];
+        for (auto *instr : *bblock) {
+            // CONST and ARG are not InputsInstr, the cast is done per case
+            int64_t result = 0;
+            switch (instr->GetOpcode()) {
+            case Opcode::PHI:
+                continue;
+            case Opcode::CONST:
+                result = static_cast<int64_t>(
+                    static_cast<ConstInstr *>(instr)->GetValue());
+                break;
+            case Opcode::ARG:
+                result = args.at(argIdx++);
+                break;
+            case Opcode::ADD:
+            case Opcode::ADDI: {
+                auto *withInputs = static_cast<InputsInstr *>(instr);
+                result = get(withInputs, 0) + get(withInputs, 1);
+                break;
+            }
+            case Opcode::MUL:
+            case Opcode::MULI: {
+                auto *withInputs = static_cast<InputsInstr *>(instr);
+                result = get(withInputs, 0) * get(withInputs, 1);
+                break;
+            }
+            case Opcode::CMP: {
+                auto *withInputs = static_cast<InputsInstr *>(instr);
+                auto lhs = get(withInputs, 0);
+                auto rhs = get(withInputs, 1);
+                switch (static_cast<CompInstr *>(instr)->GetCondCode()) {
+                case Conditions::EQ:
+                    flag = lhs == rhs;
+                    break;
+                case Conditions::NONEQ:
+                    flag = lhs != rhs;
+                    break;
+                case Conditions::LSTHAN:
+                    flag = lhs < rhs;
+                    break;
+                case Conditions::GRTHAN:
+                    flag = lhs > rhs;
+                    break;
+                }
+                continue;
+            }
+            case Opcode::JCMP:
+                next = bblock->GetSuccessors()[flag ? 0 : 1];
+                continue;
+            case Opcode::RET:
+                return get(static_cast<InputsInstr *>(instr), 0);
+            default:
+                ADD_FAILURE() << "unexpected instruction";
+                return 0;
+            }
+            values[instr] = result;
+        }
+        EXPECT_NE(next, nullptr);
+        prev = bblock;
+        bblock = next;
+    }
+    ADD_FAILURE() << "too many steps";
+    return 0;
+}
+} // namespace ir::tests
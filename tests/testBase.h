@@ -24,6 +24,17 @@ class TestBase : public ::testing::Test {
         return targetGraph->GetInstructionBuilder();
     }
 
+    // Creates blocks of the tested graph, the first one is its entry
+    std::vector<BB *> CreateBlocks(size_t count) {
+        assert(count > 0);
+        std::vector<BB *> bblocks(count);
+        for (auto &it : bblocks) {
+            it = GetGraph()->CreateEmptyBB();
+        }
+        GetGraph()->SetFirstBB(bblocks[0]);
+        return bblocks;
+    }
+
     template <typename AllocatorT = std::allocator<SingleInstruction *>>
     static void
     CompareInstructions(std::vector<SingleInstruction *, AllocatorT> expected,
@@ -37,8 +48,16 @@ class TestBase : public ::testing::Test {
 
     static void VerifyControlAndDataFlowGraphs(Graph *graph);
     static void VerifyControlAndDataFlowGraphs(BB *bblock);
+    // Checks that the dominator tree kept in the blocks matches a freshly
+    // built one, which replaces it
+    static void VerifyDomTree(Graph *graph);
+    // Runs the arithmetic of the graph, the arguments are taken in the order
+    // of their instructions
+    static int64_t Interpret(Graph *graph, std::vector<int64_t> args);
 
   public:
+    static constexpr size_t MAX_STEPS = 1000;
+
     Compiler compiler_;
 
   protected:
@@ -0,0 +1,136 @@
+#include "domTree/tripCount.h"
+#include "testBase.h"
+
+namespace ir::tests {
+class TripCountTest : public TestBase {
+  public:
+    struct LoopDesc {
+        InstType type;
+        int64_t start;
+        int64_t step;
+        Conditions cond;
+        int64_t bound;
+        // compares the update at the end of the body instead of the phi in
+        // the header
+        bool isBottomTested;
+    };
+
+    // Builds the loop and returns its induction phi
+    PhiInstr *BuildLoop(const LoopDesc &desc) {
+        auto *graph = GetGraph();
+        auto bblocks = CreateBlocks(desc.isBottomTested ? 3 : 4);
+        graph->ConnectBBs(bblocks[0], bblocks[1]);
+
+        auto *instrBuilder = GetInstructionBuilder();
+        auto *start = instrBuilder->BuildConst(desc.type, desc.start);
+        auto *bound = instrBuilder->BuildConst(desc.type, desc.bound);
+        instrBuilder->PushBackInst(bblocks[0], start);
+        instrBuilder->PushBackInst(bblocks[0], bound);
+        auto *phi = instrBuilder->BuildPhi(desc.type);
+        instrBuilder->PushForwardInst(bblocks[1], phi);
+        auto *update = instrBuilder->BuildAddi(desc.type, phi, desc.step);
+        auto *compared =
+            desc.isBottomTested ? static_cast<SingleInstruction *>(update)
+                                : phi;
+        auto *cmp = instrBuilder->BuildCmp(desc.type, desc.cond, compared,
+                                           bound);
+        auto *jcmp = instrBuilder->BuildJcmp();
+        phi->AddPhiInput(start, bblocks[0]);
+
+        if (desc.isBottomTested) {
+            // 0 -> 1 <-> 1 -> 2, the condition holds to stay in the loop
+            instrBuilder->PushBackInst(bblocks[1], update);
+            instrBuilder->PushBackInst(bblocks[1], cmp);
+            instrBuilder->PushBackInst(bblocks[1], jcmp);
+            graph->ConnectBBs(bblocks[1], bblocks[1]);
+            graph->ConnectBBs(bblocks[1], bblocks[2]);
+            phi->AddPhiInput(update, bblocks[1]);
+        } else {
+            // 0 -> 1 <-> 2, 1 -> 3
+            instrBuilder->PushBackInst(bblocks[1], cmp);
+            instrBuilder->PushBackInst(bblocks[1], jcmp);
+            instrBuilder->PushBackInst(bblocks[2], update);
+            graph->ConnectBBs(bblocks[1], bblocks[2]);
+            graph->ConnectBBs(bblocks[1], bblocks[3]);
+            graph->ConnectBBs(bblocks[2], bblocks[1]);
+            phi->AddPhiInput(update, bblocks[2]);
+        }
+        graph->GetAnalyses().Require(
+            {AnalysisKind::DOM_TREE, AnalysisKind::LOOP_TREE});
+        return phi;
+    }
+
+    bool Compute(const LoopDesc &desc, CountedLoop *result) {
+        auto *phi = BuildLoop(desc);
+        return ComputeTripCount(phi->GetInstBB()->GetLoop(), result);
+    }
+};
+
+TEST_F(TripCountTest, TestTopTestedLoop) {
+    // for (i = 0; i < 10; ++i)
+    CountedLoop counted;
+    ASSERT_TRUE(Compute({InstType::i32, 0, 1, Conditions::LSTHAN, 10, false},
+                        &counted));
+    // the header is left on the 11th execution
+    ASSERT_EQ(counted.tripCount, 11);
+    ASSERT_EQ(counted.start, 0);
+    ASSERT_EQ(counted.step, 1);
+    ASSERT_EQ(counted.bound, 10);
+    ASSERT_EQ(counted.exiting, counted.induction->GetInstBB());
+    ASSERT_EQ(counted.update->GetInput(0), counted.induction);
+}
+
+TEST_F(TripCountTest, TestBottomTestedLoop) {
+    // do { ++i } while (i < 10), the update is compared
+    CountedLoop counted;
+    ASSERT_TRUE(Compute({InstType::i32, 0, 1, Conditions::LSTHAN, 10, true},
+                        &counted));
+    ASSERT_EQ(counted.tripCount, 10);
+}
+
+TEST_F(TripCountTest, TestDecreasingLoop) {
+    // for (i = 10; i > 0; i -= 2) visits 10, 8, 6, 4, 2
+    CountedLoop counted;
+    ASSERT_TRUE(Compute({InstType::i64, 10, -2, Conditions::GRTHAN, 0, false},
+                        &counted));
+    ASSERT_EQ(counted.tripCount, 6);
+    ASSERT_EQ(counted.step, -2);
+}
+
+TEST_F(TripCountTest, TestEqualityExit) {
+    // for (i = 1; i != 13; i += 3)
+    CountedLoop counted;
+    ASSERT_TRUE(Compute({InstType::u32, 1, 3, Conditions::NONEQ, 13, false},
+                        &counted));
+    ASSERT_EQ(counted.tripCount, 5);
+}
+
+TEST_F(TripCountTest, TestNotCountedLoops) {
+    CountedLoop counted;
+    // the bound is never met exactly
+    ASSERT_FALSE(Compute(
+        {InstType::i32, 0, 2, Conditions::NONEQ, 7, false}, &counted));
+}
+
+TEST_F(TripCountTest, TestOverflow) {
+    CountedLoop counted;
+    // the value passes the bound only by wrapping around
+    ASSERT_FALSE(Compute(
+        {InstType::i16, 0, 1000, Conditions::LSTHAN, 32767, false}, &counted));
+}
+
+TEST_F(TripCountTest, TestUnknownBound) {
+    auto *phi =
+        BuildLoop({InstType::i32, 0, 1, Conditions::LSTHAN, 10, false});
+    // the bound is replaced by an argument
+    auto *instrBuilder = GetInstructionBuilder();
+    auto *arg = instrBuilder->BuildArg(InstType::i32);
+    instrBuilder->PushBackInst(GetGraph()->GetFirstBB(), arg);
+    auto *cmp = static_cast<CompInstr *>(
+        phi->GetInstBB()->GetLastInstBB()->GetPrevInst());
+    cmp->SetInput(arg, 1);
+
+    CountedLoop counted;
+    ASSERT_FALSE(ComputeTripCount(phi->GetInstBB()->GetLoop(), &counted));
+}
+} // namespace ir::tests